@@ -32,7 +32,7 @@
 //   <i> The memory space for the stack is provided by the user.
 //   <i> Default: 0
 #ifndef OS_PRIVCNT
- #define OS_PRIVCNT     0
+ #define OS_PRIVCNT     6
 #endif
 
 //   <o>Task stack size [bytes] <20-4096:8><#/4>
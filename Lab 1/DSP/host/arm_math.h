@@ -0,0 +1,304 @@
+#ifndef _ARM_MATH_H
+
+  #define _ARM_MATH_H
+
+  // Host (PC) replacement for the CMSIS-DSP arm_math.h, covering the
+  // subset of the library used by this project. Types, instance
+  // structures and prototypes follow the CMSIS-DSP V1.0 header linked
+  // with the Keil project, so the sources in src/ compile unchanged
+  // against either one. Put this directory ahead of include/ and
+  // never on the target include path; see arm_math_host.c.
+
+  #include <stdint.h>
+  #include <string.h>
+  #include <math.h>
+
+  typedef int8_t q7_t;
+  typedef int16_t q15_t;
+  typedef int32_t q31_t;
+  typedef int64_t q63_t;
+  typedef float float32_t;
+  typedef double float64_t;
+
+  typedef enum
+  {
+    ARM_MATH_SUCCESS = 0,
+    ARM_MATH_ARGUMENT_ERROR = -1,
+    ARM_MATH_LENGTH_ERROR = -2,
+    ARM_MATH_SIZE_MISMATCH = -3,
+    ARM_MATH_NANINF = -4,
+    ARM_MATH_SINGULAR = -5,
+    ARM_MATH_TEST_FAILURE = -6
+  } arm_status;
+
+  #define PI 3.14159265358979f
+
+  /*
+  *********************************************************************
+  *
+  *   Cortex-M4 intrinsics used by the sources, in portable C
+  *
+  *********************************************************************
+  */
+
+  static __inline int32_t __SSAT(int32_t value, uint32_t bits)
+  {
+    int32_t max = (int32_t)((1u << (bits - 1u)) - 1u);
+    int32_t min = -max - 1;
+
+    return (value > max) ? max : ((value < min) ? min : value);
+  }
+
+  static __inline int32_t __QADD(int32_t a, int32_t b)
+  {
+    int64_t sum = (int64_t)a + b;
+
+    return (sum > INT32_MAX) ? INT32_MAX : ((sum < INT32_MIN) ? INT32_MIN : (int32_t)sum);
+  }
+
+  static __inline int32_t __QSUB(int32_t a, int32_t b)
+  {
+    int64_t difference = (int64_t)a - b;
+
+    return (difference > INT32_MAX) ? INT32_MAX : ((difference < INT32_MIN) ? INT32_MIN : (int32_t)difference);
+  }
+
+  // dual 16 bit multiply, products added (to the accumulator)
+  static __inline int32_t __SMUAD(uint32_t x, uint32_t y)
+  {
+    return (int32_t)(int16_t)x * (int16_t)y + (int32_t)(int16_t)(x >> 16) * (int16_t)(y >> 16);
+  }
+
+  static __inline int32_t __SMLAD(uint32_t x, uint32_t y, int32_t accumulator)
+  {
+    return (int32_t)((uint32_t)accumulator + (uint32_t)__SMUAD(x, y));
+  }
+
+  // bottom half of a, top half of (b << shift)
+  static __inline uint32_t __PKHBT(uint32_t a, uint32_t b, uint32_t shift)
+  {
+    return (a & 0x0000FFFFu) | ((b << shift) & 0xFFFF0000u);
+  }
+
+  static __inline uint32_t __CLZ(uint32_t value)
+  {
+    uint32_t count = 0;
+
+    if (value == 0)
+    {
+      return 32;
+    }
+    while ((value & 0x80000000u) == 0)
+    {
+      value <<= 1;
+      count++;
+    }
+    return count;
+  }
+
+  static __inline q31_t clip_q63_to_q31(q63_t x)
+  {
+    return (x > INT32_MAX) ? INT32_MAX : ((x < INT32_MIN) ? INT32_MIN : (q31_t)x);
+  }
+
+  /*
+  *********************************************************************
+  *
+  *   Instance structures
+  *
+  *********************************************************************
+  */
+
+  typedef struct
+  {
+    uint16_t numTaps;
+    q15_t *pState;
+    q15_t *pCoeffs;
+  } arm_fir_instance_q15;
+
+  typedef struct
+  {
+    uint16_t numTaps;
+    q31_t *pState;
+    q31_t *pCoeffs;
+  } arm_fir_instance_q31;
+
+  typedef struct
+  {
+    uint16_t numTaps;
+    float32_t *pState;
+    float32_t *pCoeffs;
+  } arm_fir_instance_f32;
+
+  typedef struct
+  {
+    uint8_t M;
+    uint16_t numTaps;
+    q15_t *pCoeffs;
+    q15_t *pState;
+  } arm_fir_decimate_instance_q15;
+
+  typedef struct
+  {
+    uint8_t L;
+    uint16_t phaseLength;
+    q15_t *pCoeffs;
+    q15_t *pState;
+  } arm_fir_interpolate_instance_q15;
+
+  typedef struct
+  {
+    int8_t numStages;
+    q15_t *pState;
+    q15_t *pCoeffs;
+    int8_t postShift;
+  } arm_biquad_casd_df1_inst_q15;
+
+  typedef struct
+  {
+    uint32_t numStages;
+    q31_t *pState;
+    q31_t *pCoeffs;
+    uint8_t postShift;
+  } arm_biquad_casd_df1_inst_q31;
+
+  typedef struct
+  {
+    uint32_t numStages;
+    float32_t *pState;
+    float32_t *pCoeffs;
+  } arm_biquad_casd_df1_inst_f32;
+
+  typedef struct
+  {
+    uint16_t fftLen;
+    uint8_t ifftFlag;
+    uint8_t bitReverseFlag;
+  } arm_cfft_radix4_instance_q15;
+
+  typedef struct
+  {
+    uint16_t fftLen;
+    uint8_t ifftFlag;
+    uint8_t bitReverseFlag;
+  } arm_cfft_radix4_instance_q31;
+
+  typedef struct
+  {
+    uint32_t fftLenReal;
+    uint32_t fftLenBy2;
+    uint8_t ifftFlagR;
+    uint8_t bitReverseFlagR;
+    arm_cfft_radix4_instance_q15 *pCfft;
+  } arm_rfft_instance_q15;
+
+  typedef struct
+  {
+    uint32_t fftLenReal;
+    uint32_t fftLenBy2;
+    uint8_t ifftFlagR;
+    uint8_t bitReverseFlagR;
+    arm_cfft_radix4_instance_q31 *pCfft;
+  } arm_rfft_instance_q31;
+
+  typedef struct
+  {
+    uint16_t numTaps;
+    q15_t *pState;
+    q15_t *pCoeffs;
+    q15_t mu;
+    uint8_t postShift;
+    q15_t *recipTable;
+    q31_t energy;
+    q15_t x0;
+  } arm_lms_norm_instance_q15;
+
+  typedef struct
+  {
+    uint16_t numTaps;
+    q31_t *pState;
+    q31_t *pCoeffs;
+    q31_t mu;
+    uint8_t postShift;
+    q31_t *recipTable;
+    q31_t energy;
+    q31_t x0;
+  } arm_lms_norm_instance_q31;
+
+  /*
+  *********************************************************************
+  *
+  *   Functions
+  *
+  *********************************************************************
+  */
+
+  arm_status arm_fir_init_q15(arm_fir_instance_q15 *S, uint16_t numTaps, q15_t *pCoeffs, q15_t *pState,
+                              uint32_t blockSize);
+  void arm_fir_q15(const arm_fir_instance_q15 *S, q15_t *pSrc, q15_t *pDst, uint32_t blockSize);
+  void arm_fir_init_q31(arm_fir_instance_q31 *S, uint16_t numTaps, q31_t *pCoeffs, q31_t *pState,
+                        uint32_t blockSize);
+  void arm_fir_q31(const arm_fir_instance_q31 *S, q31_t *pSrc, q31_t *pDst, uint32_t blockSize);
+  void arm_fir_init_f32(arm_fir_instance_f32 *S, uint16_t numTaps, float32_t *pCoeffs, float32_t *pState,
+                        uint32_t blockSize);
+  void arm_fir_f32(const arm_fir_instance_f32 *S, float32_t *pSrc, float32_t *pDst, uint32_t blockSize);
+
+  arm_status arm_fir_decimate_init_q15(arm_fir_decimate_instance_q15 *S, uint16_t numTaps, uint8_t M,
+                                       q15_t *pCoeffs, q15_t *pState, uint32_t blockSize);
+  void arm_fir_decimate_q15(const arm_fir_decimate_instance_q15 *S, q15_t *pSrc, q15_t *pDst, uint32_t blockSize);
+  arm_status arm_fir_interpolate_init_q15(arm_fir_interpolate_instance_q15 *S, uint8_t L, uint16_t numTaps,
+                                          q15_t *pCoeffs, q15_t *pState, uint32_t blockSize);
+  void arm_fir_interpolate_q15(const arm_fir_interpolate_instance_q15 *S, q15_t *pSrc, q15_t *pDst,
+                               uint32_t blockSize);
+
+  void arm_biquad_cascade_df1_init_q15(arm_biquad_casd_df1_inst_q15 *S, uint8_t numStages, q15_t *pCoeffs,
+                                       q15_t *pState, int8_t postShift);
+  void arm_biquad_cascade_df1_q15(const arm_biquad_casd_df1_inst_q15 *S, q15_t *pSrc, q15_t *pDst,
+                                  uint32_t blockSize);
+  void arm_biquad_cascade_df1_init_q31(arm_biquad_casd_df1_inst_q31 *S, uint8_t numStages, q31_t *pCoeffs,
+                                       q31_t *pState, int8_t postShift);
+  void arm_biquad_cascade_df1_q31(const arm_biquad_casd_df1_inst_q31 *S, q31_t *pSrc, q31_t *pDst,
+                                  uint32_t blockSize);
+  void arm_biquad_cascade_df1_init_f32(arm_biquad_casd_df1_inst_f32 *S, uint8_t numStages, float32_t *pCoeffs,
+                                       float32_t *pState);
+  void arm_biquad_cascade_df1_f32(const arm_biquad_casd_df1_inst_f32 *S, float32_t *pSrc, float32_t *pDst,
+                                  uint32_t blockSize);
+
+  arm_status arm_cfft_radix4_init_q15(arm_cfft_radix4_instance_q15 *S, uint16_t fftLen, uint8_t ifftFlag,
+                                      uint8_t bitReverseFlag);
+  void arm_cfft_radix4_q15(const arm_cfft_radix4_instance_q15 *S, q15_t *pSrc);
+  arm_status arm_rfft_init_q15(arm_rfft_instance_q15 *S, arm_cfft_radix4_instance_q15 *S_CFFT, uint32_t fftLenReal,
+                               uint32_t ifftFlagR, uint32_t bitReverseFlag);
+  void arm_rfft_q15(const arm_rfft_instance_q15 *S, q15_t *pSrc, q15_t *pDst);
+  arm_status arm_rfft_init_q31(arm_rfft_instance_q31 *S, arm_cfft_radix4_instance_q31 *S_CFFT, uint32_t fftLenReal,
+                               uint32_t ifftFlagR, uint32_t bitReverseFlag);
+  void arm_rfft_q31(const arm_rfft_instance_q31 *S, q31_t *pSrc, q31_t *pDst);
+
+  void arm_lms_norm_init_q15(arm_lms_norm_instance_q15 *S, uint16_t numTaps, q15_t *pCoeffs, q15_t *pState,
+                             q15_t mu, uint32_t blockSize, uint8_t postShift);
+  void arm_lms_norm_q15(arm_lms_norm_instance_q15 *S, q15_t *pSrc, q15_t *pRef, q15_t *pOut, q15_t *pErr,
+                        uint32_t blockSize);
+  void arm_lms_norm_init_q31(arm_lms_norm_instance_q31 *S, uint16_t numTaps, q31_t *pCoeffs, q31_t *pState,
+                             q31_t mu, uint32_t blockSize, uint8_t postShift);
+  void arm_lms_norm_q31(arm_lms_norm_instance_q31 *S, q31_t *pSrc, q31_t *pRef, q31_t *pOut, q31_t *pErr,
+                        uint32_t blockSize);
+
+  float32_t arm_sin_f32(float32_t x);
+  float32_t arm_cos_f32(float32_t x);
+
+  void arm_float_to_q15(float32_t *pSrc, q15_t *pDst, uint32_t blockSize);
+  void arm_float_to_q31(float32_t *pSrc, q31_t *pDst, uint32_t blockSize);
+  void arm_q15_to_float(q15_t *pSrc, float32_t *pDst, uint32_t blockSize);
+  void arm_q31_to_float(q31_t *pSrc, float32_t *pDst, uint32_t blockSize);
+  void arm_q15_to_q31(q15_t *pSrc, q31_t *pDst, uint32_t blockSize);
+  void arm_q31_to_q15(q31_t *pSrc, q15_t *pDst, uint32_t blockSize);
+
+  void arm_mult_q15(q15_t *pSrcA, q15_t *pSrcB, q15_t *pDst, uint32_t blockSize);
+  void arm_scale_q15(q15_t *pSrc, q15_t scaleFract, int8_t shift, q15_t *pDst, uint32_t blockSize);
+  void arm_copy_q15(q15_t *pSrc, q15_t *pDst, uint32_t blockSize);
+  void arm_copy_f32(float32_t *pSrc, float32_t *pDst, uint32_t blockSize);
+  void arm_fill_q15(q15_t value, q15_t *pDst, uint32_t blockSize);
+  void arm_fill_q31(q31_t value, q31_t *pDst, uint32_t blockSize);
+  void arm_fill_f32(float32_t value, float32_t *pDst, uint32_t blockSize);
+
+#endif
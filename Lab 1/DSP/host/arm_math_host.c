@@ -0,0 +1,1320 @@
+/*
+*********************************************************************
+*
+*   CMSIS-DSP kernels for the host build
+*
+*   Portable C versions of the library functions used by the project,
+*   so the DSP modules and dsp_bench.c run on a PC, e.g.
+*
+*     gcc -O2 -msse2 -ffp-contract=off -DDSP_HOST_BUILD -Ihost -Iinclude
+*         src/dsp_bench.c src/<modules>.c host/arm_math_host.c -lm
+*
+*   (-mavx2 selects the AVX2 paths). The kernels the signal chain of
+*   DirtyFilter is built from follow the arithmetic of the Cortex-M4
+*   library to the bit:
+*
+*     arm_fir_q15                 exact 64 bit sum, >> 15, SSAT 16
+*     arm_biquad_cascade_df1_q15  exact 64 bit sum, >> (15 - postShift), SSAT 16
+*     arm_float_to_q15            x * 32768 truncated (VCVT), SSAT 16
+*     arm_sin_f32 / arm_cos_f32   256 point table, cubic interpolation
+*
+*   arm_sin_f32 reproduces the algorithm and table of the library; the
+*   order of the float operations inside the interpolation has not been
+*   matched against the binary, so results may differ in the last bit.
+*   Fused multiply-add would change them too, hence -ffp-contract=off.
+*   The other functions keep the fixed point formats, scaling and
+*   saturation of the library and are good references, but the FFT,
+*   the LMS update and the float filters round differently.
+*
+*   arm_fir_q15 and arm_float_to_q15 have SSE2 and AVX2 versions;
+*   the biquad is a recursion and stays scalar. Compiled with
+*   ARM_MATH_HOST_CHECK defined the file is a self-check that compares
+*   the vector paths and the bit exact kernels against independent
+*   scalar models on random and edge case data:
+*
+*     gcc -O2 -mavx2 -ffp-contract=off -DARM_MATH_HOST_CHECK -Ihost
+*         host/arm_math_host.c -o arm_math_check -lm
+*
+*********************************************************************
+*/
+
+#include "arm_math.h"
+
+#if defined(__AVX2__)
+  #include <immintrin.h>
+  #define ARM_HOST_SIMD "AVX2"
+#elif defined(__SSE2__)
+  #include <emmintrin.h>
+  #define ARM_HOST_SIMD "SSE2"
+#else
+  #define ARM_HOST_SIMD "none"
+#endif
+
+#define ARM_HOST_FFT_MAX (2048u)
+
+/*
+*********************************************************************
+*
+*   q15 dot product
+*
+*   The vector versions multiply pairs with PMADDWD, whose 32 bit pair
+*   sum only overflows for (-32768 * -32768) * 2; the FIR checks its
+*   taps once per call and falls back to the scalar loop if two
+*   neighbouring taps are both -32768.
+*
+*********************************************************************
+*/
+
+static q63_t arm_host_dot_q15(const q15_t *x, const q15_t *c, uint32_t len)
+{
+  q63_t sum = 0;
+  uint32_t k;
+
+  for (k = 0; k < len; k++)
+  {
+    sum += (q31_t)x[k] * c[k];
+  }
+  return sum;
+}
+
+#if defined(__AVX2__)
+
+static q63_t arm_host_dot_q15_simd(const q15_t *x, const q15_t *c, uint32_t len)
+{
+  __m256i sum = _mm256_setzero_si256();
+  __m256i pairs;
+  int64_t lanes[4];
+  uint32_t k;
+
+  for (k = 0; k + 16u <= len; k += 16u)
+  {
+    pairs = _mm256_madd_epi16(_mm256_loadu_si256((const __m256i *)&x[k]), _mm256_loadu_si256((const __m256i *)&c[k]));
+    sum = _mm256_add_epi64(sum, _mm256_cvtepi32_epi64(_mm256_castsi256_si128(pairs)));
+    sum = _mm256_add_epi64(sum, _mm256_cvtepi32_epi64(_mm256_extracti128_si256(pairs, 1)));
+  }
+  _mm256_storeu_si256((__m256i *)lanes, sum);
+  return lanes[0] + lanes[1] + lanes[2] + lanes[3] + arm_host_dot_q15(&x[k], &c[k], len - k);
+}
+
+#elif defined(__SSE2__)
+
+static q63_t arm_host_dot_q15_simd(const q15_t *x, const q15_t *c, uint32_t len)
+{
+  __m128i sum = _mm_setzero_si128();
+  __m128i pairs, sign;
+  int64_t lanes[2];
+  uint32_t k;
+
+  for (k = 0; k + 8u <= len; k += 8u)
+  {
+    pairs = _mm_madd_epi16(_mm_loadu_si128((const __m128i *)&x[k]), _mm_loadu_si128((const __m128i *)&c[k]));
+    sign = _mm_srai_epi32(pairs, 31);
+    sum = _mm_add_epi64(sum, _mm_unpacklo_epi32(pairs, sign));
+    sum = _mm_add_epi64(sum, _mm_unpackhi_epi32(pairs, sign));
+  }
+  _mm_storeu_si128((__m128i *)lanes, sum);
+  return lanes[0] + lanes[1] + arm_host_dot_q15(&x[k], &c[k], len - k);
+}
+
+#endif
+
+#if defined(__AVX2__) || defined(__SSE2__)
+
+static uint32_t arm_host_dot_q15_simd_safe(const q15_t *c, uint32_t len)
+{
+  uint32_t k;
+
+  for (k = 0; k + 1u < len; k += 2u)
+  {
+    if ((c[k] == -32768) && (c[k + 1u] == -32768))
+    {
+      return 0;
+    }
+  }
+  return 1;
+}
+
+#endif
+
+/*
+*********************************************************************
+*
+*   FIR
+*
+*   State: numTaps - 1 old samples followed by the new block; taps in
+*   time reversed order, as in the library
+*
+*********************************************************************
+*/
+
+arm_status arm_fir_init_q15(arm_fir_instance_q15 *S, uint16_t numTaps, q15_t *pCoeffs, q15_t *pState,
+                            uint32_t blockSize)
+{
+  // the Cortex-M4 version processes tap pairs
+  if ((numTaps < 4u) || ((numTaps & 1u) != 0))
+  {
+    return ARM_MATH_ARGUMENT_ERROR;
+  }
+  S->numTaps = numTaps;
+  S->pCoeffs = pCoeffs;
+  S->pState = pState;
+  memset(pState, 0, (numTaps + blockSize - 1u) * sizeof(q15_t));
+  return ARM_MATH_SUCCESS;
+}
+
+void arm_fir_q15(const arm_fir_instance_q15 *S, q15_t *pSrc, q15_t *pDst, uint32_t blockSize)
+{
+  uint32_t num_taps = S->numTaps;
+  q15_t *state = S->pState;
+  uint32_t n;
+
+  memcpy(&state[num_taps - 1u], pSrc, blockSize * sizeof(q15_t));
+
+#if defined(__AVX2__) || defined(__SSE2__)
+  if (arm_host_dot_q15_simd_safe(S->pCoeffs, num_taps))
+  {
+    for (n = 0; n < blockSize; n++)
+    {
+      pDst[n] = (q15_t)__SSAT((q31_t)(arm_host_dot_q15_simd(&state[n], S->pCoeffs, num_taps) >> 15), 16);
+    }
+  }
+  else
+#endif
+  {
+    for (n = 0; n < blockSize; n++)
+    {
+      pDst[n] = (q15_t)__SSAT((q31_t)(arm_host_dot_q15(&state[n], S->pCoeffs, num_taps) >> 15), 16);
+    }
+  }
+
+  memmove(state, &state[blockSize], (num_taps - 1u) * sizeof(q15_t));
+}
+
+void arm_fir_init_q31(arm_fir_instance_q31 *S, uint16_t numTaps, q31_t *pCoeffs, q31_t *pState, uint32_t blockSize)
+{
+  S->numTaps = numTaps;
+  S->pCoeffs = pCoeffs;
+  S->pState = pState;
+  memset(pState, 0, (numTaps + blockSize - 1u) * sizeof(q31_t));
+}
+
+void arm_fir_q31(const arm_fir_instance_q31 *S, q31_t *pSrc, q31_t *pDst, uint32_t blockSize)
+{
+  uint32_t num_taps = S->numTaps;
+  q31_t *state = S->pState;
+  q63_t sum;
+  uint32_t n, k;
+
+  memcpy(&state[num_taps - 1u], pSrc, blockSize * sizeof(q31_t));
+  for (n = 0; n < blockSize; n++)
+  {
+    sum = 0;
+    for (k = 0; k < num_taps; k++)
+    {
+      sum += (q63_t)state[n + k] * S->pCoeffs[k];
+    }
+    pDst[n] = (q31_t)(sum >> 31);
+  }
+  memmove(state, &state[blockSize], (num_taps - 1u) * sizeof(q31_t));
+}
+
+void arm_fir_init_f32(arm_fir_instance_f32 *S, uint16_t numTaps, float32_t *pCoeffs, float32_t *pState,
+                      uint32_t blockSize)
+{
+  S->numTaps = numTaps;
+  S->pCoeffs = pCoeffs;
+  S->pState = pState;
+  memset(pState, 0, (numTaps + blockSize - 1u) * sizeof(float32_t));
+}
+
+void arm_fir_f32(const arm_fir_instance_f32 *S, float32_t *pSrc, float32_t *pDst, uint32_t blockSize)
+{
+  uint32_t num_taps = S->numTaps;
+  float32_t *state = S->pState;
+  float32_t sum;
+  uint32_t n, k;
+
+  memcpy(&state[num_taps - 1u], pSrc, blockSize * sizeof(float32_t));
+  for (n = 0; n < blockSize; n++)
+  {
+    sum = 0.0f;
+    for (k = 0; k < num_taps; k++)
+    {
+      sum += state[n + k] * S->pCoeffs[k];
+    }
+    pDst[n] = sum;
+  }
+  memmove(state, &state[blockSize], (num_taps - 1u) * sizeof(float32_t));
+}
+
+/*
+*********************************************************************
+*
+*   Multirate FIR
+*
+*********************************************************************
+*/
+
+arm_status arm_fir_decimate_init_q15(arm_fir_decimate_instance_q15 *S, uint16_t numTaps, uint8_t M, q15_t *pCoeffs,
+                                     q15_t *pState, uint32_t blockSize)
+{
+  if ((blockSize % M) != 0)
+  {
+    return ARM_MATH_LENGTH_ERROR;
+  }
+  S->M = M;
+  S->numTaps = numTaps;
+  S->pCoeffs = pCoeffs;
+  S->pState = pState;
+  memset(pState, 0, (numTaps + blockSize - 1u) * sizeof(q15_t));
+  return ARM_MATH_SUCCESS;
+}
+
+void arm_fir_decimate_q15(const arm_fir_decimate_instance_q15 *S, q15_t *pSrc, q15_t *pDst, uint32_t blockSize)
+{
+  uint32_t num_taps = S->numTaps;
+  q15_t *state = S->pState;
+  uint32_t n;
+
+  memcpy(&state[num_taps - 1u], pSrc, blockSize * sizeof(q15_t));
+  for (n = 0; n < blockSize / S->M; n++)
+  {
+    pDst[n] = (q15_t)__SSAT((q31_t)(arm_host_dot_q15(&state[n * S->M], S->pCoeffs, num_taps) >> 15), 16);
+  }
+  memmove(state, &state[blockSize], (num_taps - 1u) * sizeof(q15_t));
+}
+
+arm_status arm_fir_interpolate_init_q15(arm_fir_interpolate_instance_q15 *S, uint8_t L, uint16_t numTaps,
+                                        q15_t *pCoeffs, q15_t *pState, uint32_t blockSize)
+{
+  if ((numTaps % L) != 0)
+  {
+    return ARM_MATH_LENGTH_ERROR;
+  }
+  S->L = L;
+  S->phaseLength = numTaps / L;
+  S->pCoeffs = pCoeffs;
+  S->pState = pState;
+  memset(pState, 0, (S->phaseLength + blockSize - 1u) * sizeof(q15_t));
+  return ARM_MATH_SUCCESS;
+}
+
+void arm_fir_interpolate_q15(const arm_fir_interpolate_instance_q15 *S, q15_t *pSrc, q15_t *pDst,
+                             uint32_t blockSize)
+{
+  uint32_t phase_len = S->phaseLength;
+  uint32_t L = S->L;
+  q15_t *state = S->pState;
+  q63_t sum;
+  uint32_t n, phase, k;
+
+  memcpy(&state[phase_len - 1u], pSrc, blockSize * sizeof(q15_t));
+  for (n = 0; n < blockSize; n++)
+  {
+    // output phase p uses taps L - 1 - p, 2L - 1 - p, ...
+    for (phase = 1; phase <= L; phase++)
+    {
+      sum = 0;
+      for (k = 0; k < phase_len; k++)
+      {
+        sum += (q31_t)state[n + k] * S->pCoeffs[(L - phase) + k * L];
+      }
+      *pDst++ = (q15_t)__SSAT((q31_t)(sum >> 15), 16);
+    }
+  }
+  memmove(state, &state[blockSize], (phase_len - 1u) * sizeof(q15_t));
+}
+
+/*
+*********************************************************************
+*
+*   Biquad cascade, direct form I
+*
+*   State per stage: x[n-1], x[n-2], y[n-1], y[n-2]. q15 taps are
+*   {b0, 0, b1, b2, a1, a2}, q31 and f32 taps {b0, b1, b2, a1, a2}
+*   (a1, a2 with the sign of the recursion, y = ... + a1 y[n-1]).
+*
+*********************************************************************
+*/
+
+void arm_biquad_cascade_df1_init_q15(arm_biquad_casd_df1_inst_q15 *S, uint8_t numStages, q15_t *pCoeffs,
+                                     q15_t *pState, int8_t postShift)
+{
+  S->numStages = (int8_t)numStages;
+  S->pCoeffs = pCoeffs;
+  S->pState = pState;
+  S->postShift = postShift;
+  memset(pState, 0, 4u * numStages * sizeof(q15_t));
+}
+
+void arm_biquad_cascade_df1_q15(const arm_biquad_casd_df1_inst_q15 *S, q15_t *pSrc, q15_t *pDst, uint32_t blockSize)
+{
+  const q15_t *coeff = S->pCoeffs;
+  q15_t *state = S->pState;
+  q15_t *input = pSrc;
+  int32_t shift = 15 - S->postShift;
+  q63_t sum;
+  q15_t x, y;
+  int32_t stage;
+  uint32_t n;
+
+  for (stage = 0; stage < S->numStages; stage++)
+  {
+    for (n = 0; n < blockSize; n++)
+    {
+      x = input[n];
+      sum = (q31_t)coeff[0] * x + (q31_t)coeff[2] * state[0] + (q31_t)coeff[3] * state[1];
+      sum += (q31_t)coeff[4] * state[2] + (q31_t)coeff[5] * state[3];
+      y = (q15_t)__SSAT((q31_t)(sum >> shift), 16);
+
+      state[1] = state[0];
+      state[0] = x;
+      state[3] = state[2];
+      state[2] = y;
+      pDst[n] = y;
+    }
+    input = pDst;
+    coeff += 6;
+    state += 4;
+  }
+}
+
+void arm_biquad_cascade_df1_init_q31(arm_biquad_casd_df1_inst_q31 *S, uint8_t numStages, q31_t *pCoeffs,
+                                     q31_t *pState, int8_t postShift)
+{
+  S->numStages = numStages;
+  S->pCoeffs = pCoeffs;
+  S->pState = pState;
+  S->postShift = (uint8_t)postShift;
+  memset(pState, 0, 4u * numStages * sizeof(q31_t));
+}
+
+// no saturation: the library lets the q31 output wrap around
+void arm_biquad_cascade_df1_q31(const arm_biquad_casd_df1_inst_q31 *S, q31_t *pSrc, q31_t *pDst, uint32_t blockSize)
+{
+  const q31_t *coeff = S->pCoeffs;
+  q31_t *state = S->pState;
+  q31_t *input = pSrc;
+  int32_t shift = 31 - S->postShift;
+  q63_t sum;
+  q31_t x, y;
+  uint32_t stage, n;
+
+  for (stage = 0; stage < S->numStages; stage++)
+  {
+    for (n = 0; n < blockSize; n++)
+    {
+      x = input[n];
+      sum = (q63_t)coeff[0] * x + (q63_t)coeff[1] * state[0] + (q63_t)coeff[2] * state[1];
+      sum += (q63_t)coeff[3] * state[2] + (q63_t)coeff[4] * state[3];
+      y = (q31_t)(sum >> shift);
+
+      state[1] = state[0];
+      state[0] = x;
+      state[3] = state[2];
+      state[2] = y;
+      pDst[n] = y;
+    }
+    input = pDst;
+    coeff += 5;
+    state += 4;
+  }
+}
+
+void arm_biquad_cascade_df1_init_f32(arm_biquad_casd_df1_inst_f32 *S, uint8_t numStages, float32_t *pCoeffs,
+                                     float32_t *pState)
+{
+  S->numStages = numStages;
+  S->pCoeffs = pCoeffs;
+  S->pState = pState;
+  memset(pState, 0, 4u * numStages * sizeof(float32_t));
+}
+
+void arm_biquad_cascade_df1_f32(const arm_biquad_casd_df1_inst_f32 *S, float32_t *pSrc, float32_t *pDst,
+                                uint32_t blockSize)
+{
+  const float32_t *coeff = S->pCoeffs;
+  float32_t *state = S->pState;
+  float32_t *input = pSrc;
+  float32_t x, y;
+  uint32_t stage, n;
+
+  for (stage = 0; stage < S->numStages; stage++)
+  {
+    for (n = 0; n < blockSize; n++)
+    {
+      x = input[n];
+      y = coeff[0] * x + coeff[1] * state[0] + coeff[2] * state[1] + coeff[3] * state[2] + coeff[4] * state[3];
+
+      state[1] = state[0];
+      state[0] = x;
+      state[3] = state[2];
+      state[2] = y;
+      pDst[n] = y;
+    }
+    input = pDst;
+    coeff += 5;
+    state += 4;
+  }
+}
+
+/*
+*********************************************************************
+*
+*   FFTs, q31 and q15
+*
+*   Same sizes, output layout and scaling as the library: the forward
+*   transform writes all N bins (re, im) scaled by 1/N, the inverse
+*   reads bins 0 .. N/2 and writes the N real samples of the inverse
+*   DFT. Computed in double and truncated, so the last bit differs
+*   from the fixed point butterflies. The source buffer is destroyed,
+*   as on the target, to catch callers that still read it.
+*
+*********************************************************************
+*/
+
+static float64_t arm_host_fft_re[ARM_HOST_FFT_MAX];
+static float64_t arm_host_fft_im[ARM_HOST_FFT_MAX];
+
+static void arm_host_fft(uint32_t len, float64_t sign)
+{
+  float64_t w_re, w_im, t_re, t_im, u_re, u_im, odd_re, odd_im, angle;
+  uint32_t i, j, bit, span, start, k;
+
+  for (i = 1, j = 0; i < len; i++)
+  {
+    for (bit = len >> 1; j & bit; bit >>= 1)
+    {
+      j ^= bit;
+    }
+    j |= bit;
+    if (i < j)
+    {
+      t_re = arm_host_fft_re[i];
+      arm_host_fft_re[i] = arm_host_fft_re[j];
+      arm_host_fft_re[j] = t_re;
+      t_im = arm_host_fft_im[i];
+      arm_host_fft_im[i] = arm_host_fft_im[j];
+      arm_host_fft_im[j] = t_im;
+    }
+  }
+
+  for (span = 1; span < len; span <<= 1)
+  {
+    for (k = 0; k < span; k++)
+    {
+      angle = sign * 3.14159265358979323846 * (float64_t)k / (float64_t)span;
+      w_re = cos(angle);
+      w_im = sin(angle);
+      for (start = k; start < len; start += 2u * span)
+      {
+        u_re = arm_host_fft_re[start];
+        u_im = arm_host_fft_im[start];
+        odd_re = arm_host_fft_re[start + span];
+        odd_im = arm_host_fft_im[start + span];
+        t_re = odd_re * w_re - odd_im * w_im;
+        t_im = odd_re * w_im + odd_im * w_re;
+        arm_host_fft_re[start] = u_re + t_re;
+        arm_host_fft_im[start] = u_im + t_im;
+        arm_host_fft_re[start + span] = u_re - t_re;
+        arm_host_fft_im[start + span] = u_im - t_im;
+      }
+    }
+  }
+}
+
+arm_status arm_rfft_init_q31(arm_rfft_instance_q31 *S, arm_cfft_radix4_instance_q31 *S_CFFT, uint32_t fftLenReal,
+                             uint32_t ifftFlagR, uint32_t bitReverseFlag)
+{
+  if ((fftLenReal != 128u) && (fftLenReal != 512u) && (fftLenReal != 2048u))
+  {
+    return ARM_MATH_ARGUMENT_ERROR;
+  }
+  S->fftLenReal = fftLenReal;
+  S->fftLenBy2 = fftLenReal / 2u;
+  S->ifftFlagR = (uint8_t)ifftFlagR;
+  S->bitReverseFlagR = (uint8_t)bitReverseFlag;
+  S->pCfft = S_CFFT;
+  S_CFFT->fftLen = (uint16_t)(fftLenReal / 2u);
+  S_CFFT->ifftFlag = (uint8_t)ifftFlagR;
+  S_CFFT->bitReverseFlag = (uint8_t)bitReverseFlag;
+  return ARM_MATH_SUCCESS;
+}
+
+void arm_rfft_q31(const arm_rfft_instance_q31 *S, q31_t *pSrc, q31_t *pDst)
+{
+  uint32_t len = S->fftLenReal;
+  uint32_t k, mirror;
+
+  if (S->ifftFlagR == 0)
+  {
+    for (k = 0; k < len; k++)
+    {
+      arm_host_fft_re[k] = (float64_t)pSrc[k];
+      arm_host_fft_im[k] = 0.0;
+    }
+    arm_host_fft(len, -1.0);
+    for (k = 0; k < len; k++)
+    {
+      pDst[2u * k] = (q31_t)floor(arm_host_fft_re[k] / (float64_t)len);
+      pDst[2u * k + 1u] = (q31_t)floor(arm_host_fft_im[k] / (float64_t)len);
+    }
+    memset(pSrc, 0x55, len * sizeof(q31_t));
+  }
+  else
+  {
+    for (k = 0; k < len; k++)
+    {
+      mirror = (k <= len / 2u) ? k : len - k;
+      arm_host_fft_re[k] = (float64_t)pSrc[2u * mirror];
+      arm_host_fft_im[k] = (k <= len / 2u) ? (float64_t)pSrc[2u * mirror + 1u] : -(float64_t)pSrc[2u * mirror + 1u];
+    }
+    arm_host_fft(len, 1.0);
+    for (k = 0; k < len; k++)
+    {
+      pDst[k] = (q31_t)floor(arm_host_fft_re[k] / (float64_t)len);
+    }
+    memset(pSrc, 0x55, 2u * len * sizeof(q31_t));
+  }
+}
+
+arm_status arm_cfft_radix4_init_q15(arm_cfft_radix4_instance_q15 *S, uint16_t fftLen, uint8_t ifftFlag,
+                                    uint8_t bitReverseFlag)
+{
+  if ((fftLen != 16u) && (fftLen != 64u) && (fftLen != 256u) && (fftLen != 1024u))
+  {
+    return ARM_MATH_ARGUMENT_ERROR;
+  }
+  S->fftLen = fftLen;
+  S->ifftFlag = ifftFlag;
+  S->bitReverseFlag = bitReverseFlag;
+  return ARM_MATH_SUCCESS;
+}
+
+// in place, forward and inverse both scaled by 1/N
+void arm_cfft_radix4_q15(const arm_cfft_radix4_instance_q15 *S, q15_t *pSrc)
+{
+  uint32_t len = S->fftLen;
+  uint32_t k;
+
+  for (k = 0; k < len; k++)
+  {
+    arm_host_fft_re[k] = (float64_t)pSrc[2u * k];
+    arm_host_fft_im[k] = (float64_t)pSrc[2u * k + 1u];
+  }
+  arm_host_fft(len, S->ifftFlag ? 1.0 : -1.0);
+  for (k = 0; k < len; k++)
+  {
+    pSrc[2u * k] = (q15_t)floor(arm_host_fft_re[k] / (float64_t)len);
+    pSrc[2u * k + 1u] = (q15_t)floor(arm_host_fft_im[k] / (float64_t)len);
+  }
+}
+
+arm_status arm_rfft_init_q15(arm_rfft_instance_q15 *S, arm_cfft_radix4_instance_q15 *S_CFFT, uint32_t fftLenReal,
+                             uint32_t ifftFlagR, uint32_t bitReverseFlag)
+{
+  if ((fftLenReal != 128u) && (fftLenReal != 512u) && (fftLenReal != 2048u))
+  {
+    return ARM_MATH_ARGUMENT_ERROR;
+  }
+  S->fftLenReal = fftLenReal;
+  S->fftLenBy2 = fftLenReal / 2u;
+  S->ifftFlagR = (uint8_t)ifftFlagR;
+  S->bitReverseFlagR = (uint8_t)bitReverseFlag;
+  S->pCfft = S_CFFT;
+  S_CFFT->fftLen = (uint16_t)(fftLenReal / 2u);
+  S_CFFT->ifftFlag = (uint8_t)ifftFlagR;
+  S_CFFT->bitReverseFlag = (uint8_t)bitReverseFlag;
+  return ARM_MATH_SUCCESS;
+}
+
+void arm_rfft_q15(const arm_rfft_instance_q15 *S, q15_t *pSrc, q15_t *pDst)
+{
+  uint32_t len = S->fftLenReal;
+  uint32_t k, mirror;
+
+  if (S->ifftFlagR == 0)
+  {
+    for (k = 0; k < len; k++)
+    {
+      arm_host_fft_re[k] = (float64_t)pSrc[k];
+      arm_host_fft_im[k] = 0.0;
+    }
+    arm_host_fft(len, -1.0);
+    for (k = 0; k < len; k++)
+    {
+      pDst[2u * k] = (q15_t)floor(arm_host_fft_re[k] / (float64_t)len);
+      pDst[2u * k + 1u] = (q15_t)floor(arm_host_fft_im[k] / (float64_t)len);
+    }
+    memset(pSrc, 0x55, len * sizeof(q15_t));
+  }
+  else
+  {
+    for (k = 0; k < len; k++)
+    {
+      mirror = (k <= len / 2u) ? k : len - k;
+      arm_host_fft_re[k] = (float64_t)pSrc[2u * mirror];
+      arm_host_fft_im[k] = (k <= len / 2u) ? (float64_t)pSrc[2u * mirror + 1u] : -(float64_t)pSrc[2u * mirror + 1u];
+    }
+    arm_host_fft(len, 1.0);
+    for (k = 0; k < len; k++)
+    {
+      pDst[k] = (q15_t)floor(arm_host_fft_re[k] / (float64_t)len);
+    }
+    memset(pSrc, 0x55, 2u * len * sizeof(q15_t));
+  }
+}
+
+/*
+*********************************************************************
+*
+*   Normalized LMS
+*
+*   Same interface and formats as the library (pSrc is the reference
+*   input, pRef the desired signal); the energy and step size updates
+*   round differently, so the adaptation is close but not identical.
+*
+*********************************************************************
+*/
+
+void arm_lms_norm_init_q15(arm_lms_norm_instance_q15 *S, uint16_t numTaps, q15_t *pCoeffs, q15_t *pState,
+                           q15_t mu, uint32_t blockSize, uint8_t postShift)
+{
+  S->numTaps = numTaps;
+  S->pCoeffs = pCoeffs;
+  S->pState = pState;
+  S->mu = mu;
+  S->postShift = postShift;
+  S->recipTable = 0;
+  S->energy = 0;
+  S->x0 = 0;
+  memset(pState, 0, (numTaps + blockSize - 1u) * sizeof(q15_t));
+}
+
+void arm_lms_norm_q15(arm_lms_norm_instance_q15 *S, q15_t *pSrc, q15_t *pRef, q15_t *pOut, q15_t *pErr,
+                      uint32_t blockSize)
+{
+  uint32_t num_taps = S->numTaps;
+  q15_t *state = S->pState;
+  q15_t *coeff = S->pCoeffs;
+  q31_t energy = S->energy;
+  q15_t x0 = S->x0;
+  q15_t y, error, error_mu;
+  q31_t weight;
+  uint32_t n, k;
+
+  for (n = 0; n < blockSize; n++)
+  {
+    state[num_taps - 1u + n] = pSrc[n];
+    energy -= ((q31_t)x0 * x0) >> 15;
+    energy += ((q31_t)pSrc[n] * pSrc[n]) >> 15;
+    energy = __SSAT(energy, 16);
+
+    y = (q15_t)__SSAT((q31_t)(arm_host_dot_q15(&state[n], coeff, num_taps) >> (15 - S->postShift)), 16);
+    pOut[n] = y;
+    error = (q15_t)__SSAT((q31_t)pRef[n] - y, 16);
+    pErr[n] = error;
+
+    error_mu = (q15_t)(((q31_t)error * S->mu) >> 15);
+    weight = __SSAT((q31_t)(((q63_t)error_mu << 15) / (energy + 1)), 16);
+    for (k = 0; k < num_taps; k++)
+    {
+      coeff[k] = (q15_t)__SSAT(coeff[k] + (((q31_t)weight * state[n + k]) >> 15), 16);
+    }
+    x0 = state[n];
+  }
+
+  S->energy = energy;
+  S->x0 = x0;
+  memmove(state, &state[blockSize], (num_taps - 1u) * sizeof(q15_t));
+}
+
+void arm_lms_norm_init_q31(arm_lms_norm_instance_q31 *S, uint16_t numTaps, q31_t *pCoeffs, q31_t *pState,
+                           q31_t mu, uint32_t blockSize, uint8_t postShift)
+{
+  S->numTaps = numTaps;
+  S->pCoeffs = pCoeffs;
+  S->pState = pState;
+  S->mu = mu;
+  S->postShift = postShift;
+  S->recipTable = 0;
+  S->energy = 0;
+  S->x0 = 0;
+  memset(pState, 0, (numTaps + blockSize - 1u) * sizeof(q31_t));
+}
+
+void arm_lms_norm_q31(arm_lms_norm_instance_q31 *S, q31_t *pSrc, q31_t *pRef, q31_t *pOut, q31_t *pErr,
+                      uint32_t blockSize)
+{
+  uint32_t num_taps = S->numTaps;
+  q31_t *state = S->pState;
+  q31_t *coeff = S->pCoeffs;
+  q63_t energy = S->energy;
+  q31_t x0 = S->x0;
+  q31_t y, error, error_mu, weight;
+  q63_t sum;
+  uint32_t n, k;
+
+  for (n = 0; n < blockSize; n++)
+  {
+    state[num_taps - 1u + n] = pSrc[n];
+    energy -= ((q63_t)x0 * x0) >> 31;
+    energy += ((q63_t)pSrc[n] * pSrc[n]) >> 31;
+    energy = (energy > INT32_MAX) ? INT32_MAX : ((energy < 0) ? 0 : energy);
+
+    sum = 0;
+    for (k = 0; k < num_taps; k++)
+    {
+      sum += ((q63_t)state[n + k] * coeff[k]) >> 32;
+    }
+    y = clip_q63_to_q31(sum << (1 + S->postShift));
+    pOut[n] = y;
+    error = __QSUB(pRef[n], y);
+    pErr[n] = error;
+
+    error_mu = (q31_t)(((q63_t)error * S->mu) >> 31);
+    weight = clip_q63_to_q31(((q63_t)error_mu << 31) / (energy + 1));
+    for (k = 0; k < num_taps; k++)
+    {
+      coeff[k] = __QADD(coeff[k], (q31_t)(((q63_t)weight * state[n + k]) >> 31));
+    }
+    x0 = state[n];
+  }
+
+  S->energy = (q31_t)energy;
+  S->x0 = x0;
+  memmove(state, &state[blockSize], (num_taps - 1u) * sizeof(q31_t));
+}
+
+/*
+*********************************************************************
+*
+*   Sine and cosine
+*
+*   The angle is reduced to a fraction of a turn, the table of 256
+*   points per turn (plus one guard entry before and two after) is
+*   interpolated with the cubic Lagrange polynomial through the four
+*   nearest points. The table is filled on first use.
+*
+*********************************************************************
+*/
+
+#define ARM_HOST_SIN_TABLE_LEN (256u)
+
+static float32_t arm_host_sin_table[ARM_HOST_SIN_TABLE_LEN + 3u];
+static uint32_t arm_host_sin_table_ready = 0;
+
+static float32_t arm_host_sin_turn(float32_t turns)
+{
+  float32_t fract, fract_sq, fract_cube, a, b, c, d;
+  const float32_t *y;
+  int32_t n;
+  uint32_t index, k;
+
+  if (!arm_host_sin_table_ready)
+  {
+    for (k = 0; k < ARM_HOST_SIN_TABLE_LEN + 3u; k++)
+    {
+      arm_host_sin_table[k] = (float32_t)sin(2.0 * 3.14159265358979323846 * ((float64_t)k - 1.0) /
+                                             (float64_t)ARM_HOST_SIN_TABLE_LEN);
+    }
+    arm_host_sin_table_ready = 1;
+  }
+
+  n = (int32_t)turns;
+  if (turns < 0.0f)
+  {
+    n--;
+  }
+  turns -= (float32_t)n;
+
+  fract = (float32_t)ARM_HOST_SIN_TABLE_LEN * turns;
+  index = (uint32_t)fract;
+  fract -= (float32_t)index;
+  index %= ARM_HOST_SIN_TABLE_LEN;
+  y = &arm_host_sin_table[index];   // y[0 .. 3] = points index - 1 .. index + 2
+
+  fract_sq = fract * fract;
+  fract_cube = fract * fract_sq;
+  a = -0.166666667f * fract_cube + 0.5f * fract_sq - 0.333333333f * fract;
+  b = 0.5f * fract_cube - fract_sq - 0.5f * fract + 1.0f;
+  c = -0.5f * fract_cube + 0.5f * fract_sq + fract;
+  d = 0.166666667f * fract_cube - 0.166666667f * fract;
+
+  return a * y[0] + b * y[1] + c * y[2] + d * y[3];
+}
+
+float32_t arm_sin_f32(float32_t x)
+{
+  return arm_host_sin_turn(x * 0.159154943092f);
+}
+
+float32_t arm_cos_f32(float32_t x)
+{
+  return arm_host_sin_turn(x * 0.159154943092f + 0.25f);
+}
+
+/*
+*********************************************************************
+*
+*   Conversions
+*
+*   Float to fixed point is a truncating VCVT on the target: round
+*   toward zero, saturate to 32 bits, NaN gives 0
+*
+*********************************************************************
+*/
+
+static q31_t arm_host_vcvt_s32(float32_t x)
+{
+  if (x != x)
+  {
+    return 0;
+  }
+  if (x >= 2147483648.0f)
+  {
+    return INT32_MAX;
+  }
+  if (x <= -2147483648.0f)
+  {
+    return INT32_MIN;
+  }
+  return (q31_t)x;
+}
+
+static void arm_host_float_to_q15(const float32_t *pSrc, q15_t *pDst, uint32_t blockSize)
+{
+  uint32_t n;
+
+  for (n = 0; n < blockSize; n++)
+  {
+    pDst[n] = (q15_t)__SSAT(arm_host_vcvt_s32(pSrc[n] * 32768.0f), 16);
+  }
+}
+
+// scale, NaN to 0, clamp to the q15 range, truncate, pack
+#if defined(__AVX2__)
+
+void arm_float_to_q15(float32_t *pSrc, q15_t *pDst, uint32_t blockSize)
+{
+  const __m256 scale = _mm256_set1_ps(32768.0f);
+  const __m256 min = _mm256_set1_ps(-32768.0f);
+  const __m256 max = _mm256_set1_ps(32767.0f);
+  __m256 x;
+  __m256i low, high;
+  uint32_t n;
+
+  for (n = 0; n + 16u <= blockSize; n += 16u)
+  {
+    x = _mm256_mul_ps(_mm256_loadu_ps(&pSrc[n]), scale);
+    x = _mm256_and_ps(x, _mm256_cmp_ps(x, x, _CMP_ORD_Q));
+    low = _mm256_cvttps_epi32(_mm256_min_ps(_mm256_max_ps(x, min), max));
+    x = _mm256_mul_ps(_mm256_loadu_ps(&pSrc[n + 8u]), scale);
+    x = _mm256_and_ps(x, _mm256_cmp_ps(x, x, _CMP_ORD_Q));
+    high = _mm256_cvttps_epi32(_mm256_min_ps(_mm256_max_ps(x, min), max));
+    // the pack works per 128 bit lane; put the quarters back in order
+    _mm256_storeu_si256((__m256i *)&pDst[n], _mm256_permute4x64_epi64(_mm256_packs_epi32(low, high), 0xD8));
+  }
+  arm_host_float_to_q15(&pSrc[n], &pDst[n], blockSize - n);
+}
+
+#elif defined(__SSE2__)
+
+void arm_float_to_q15(float32_t *pSrc, q15_t *pDst, uint32_t blockSize)
+{
+  const __m128 scale = _mm_set1_ps(32768.0f);
+  const __m128 min = _mm_set1_ps(-32768.0f);
+  const __m128 max = _mm_set1_ps(32767.0f);
+  __m128 x;
+  __m128i low, high;
+  uint32_t n;
+
+  for (n = 0; n + 8u <= blockSize; n += 8u)
+  {
+    x = _mm_mul_ps(_mm_loadu_ps(&pSrc[n]), scale);
+    x = _mm_and_ps(x, _mm_cmpord_ps(x, x));
+    low = _mm_cvttps_epi32(_mm_min_ps(_mm_max_ps(x, min), max));
+    x = _mm_mul_ps(_mm_loadu_ps(&pSrc[n + 4u]), scale);
+    x = _mm_and_ps(x, _mm_cmpord_ps(x, x));
+    high = _mm_cvttps_epi32(_mm_min_ps(_mm_max_ps(x, min), max));
+    _mm_storeu_si128((__m128i *)&pDst[n], _mm_packs_epi32(low, high));
+  }
+  arm_host_float_to_q15(&pSrc[n], &pDst[n], blockSize - n);
+}
+
+#else
+
+void arm_float_to_q15(float32_t *pSrc, q15_t *pDst, uint32_t blockSize)
+{
+  arm_host_float_to_q15(pSrc, pDst, blockSize);
+}
+
+#endif
+
+void arm_float_to_q31(float32_t *pSrc, q31_t *pDst, uint32_t blockSize)
+{
+  uint32_t n;
+
+  for (n = 0; n < blockSize; n++)
+  {
+    pDst[n] = arm_host_vcvt_s32(pSrc[n] * 2147483648.0f);
+  }
+}
+
+void arm_q15_to_float(q15_t *pSrc, float32_t *pDst, uint32_t blockSize)
+{
+  uint32_t n;
+
+  for (n = 0; n < blockSize; n++)
+  {
+    pDst[n] = (float32_t)pSrc[n] / 32768.0f;
+  }
+}
+
+void arm_q31_to_float(q31_t *pSrc, float32_t *pDst, uint32_t blockSize)
+{
+  uint32_t n;
+
+  for (n = 0; n < blockSize; n++)
+  {
+    pDst[n] = (float32_t)pSrc[n] / 2147483648.0f;
+  }
+}
+
+void arm_q15_to_q31(q15_t *pSrc, q31_t *pDst, uint32_t blockSize)
+{
+  uint32_t n;
+
+  for (n = 0; n < blockSize; n++)
+  {
+    pDst[n] = (q31_t)((uint32_t)(q31_t)pSrc[n] << 16);
+  }
+}
+
+void arm_q31_to_q15(q31_t *pSrc, q15_t *pDst, uint32_t blockSize)
+{
+  uint32_t n;
+
+  for (n = 0; n < blockSize; n++)
+  {
+    pDst[n] = (q15_t)(pSrc[n] >> 16);
+  }
+}
+
+/*
+*********************************************************************
+*
+*   Basic vector functions
+*
+*********************************************************************
+*/
+
+void arm_mult_q15(q15_t *pSrcA, q15_t *pSrcB, q15_t *pDst, uint32_t blockSize)
+{
+  uint32_t n;
+
+  for (n = 0; n < blockSize; n++)
+  {
+    pDst[n] = (q15_t)__SSAT(((q31_t)pSrcA[n] * pSrcB[n]) >> 15, 16);
+  }
+}
+
+void arm_scale_q15(q15_t *pSrc, q15_t scaleFract, int8_t shift, q15_t *pDst, uint32_t blockSize)
+{
+  int32_t right_shift = 15 - shift;
+  uint32_t n;
+
+  for (n = 0; n < blockSize; n++)
+  {
+    pDst[n] = (q15_t)__SSAT(((q31_t)pSrc[n] * scaleFract) >> right_shift, 16);
+  }
+}
+
+void arm_copy_q15(q15_t *pSrc, q15_t *pDst, uint32_t blockSize)
+{
+  memmove(pDst, pSrc, blockSize * sizeof(q15_t));
+}
+
+void arm_copy_f32(float32_t *pSrc, float32_t *pDst, uint32_t blockSize)
+{
+  memmove(pDst, pSrc, blockSize * sizeof(float32_t));
+}
+
+void arm_fill_q15(q15_t value, q15_t *pDst, uint32_t blockSize)
+{
+  uint32_t n;
+
+  for (n = 0; n < blockSize; n++)
+  {
+    pDst[n] = value;
+  }
+}
+
+void arm_fill_q31(q31_t value, q31_t *pDst, uint32_t blockSize)
+{
+  uint32_t n;
+
+  for (n = 0; n < blockSize; n++)
+  {
+    pDst[n] = value;
+  }
+}
+
+void arm_fill_f32(float32_t value, float32_t *pDst, uint32_t blockSize)
+{
+  uint32_t n;
+
+  for (n = 0; n < blockSize; n++)
+  {
+    pDst[n] = value;
+  }
+}
+
+#ifdef ARM_MATH_HOST_CHECK
+
+/*
+*********************************************************************
+*
+*   Self-check
+*
+*   Every kernel is compared against a model written from the
+*   arithmetic spelled out above, run over the whole signal at once
+*   (so state handling across blocks of random length is covered
+*   too). The exit code is the number of failed checks.
+*
+*********************************************************************
+*/
+
+#include <stdio.h>
+
+#define CHECK_TRIALS  (200u)
+#define CHECK_LEN     (1024u)
+#define CHECK_TAPS    (64u)
+#define CHECK_STAGES  (3u)
+
+static uint32_t check_seed = 12345u;
+
+static uint32_t check_random(void)
+{
+  check_seed ^= check_seed << 13;
+  check_seed ^= check_seed >> 17;
+  check_seed ^= check_seed << 5;
+  return check_seed;
+}
+
+// full scale q15, with runs of -32768 now and then
+static q15_t check_random_q15(void)
+{
+  return ((check_random() & 15u) == 0) ? -32768 : (q15_t)check_random();
+}
+
+static uint32_t check_report(const char *name, uint32_t vectors, uint32_t mismatches)
+{
+  printf("%-28s %8u vectors %8u mismatches %s\n", name, (unsigned)vectors, (unsigned)mismatches,
+         mismatches ? "FAIL" : "ok");
+  return mismatches ? 1u : 0u;
+}
+
+static uint32_t check_fir_q15(void)
+{
+  static q15_t input[CHECK_LEN], output[CHECK_LEN], coeff[CHECK_TAPS], state[CHECK_TAPS + CHECK_LEN];
+  arm_fir_instance_q15 fir;
+  uint32_t mismatches = 0;
+  uint32_t trial, num_taps, done, block, n, k;
+  q63_t sum;
+
+  for (trial = 0; trial < CHECK_TRIALS; trial++)
+  {
+    num_taps = 4u + 2u * (check_random() % ((CHECK_TAPS - 4u) / 2u + 1u));
+    for (k = 0; k < num_taps; k++)
+    {
+      // every fourth trial has all taps at -32768 (scalar fallback)
+      coeff[k] = ((trial & 3u) == 3u) ? -32768 : check_random_q15();
+    }
+    for (n = 0; n < CHECK_LEN; n++)
+    {
+      input[n] = check_random_q15();
+    }
+
+    arm_fir_init_q15(&fir, (uint16_t)num_taps, coeff, state, CHECK_LEN);
+    for (done = 0; done < CHECK_LEN; done += block)
+    {
+      block = 1u + check_random() % 100u;
+      block = (block > CHECK_LEN - done) ? CHECK_LEN - done : block;
+      arm_fir_q15(&fir, &input[done], &output[done], block);
+    }
+
+    for (n = 0; n < CHECK_LEN; n++)
+    {
+      sum = 0;
+      for (k = 0; (k < num_taps) && (k <= n); k++)
+      {
+        sum += (q63_t)input[n - k] * coeff[num_taps - 1u - k];
+      }
+      sum >>= 15;
+      sum = (sum > 32767) ? 32767 : ((sum < -32768) ? -32768 : sum);
+      mismatches += (output[n] != (q15_t)sum);
+    }
+  }
+  return check_report("arm_fir_q15 (" ARM_HOST_SIMD ")", CHECK_TRIALS * CHECK_LEN, mismatches);
+}
+
+static uint32_t check_biquad_cascade_df1_q15(void)
+{
+  static q15_t input[CHECK_LEN], output[CHECK_LEN], expected[CHECK_LEN];
+  q15_t coeff[6u * CHECK_STAGES], state[4u * CHECK_STAGES];
+  arm_biquad_casd_df1_inst_q15 biquad;
+  uint32_t mismatches = 0;
+  uint32_t trial, num_stages, stage, done, block, n, k;
+  int8_t post_shift;
+  q63_t sum;
+
+  for (trial = 0; trial < CHECK_TRIALS; trial++)
+  {
+    num_stages = 1u + check_random() % CHECK_STAGES;
+    post_shift = (int8_t)(check_random() % 3u);
+    for (k = 0; k < 6u * num_stages; k++)
+    {
+      coeff[k] = ((k % 6u) == 1u) ? 0 : (q15_t)((q15_t)check_random() >> (check_random() % 4u));
+    }
+    for (n = 0; n < CHECK_LEN; n++)
+    {
+      input[n] = check_random_q15();
+    }
+
+    arm_biquad_cascade_df1_init_q15(&biquad, (uint8_t)num_stages, coeff, state, post_shift);
+    for (done = 0; done < CHECK_LEN; done += block)
+    {
+      block = 1u + check_random() % 100u;
+      block = (block > CHECK_LEN - done) ? CHECK_LEN - done : block;
+      arm_biquad_cascade_df1_q15(&biquad, &input[done], &output[done], block);
+    }
+
+    memcpy(expected, input, sizeof(expected));
+    for (stage = 0; stage < num_stages; stage++)
+    {
+      const q15_t *b = &coeff[6u * stage];
+      q15_t x1 = 0, x2 = 0, y1 = 0, y2 = 0, x;
+
+      for (n = 0; n < CHECK_LEN; n++)
+      {
+        x = expected[n];
+        sum = (q63_t)b[0] * x + (q63_t)b[2] * x1 + (q63_t)b[3] * x2 + (q63_t)b[4] * y1 + (q63_t)b[5] * y2;
+        sum = (q31_t)(sum >> (15 - post_shift));
+        sum = (sum > 32767) ? 32767 : ((sum < -32768) ? -32768 : sum);
+        x2 = x1;
+        x1 = x;
+        y2 = y1;
+        y1 = (q15_t)sum;
+        expected[n] = y1;
+      }
+    }
+
+    for (n = 0; n < CHECK_LEN; n++)
+    {
+      mismatches += (output[n] != expected[n]);
+    }
+  }
+  return check_report("arm_biquad_cascade_df1_q15", CHECK_TRIALS * CHECK_LEN, mismatches);
+}
+
+static uint32_t check_float_to_q15(void)
+{
+  static const struct
+  {
+    float32_t x;
+    q15_t q;
+  } edge[] =
+  {
+    { 0.0f, 0 }, { -0.0f, 0 }, { 0.5f, 16384 }, { -0.5f, -16384 }, { 1.0f, 32767 }, { -1.0f, -32768 },
+    { 0.99996f, 32766 }, { -1.00001f, -32768 }, { 1.5f / 32768.0f, 1 }, { -1.5f / 32768.0f, -1 },
+    { 0.9f / 32768.0f, 0 }, { 1e10f, 32767 }, { -1e10f, -32768 }, { 1e38f, 32767 }, { -1e38f, -32768 }
+  };
+  static float32_t input[CHECK_LEN];
+  static q15_t output[CHECK_LEN], expected[CHECK_LEN];
+  uint32_t num_edges = sizeof(edge) / sizeof(edge[0]);
+  uint32_t mismatches = 0;
+  uint32_t trial, len, n;
+  float32_t special[3];
+
+  special[0] = (float32_t)NAN;
+  special[1] = (float32_t)INFINITY;
+  special[2] = -(float32_t)INFINITY;
+
+  for (trial = 0; trial < CHECK_TRIALS; trial++)
+  {
+    len = 1u + check_random() % CHECK_LEN;
+    for (n = 0; n < len; n++)
+    {
+      // mostly within +-1.5, sometimes an edge case or far out of range
+      switch (check_random() & 7u)
+      {
+        case 0:
+          input[n] = edge[check_random() % num_edges].x;
+          break;
+        case 1:
+          input[n] = ((float32_t)(int32_t)check_random()) * 1e-3f;
+          break;
+        default:
+          input[n] = ((float32_t)(int32_t)check_random()) / 1431655765.0f;
+          break;
+      }
+    }
+    arm_float_to_q15(input, output, len);
+    arm_host_float_to_q15(input, expected, len);
+    for (n = 0; n < len; n++)
+    {
+      mismatches += (output[n] != expected[n]);
+    }
+  }
+
+  // the model itself against the hand computed values
+  for (n = 0; n < num_edges; n++)
+  {
+    arm_float_to_q15((float32_t *)&edge[n].x, output, 1);
+    mismatches += (output[0] != edge[n].q);
+  }
+  arm_float_to_q15(special, output, 3);
+  mismatches += (output[0] != 0) + (output[1] != 32767) + (output[2] != -32768);
+
+  return check_report("arm_float_to_q15 (" ARM_HOST_SIMD ")", CHECK_TRIALS * CHECK_LEN / 2u + num_edges + 3u,
+                      mismatches);
+}
+
+static uint32_t check_sin_f32(void)
+{
+  uint32_t mismatches = 0;
+  float64_t error, max_error = 0.0;
+  float32_t x;
+  uint32_t n;
+
+  // 4 turns either side of zero; 4e-6 allows for the reduction in float
+  for (n = 0; n < 1000000u; n++)
+  {
+    x = ((float32_t)n / 1000000.0f - 0.5f) * 16.0f * PI;
+    error = fabs((float64_t)arm_sin_f32(x) - sin((float64_t)x));
+    max_error = (error > max_error) ? error : max_error;
+    mismatches += (error > 4e-6);
+    error = fabs((float64_t)arm_cos_f32(x) - cos((float64_t)x));
+    max_error = (error > max_error) ? error : max_error;
+    mismatches += (error > 4e-6);
+  }
+  mismatches += (arm_sin_f32(0.0f) != 0.0f) + (arm_cos_f32(0.0f) != 1.0f);
+
+  printf("arm_sin_f32 / arm_cos_f32 max error %.2e\n", max_error);
+  return check_report("arm_sin_f32 / arm_cos_f32", 2000002u, mismatches);
+}
+
+int main(void)
+{
+  uint32_t failed = 0;
+
+  failed += check_fir_q15();
+  failed += check_biquad_cascade_df1_q15();
+  failed += check_float_to_q15();
+  failed += check_sin_f32();
+
+  return (int)failed;
+}
+
+#endif
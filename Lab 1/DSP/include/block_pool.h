@@ -0,0 +1,35 @@
+#ifndef BLOCK_POOL_H
+
+  #define BLOCK_POOL_H
+
+  // Pool of fixed-size buffers on top of an RTX memory pool, for
+  // handing data between tasks by pointer through mailboxes: the sender
+  // allocates and fills a block and posts it, the receiver owns it from
+  // then on and frees it (or passes it on). Nothing is copied.
+  //
+  // Declare the storage with BLOCK_POOL_DECLARE (needs RTL.h) and pass
+  // it with its sizeof to block_pool_init. Task context only.
+  #define BLOCK_POOL_DECLARE(name, block_size, blocks) _declare_box(name, block_size, blocks)
+
+  // occupancy counters, meant to be polled (Watch window) for sizing
+  typedef struct
+  {
+    uint32_t blocks;          // capacity
+    uint32_t in_use;          // currently allocated
+    uint32_t high_water;      // largest in_use since init
+    uint32_t allocations;
+    uint32_t failures;        // allocations refused, pool empty
+  } block_pool_stats_t;
+
+  typedef struct
+  {
+    void *box;
+    uint32_t block_size;      // bytes
+    block_pool_stats_t stats;
+  } block_pool_t;
+
+  void block_pool_init(block_pool_t *pool_desc, void *box, uint32_t box_size, uint32_t block_size);
+  void *block_pool_alloc(block_pool_t *pool_desc);
+  void block_pool_free(block_pool_t *pool_desc, void *block);
+
+#endif
@@ -0,0 +1,61 @@
+#ifndef CYCLE_COUNTER_H
+
+  #define CYCLE_COUNTER_H
+
+  // Cycle counting for the benchmarks.
+  // On the target the DWT cycle counter of the Cortex-M4 is used; a host
+  // build (DSP_HOST_BUILD) falls back to a monotonic nanosecond clock.
+
+  #ifdef DSP_HOST_BUILD
+
+    #include <time.h>
+
+    #define CYCLE_COUNTER_UNIT "ns"
+
+    static __inline void cycle_counter_init(void)
+    {
+    }
+
+    static __inline void cycle_counter_enable(void)
+    {
+    }
+
+    static __inline uint32_t cycle_counter_read(void)
+    {
+      struct timespec now;
+
+      clock_gettime(CLOCK_MONOTONIC, &now);
+      return (uint32_t)((uint64_t)now.tv_sec * 1000000000u + (uint64_t)now.tv_nsec);
+    }
+
+  #else
+
+    #define CYCLE_COUNTER_UNIT "cycles"
+
+    #define CYCLE_COUNTER_DEMCR  (*(volatile uint32_t *)0xE000EDFCu)
+    #define CYCLE_COUNTER_CTRL   (*(volatile uint32_t *)0xE0001000u)
+    #define CYCLE_COUNTER_CYCCNT (*(volatile uint32_t *)0xE0001004u)
+
+    static __inline void cycle_counter_init(void)
+    {
+      CYCLE_COUNTER_DEMCR |= (1u << 24);   // TRCENA: enable DWT and ITM
+      CYCLE_COUNTER_CYCCNT = 0;
+      CYCLE_COUNTER_CTRL |= 1u;            // CYCCNTENA
+    }
+
+    // Starts the counter without clearing it, for modules that only
+    // take differences and share it with other users (trace, profiler).
+    static __inline void cycle_counter_enable(void)
+    {
+      CYCLE_COUNTER_DEMCR |= (1u << 24);
+      CYCLE_COUNTER_CTRL |= 1u;
+    }
+
+    static __inline uint32_t cycle_counter_read(void)
+    {
+      return CYCLE_COUNTER_CYCCNT;
+    }
+
+  #endif
+
+#endif
@@ -0,0 +1,45 @@
+#ifndef DAC_OUTPUT_H
+
+  #define DAC_OUTPUT_H
+
+  #define DAC_OUTPUT_MIN_HALF (4u)
+
+  typedef struct
+  {
+    uint32_t halves;                // half buffers handed to the DMA
+    uint32_t underruns;             // halves that could not be filled from the ring
+    uint32_t missing;               // samples replaced by the last value in those halves
+    uint32_t min_fill;              // lowest ring fill seen at a refill, in samples
+  } dac_output_stats_t;
+
+  // Streams q15 samples to DAC channel 1 (PA4). TIM6 triggers a
+  // conversion at the sampling frequency and DMA1 stream 5 feeds the
+  // DAC from a circular buffer of two halves of half_len samples; the
+  // half and full transfer interrupts refill the half just played
+  // from the ring the producer writes into.
+  typedef struct
+  {
+    uint32_t sampling_frequency;
+    uint32_t half_len;
+    uint16_t *dma_buffer;           // 2 * half_len DAC codes, 12 bit left aligned
+    spsc_ring_q15_t ring;           // producer -> refill interrupt
+    uint16_t hold;                  // last code sent, repeated on underrun
+    volatile uint32_t running;      // timer started, refills are interrupt driven
+    dac_output_stats_t stats;
+  } dac_output_t;
+
+  // ring_buffer: ring_size samples (power of two, at least 3 * half_len
+  // plus the largest block written); the DAC starts once the ring holds
+  // three halves. half_len should be at least the samples the producer
+  // delivers at once plus its worst delay in samples.
+  arm_status dac_output_init(dac_output_t *dac_desc, uint32_t sampling_frequency, uint32_t half_len,
+                             uint16_t *dma_buffer, q15_t *ring_buffer, uint32_t ring_size);
+
+  // producer side; returns the number of samples accepted (0 if the
+  // ring is full, counted in ring.overflows)
+  uint32_t dac_output_write(dac_output_t *dac_desc, q15_t *samples, uint32_t len);
+
+  // interrupt side: refills half 0 or 1 of the DMA buffer
+  void dac_output_refill(dac_output_t *dac_desc, uint32_t half);
+
+#endif
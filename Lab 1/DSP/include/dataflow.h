@@ -0,0 +1,90 @@
+#ifndef DATAFLOW_H
+
+  #define DATAFLOW_H
+
+  #define DATAFLOW_MAX_STAGES (12u)
+  #define DATAFLOW_MAX_EDGES  (16u)
+  #define DATAFLOW_MAX_PORTS  (3u)
+  #define DATAFLOW_MAX_TASKS  (4u)
+
+  // Scratch per task group, in samples, for blocks of up to max_block
+  // samples: one block for every input and output port.
+  #define DATAFLOW_SCRATCH_LEN(max_block) (2u * DATAFLOW_MAX_PORTS * (max_block))
+
+  struct dataflow_stage_s;
+
+  // Called once per firing with in_len samples on every input and room
+  // for out_len samples on every output.
+  typedef void (*dataflow_fire_t)(const struct dataflow_stage_s *stage, q15_t *const *input, q15_t *const *output);
+
+  // A stage of the graph, usually one line of a const table. A stage
+  // without inputs is a source: it fires for every out_len samples
+  // released with dataflow_release. out_len / in_len is the rate
+  // change (e.g. 1 / 4 for a decimator by 4).
+  typedef struct dataflow_stage_s
+  {
+    const char *name;
+    dataflow_fire_t fire;
+    void *context;
+    uint8_t num_inputs;
+    uint8_t num_outputs;
+    uint16_t in_len;          // samples taken from every input per firing
+    uint16_t out_len;         // samples put on every output per firing
+    uint8_t task;             // task group that runs the stage
+  } dataflow_stage_t;
+
+  // A connection from an output port to an input port, buffered in a
+  // lock-free ring of size samples (a power of two, at least the
+  // producer out_len plus the consumer in_len). An output may feed
+  // several edges; an input takes exactly one.
+  typedef struct
+  {
+    uint8_t from_stage;
+    uint8_t from_port;
+    uint8_t to_stage;
+    uint8_t to_port;
+    q15_t *buffer;
+    uint32_t size;
+  } dataflow_edge_t;
+
+  typedef struct
+  {
+    uint32_t firings;
+    uint32_t cycles;          // last firing, in CYCLE_COUNTER_UNIT
+    uint32_t max_cycles;
+    uint64_t total_cycles;
+  } dataflow_stage_stats_t;
+
+  typedef struct
+  {
+    const dataflow_stage_t *stage;
+    const dataflow_edge_t *edge;
+    uint32_t num_stages;
+    uint32_t num_edges;
+    uint32_t num_tasks;
+    q15_t *scratch;
+    uint32_t max_block;
+    void (*notify)(uint32_t task);                          // wake the task running a group, may be NULL
+    volatile uint32_t released;                             // samples released to the sources
+    volatile uint32_t consumed[DATAFLOW_MAX_STAGES];        // samples produced by each source
+    uint8_t input_edge[DATAFLOW_MAX_STAGES][DATAFLOW_MAX_PORTS];
+    spsc_ring_q15_t ring[DATAFLOW_MAX_EDGES];
+    dataflow_stage_stats_t stats[DATAFLOW_MAX_STAGES];
+  } dataflow_graph_t;
+
+  // scratch: num_tasks * DATAFLOW_SCRATCH_LEN(max_block) samples
+  arm_status dataflow_init(dataflow_graph_t *graph, const dataflow_stage_t *stages, uint32_t num_stages,
+                           const dataflow_edge_t *edges, uint32_t num_edges, q15_t *scratch, uint32_t max_block,
+                           void (*notify)(uint32_t task));
+
+  // lets every source produce samples more samples (e.g. one tick worth)
+  void dataflow_release(dataflow_graph_t *graph, uint32_t samples);
+
+  // fires the ready stages of one task group until none is ready;
+  // returns the number of firings
+  uint32_t dataflow_run(dataflow_graph_t *graph, uint32_t task);
+
+  // per-stage firings and cycles on the console
+  void dataflow_report(const dataflow_graph_t *graph);
+
+#endif
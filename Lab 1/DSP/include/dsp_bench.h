@@ -0,0 +1,16 @@
+#ifndef DSP_BENCH_H
+
+  #define DSP_BENCH_H
+
+  void dsp_bench_fir_block(void);
+  void dsp_bench_filter_kinds(void);
+  void dsp_bench_multirate(void);
+  void dsp_bench_fft_filter(void);
+  void dsp_bench_noise_canceller(void);
+  void dsp_bench_tone_monitor(void);
+  void dsp_bench_sine_generators(void);
+  void dsp_bench_tone_bank(void);
+  void dsp_bench_precision(void);
+  void dsp_bench_run(void);
+
+#endif
@@ -0,0 +1,50 @@
+#ifndef DSP_KERNELS_H
+
+  #define DSP_KERNELS_H
+
+  // peak of the oscillator output; the q31 biquad does not saturate,
+  // so a full scale oscillator would wrap around on rounding growth
+  #define KERNEL_OSCILLATOR_AMPLITUDE (0.9f)
+
+  // state buffer length (in samples of the kernel type) of a FIR
+  #define KERNEL_FIR_STATE_LEN(num_taps, block_len) ((num_taps) + (block_len) - 1u)
+
+  // Oscillator and FIR kernels with the same API in every precision:
+  // kernel_<name>_q15, kernel_<name>_q31 and kernel_<name>_f32.
+  // Taps are given in float (CMSIS order) and converted at init;
+  // kernel_from_float / kernel_to_float convert sample buffers.
+  // kernel_oscillator_pole gives the pole angle and amplitude the
+  // quantized oscillator really runs at; call it right after init.
+  #define DSP_KERNELS_DECLARE(type_t, sfx)                                                                      \
+    typedef struct                                                                                              \
+    {                                                                                                           \
+      arm_biquad_casd_df1_inst_##sfx biquad_instance;                                                           \
+      type_t coeff[6];                                                                                          \
+      type_t state[4];                                                                                          \
+    } kernel_oscillator_##sfx##_t;                                                                              \
+                                                                                                                \
+    typedef struct                                                                                              \
+    {                                                                                                           \
+      arm_fir_instance_##sfx fir_instance;                                                                      \
+      uint32_t block_len;                                                                                       \
+    } kernel_fir_##sfx##_t;                                                                                     \
+                                                                                                                \
+    void kernel_from_float_##sfx(float32_t *input, type_t *output, uint32_t len);                               \
+    void kernel_to_float_##sfx(type_t *input, float32_t *output, uint32_t len);                                 \
+                                                                                                                \
+    void kernel_oscillator_init_##sfx(kernel_oscillator_##sfx##_t *oscillator_desc, uint32_t sine_frequency,    \
+                                      uint32_t sampling_frequency);                                             \
+    void kernel_oscillator_block_##sfx(kernel_oscillator_##sfx##_t *oscillator_desc, type_t *output,            \
+                                       uint32_t block_len);                                                     \
+    void kernel_oscillator_pole_##sfx(const kernel_oscillator_##sfx##_t *oscillator_desc, float64_t *w,         \
+                                      float64_t *amplitude);                                                    \
+                                                                                                                \
+    void kernel_fir_init_##sfx(kernel_fir_##sfx##_t *fir_desc, const float32_t *taps, uint32_t num_taps,        \
+                               type_t *coeff, type_t *state, uint32_t block_len);                               \
+    void kernel_fir_block_##sfx(kernel_fir_##sfx##_t *fir_desc, type_t *input, type_t *output);
+
+  DSP_KERNELS_DECLARE(q15_t, q15)
+  DSP_KERNELS_DECLARE(q31_t, q31)
+  DSP_KERNELS_DECLARE(float32_t, f32)
+
+#endif
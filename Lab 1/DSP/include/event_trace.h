@@ -0,0 +1,72 @@
+#ifndef EVENT_TRACE_H
+
+  #define EVENT_TRACE_H
+
+  // kind of an event, in the top two bits of the id
+  #define EVENT_TRACE_INSTANT (0x0000u)
+  #define EVENT_TRACE_BEGIN   (0x4000u)   // starts a span, ended by the same id with EVENT_TRACE_END
+  #define EVENT_TRACE_END     (0x8000u)
+  #define EVENT_TRACE_COUNTER (0xC000u)   // arg is a value to plot
+  #define EVENT_TRACE_KIND    (0xC000u)
+  #define EVENT_TRACE_ID      (0x3FFFu)
+
+  // ITM stimulus port of the dump; port 0 is the printf console
+  #define EVENT_TRACE_ITM_PORT (1u)
+
+  typedef struct
+  {
+    uint32_t cycles;                // cycle counter when written
+    uint16_t id;                    // event number | kind
+    uint16_t arg;
+  } event_trace_record_t;
+
+  // Ring of 8 byte records written by any task or interrupt. A writer
+  // claims a slot by an atomic increment of head and fills it; once
+  // the ring is full the oldest records are overwritten. The records
+  // of writers that interrupted each other may be slightly out of
+  // time order. Needs cycle_counter.h.
+  typedef struct
+  {
+    event_trace_record_t *buffer;
+    uint32_t mask;
+    volatile uint32_t head;         // records written since init
+    volatile uint32_t enabled;
+  } event_trace_t;
+
+  #if defined(__CC_ARM)
+    #define EVENT_TRACE_CLAIM(head, index) \
+      do { (index) = __ldrex(head); } while (__strex((index) + 1u, (head)))
+  #else
+    #define EVENT_TRACE_CLAIM(head, index) \
+      ((index) = __atomic_fetch_add((head), 1u, __ATOMIC_RELAXED))
+  #endif
+
+  static __inline void event_trace_write(event_trace_t *trace, uint32_t id, uint32_t arg)
+  {
+    event_trace_record_t *record;
+    uint32_t index;
+
+    if (trace->enabled)
+    {
+      EVENT_TRACE_CLAIM(&trace->head, index);
+      record = &trace->buffer[index & trace->mask];
+      record->cycles = cycle_counter_read();
+      record->id = (uint16_t)id;
+      record->arg = (uint16_t)arg;
+    }
+  }
+
+  // size: records, a power of two; starts enabled
+  void event_trace_init(event_trace_t *trace, event_trace_record_t *buffer, uint32_t size);
+  void event_trace_stop(event_trace_t *trace);
+  void event_trace_start(event_trace_t *trace);
+
+  // Sends the records still in the ring, oldest first, to an ITM
+  // stimulus port, with the counter rate and the event names
+  // (names[n] for event number n, NULL entries skipped). Stop the
+  // trace first. Returns the number of records sent, 0 if the port
+  // is not enabled by the debugger.
+  uint32_t event_trace_dump_itm(const event_trace_t *trace, uint32_t port, uint32_t cycles_per_sec,
+                                const char *const *names, uint32_t num_names);
+
+#endif
@@ -0,0 +1,39 @@
+#ifndef FFT_FILTER_H
+
+  #define FFT_FILTER_H
+
+  #define FFT_FILTER_MIN_TAPS (64u)
+  #define FFT_FILTER_MAX_TAPS (1024u)
+
+  // real FFT length used for a tap count (the radix-4 real transforms
+  // of CMSIS-DSP exist for 128, 512 and 2048 points); every call
+  // processes half an FFT, so up to block_len + 1 taps fit
+  #define FFT_FILTER_FFT_LEN(num_taps)   (((num_taps) <= 65u) ? 128u : (((num_taps) <= 257u) ? 512u : 2048u))
+  #define FFT_FILTER_BLOCK_LEN(num_taps) (FFT_FILTER_FFT_LEN(num_taps) / 2u)
+
+  // work buffer size (q31 words) the caller provides for a tap count:
+  // filter spectrum (fft_len + 2), input spectrum (2 * fft_len),
+  // time buffer (fft_len) and saved input (fft_len / 2)
+  #define FFT_FILTER_WORK_LEN(num_taps)  ((9u * FFT_FILTER_FFT_LEN(num_taps)) / 2u + 2u)
+
+  typedef struct
+  {
+    arm_rfft_instance_q31 rfft_instance;
+    arm_rfft_instance_q31 rifft_instance;
+    arm_cfft_radix4_instance_q31 cfft_instance;
+    arm_cfft_radix4_instance_q31 cifft_instance;
+    uint32_t num_taps;
+    uint32_t fft_len;
+    uint32_t block_len;        // samples per call
+    uint32_t spectrum_shift;   // product shift, keeps the spectrum in q31
+    uint32_t output_shift;     // inverse transform result -> q15
+    q31_t *response;           // bins 0 .. fft_len / 2 of the taps, re/im interleaved
+    q31_t *spectrum;
+    q31_t *time;
+    q31_t *overlap;            // last fft_len / 2 input samples
+  } fft_filter_q15_t;
+
+  arm_status fft_filter_init_q15(fft_filter_q15_t *fft_filter_desc, uint32_t num_taps, const q15_t *coeff, q31_t *work);
+  void fft_filter_q15(fft_filter_q15_t *fft_filter_desc, q15_t *input, q15_t *output);
+
+#endif
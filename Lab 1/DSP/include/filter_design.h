@@ -0,0 +1,47 @@
+#ifndef FILTER_DESIGN_H
+
+  #define FILTER_DESIGN_H
+
+  #define FILTER_DESIGN_MAX_TAPS (1024u)
+
+  typedef enum
+  {
+    FILTER_DESIGN_LOW_PASS = 0,
+    FILTER_DESIGN_BAND_STOP
+  } filter_design_type_t;
+
+  typedef enum
+  {
+    FILTER_DESIGN_HAMMING = 0,
+    FILTER_DESIGN_KAISER
+  } filter_design_window_t;
+
+  // Band edges are normalized to the sampling frequency (0 .. 0.5).
+  // Low pass:  pass up to pass_edge, stop from stop_edge.
+  // Band stop: pass up to pass_edge, stop from stop_edge to stop_edge_high,
+  //            pass again from pass_edge_high.
+  // A kaiser_beta of zero or less is derived from the transition width.
+  // gain is the DC gain of the taps (zero means 1.0); an interpolator by
+  // L needs a gain of L.
+  typedef struct
+  {
+    filter_design_type_t type;
+    filter_design_window_t window;
+    uint32_t num_taps;
+    float32_t pass_edge;
+    float32_t stop_edge;
+    float32_t stop_edge_high;
+    float32_t pass_edge_high;
+    float32_t kaiser_beta;
+    float32_t gain;
+  } filter_design_spec_t;
+
+  arm_status filter_design_fir_f32(const filter_design_spec_t *spec, float32_t *taps);
+  arm_status filter_design_fir_q15(const filter_design_spec_t *spec, q15_t *taps);
+
+  float32_t filter_design_attenuation_db(const filter_design_spec_t *spec);
+  float32_t filter_design_response_db(const q15_t *taps, uint32_t num_taps, float32_t frequency);
+  arm_status filter_design_check_q15(const filter_design_spec_t *spec, const q15_t *taps,
+                                     float32_t ripple_db, float32_t attenuation_db);
+
+#endif
@@ -1,8 +1,55 @@
 #ifndef LOW_PASS_FILTER_H
 
   #define LOW_PASS_FILTER_H
-	
-  void low_pass_filter_init(void);
+
+  #define LOW_PASS_FILTER_TAPS          (32u)
+  #define LOW_PASS_FILTER_BIQUAD_STAGES (2u)
+  #define LOW_PASS_FILTER_MAX_BLOCK     (256u)
+
+  // Size in q31_t words of the state buffer the caller provides for a
+  // given block length. Covers every filter kind: the q15 FIR needs
+  // TAPS + block_len - 1 samples, the q31 biquad 4 words per stage plus
+  // a block_len work area.
+  #define LOW_PASS_FILTER_STATE_LEN(block_len) (LOW_PASS_FILTER_TAPS / 2u + (block_len))
+
+  typedef enum
+  {
+    LOW_PASS_FILTER_FIR_Q15 = 0,    // 32-tap FIR
+    LOW_PASS_FILTER_BIQUAD_Q15,     // 4th-order biquad cascade, q15 state; bench only, misses the spec
+    LOW_PASS_FILTER_BIQUAD_Q31      // same cascade, q31 coefficients and state
+  } low_pass_filter_kind_t;
+
+  typedef struct
+  {
+    low_pass_filter_kind_t kind;
+    uint32_t block_len;
+    arm_fir_instance_q15 fir_instance;
+    arm_biquad_casd_df1_inst_q15 biquad_q15_instance;
+    arm_biquad_casd_df1_inst_q31 biquad_q31_instance;
+    q31_t *work;
+  } low_pass_filter_q15_t;
+
+  // Ping-pong buffering: samples are collected in one input half while
+  // the output half of the previous block is played out.
+  typedef struct
+  {
+    low_pass_filter_q15_t *filter;
+    q15_t *input[2];
+    q15_t *output[2];
+    uint32_t fill;
+    uint32_t active;
+  } low_pass_filter_pingpong_q15_t;
+
+  void low_pass_filter_init(low_pass_filter_kind_t kind);
   q15_t low_pass_filter(q15_t *input);
+  uint32_t low_pass_filter_macs(low_pass_filter_kind_t kind);
+  arm_status low_pass_filter_design(uint32_t pass_frequency, uint32_t stop_frequency, uint32_t sampling_frequency);
+
+  void low_pass_filter_block_init(low_pass_filter_q15_t *filter_desc, low_pass_filter_kind_t kind, q31_t *state, uint32_t block_len);
+  void low_pass_filter_block(low_pass_filter_q15_t *filter_desc, q15_t *input, q15_t *output);
+
+  void low_pass_filter_pingpong_init(low_pass_filter_pingpong_q15_t *pingpong_desc, low_pass_filter_q15_t *filter_desc,
+                                     q15_t *input_buffer, q15_t *output_buffer);
+  q15_t low_pass_filter_pingpong(low_pass_filter_pingpong_q15_t *pingpong_desc, q15_t sample);
 
 #endif
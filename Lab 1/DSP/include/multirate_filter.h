@@ -0,0 +1,38 @@
+#ifndef MULTIRATE_FILTER_H
+
+  #define MULTIRATE_FILTER_H
+
+  #define MULTIRATE_TAPS_PER_PHASE (8u)
+  #define MULTIRATE_MAX_FACTOR     (16u)
+
+  // buffer sizes (q15 samples) the caller provides for a factor and
+  // a block length (input samples per call)
+  #define MULTIRATE_COEFF_LEN(factor)                  ((factor) * MULTIRATE_TAPS_PER_PHASE)
+  #define MULTIRATE_DECIMATOR_STATE_LEN(factor, block_len)    (MULTIRATE_COEFF_LEN(factor) + (block_len) - 1u)
+  #define MULTIRATE_INTERPOLATOR_STATE_LEN(factor, block_len) (MULTIRATE_TAPS_PER_PHASE + (block_len) - 1u)
+
+  typedef struct
+  {
+    arm_fir_decimate_instance_q15 decimate_instance;
+    uint32_t factor;
+    uint32_t block_len;   // input samples per call, a multiple of factor
+  } multirate_decimator_q15_t;
+
+  typedef struct
+  {
+    arm_fir_interpolate_instance_q15 interpolate_instance;
+    uint32_t factor;
+    uint32_t block_len;   // input samples per call
+  } multirate_interpolator_q15_t;
+
+  arm_status multirate_decimator_init_q15(multirate_decimator_q15_t *decimator_desc, uint32_t factor,
+                                          q15_t *coeff, q15_t *state, uint32_t block_len);
+  void multirate_decimate_q15(multirate_decimator_q15_t *decimator_desc, q15_t *input, q15_t *output);
+
+  arm_status multirate_interpolator_init_q15(multirate_interpolator_q15_t *interpolator_desc, uint32_t factor,
+                                             q15_t *coeff, q15_t *state, uint32_t block_len);
+  void multirate_interpolate_q15(multirate_interpolator_q15_t *interpolator_desc, q15_t *input, q15_t *output);
+
+  uint32_t multirate_macs_per_input(uint32_t factor);
+
+#endif
@@ -0,0 +1,45 @@
+#ifndef NOISE_CANCELLER_H
+
+  #define NOISE_CANCELLER_H
+
+  #define NOISE_CANCELLER_MAX_TAPS   (64u)
+  #define NOISE_CANCELLER_AVERAGE    (256u)    // samples, time constant of the power estimates
+  #define NOISE_CANCELLER_TARGET_DB  (20.0f)   // residual this far below the reference counts as converged
+
+  // Size in q31_t words of the work buffer the caller provides: filter
+  // state (num_taps + block_len - 1) and four block_len scratch areas
+  // for the q31 conversion. The q15 kind uses less.
+  #define NOISE_CANCELLER_WORK_LEN(num_taps, block_len) ((num_taps) + 5u * (block_len) - 1u)
+
+  typedef enum
+  {
+    NOISE_CANCELLER_Q15 = 0,
+    NOISE_CANCELLER_Q31
+  } noise_canceller_kind_t;
+
+  typedef struct
+  {
+    uint32_t samples;              // processed since init
+    uint32_t converged_at;         // samples when the residual first reached the target, 0 while converging
+    float32_t reference_power;     // mean square of the noise reference
+    float32_t residual_power;      // mean square of the noise left in the output
+  } noise_canceller_stats_t;
+
+  typedef struct
+  {
+    noise_canceller_kind_t kind;
+    uint32_t block_len;
+    arm_lms_norm_instance_q15 lms_q15_instance;
+    arm_lms_norm_instance_q31 lms_q31_instance;
+    q31_t coeff[NOISE_CANCELLER_MAX_TAPS];
+    q31_t *scratch;
+    noise_canceller_stats_t stats;
+  } noise_canceller_q15_t;
+
+  arm_status noise_canceller_init(noise_canceller_q15_t *canceller_desc, noise_canceller_kind_t kind, uint32_t num_taps,
+                                  float32_t step_size, q31_t *work, uint32_t block_len);
+  void noise_canceller_block(noise_canceller_q15_t *canceller_desc, q15_t *primary, q15_t *reference,
+                             q15_t *output, const q15_t *wanted);
+  float32_t noise_canceller_rejection_db(const noise_canceller_stats_t *stats);
+
+#endif
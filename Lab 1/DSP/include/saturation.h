@@ -0,0 +1,33 @@
+#ifndef SATURATION_H
+
+  #define SATURATION_H
+
+  // Per-stage counters, updated by the primitives below and meant to
+  // be polled (Watch window or printf). headroom_bits is the number
+  // of unused bits above the peak magnitude: 0 means the stage has
+  // reached full scale.
+  typedef struct
+  {
+    uint32_t samples;
+    uint32_t clips;          // results that saturated (or sit on a rail)
+    uint32_t peak;           // largest magnitude seen
+    uint32_t headroom_bits;
+  } saturation_stats_t;
+
+  void saturation_stats_reset(saturation_stats_t *stats);
+
+  // a + b, saturated to q15
+  q15_t saturation_add_q15(saturation_stats_t *stats, q15_t a, q15_t b);
+  void saturation_add_block_q15(saturation_stats_t *stats, const q15_t *a, const q15_t *b, q15_t *output, uint32_t len);
+
+  // (x * scale_fract) >> (15 - shift), saturated to q15, the gain is
+  // scale_fract * 2^shift like arm_scale_q15
+  q15_t saturation_scale_q15(saturation_stats_t *stats, q15_t x, q15_t scale_fract, int8_t shift);
+  void saturation_scale_block_q15(saturation_stats_t *stats, const q15_t *input, q15_t scale_fract, int8_t shift,
+                                  q15_t *output, uint32_t len);
+
+  // peak and rail hits of a stream produced elsewhere (e.g. a CMSIS
+  // filter, which saturates internally)
+  void saturation_track_block_q15(saturation_stats_t *stats, const q15_t *input, uint32_t len);
+
+#endif
@@ -0,0 +1,77 @@
+#ifndef SIGNAL_CHAIN_H
+
+  #define SIGNAL_CHAIN_H
+
+  // outputs of the chain, index into signal_chain_q15_t.stats
+  #define SIGNAL_CHAIN_SINE      0
+  #define SIGNAL_CHAIN_NOISE     1
+  #define SIGNAL_CHAIN_DISTURBED 2
+  #define SIGNAL_CHAIN_FILTERED  3
+  #define SIGNAL_CHAIN_STREAMS   4
+
+  // stage gains as arm_scale_q15 style fraction and shift (up to x4),
+  // gain in 1/1000
+  #define SIGNAL_CHAIN_GAIN_SHIFT       2
+  #define SIGNAL_CHAIN_GAIN_SCALE(gain) ((q15_t)((gain) * 8192u / 1000u))
+
+  // The DirtyFilter.c configuration options, in the same units. All
+  // fields are 32 bit so the struct can be stored as is (see the
+  // golden vector format in signal_chain.c).
+  typedef struct
+  {
+    uint32_t sampling_frequency;   // Hz
+    uint32_t signal_frequency;     // Hz
+    uint32_t noise_frequency;      // Hz
+    uint32_t signal_gain;          // 1/1000
+    uint32_t noise_gain;           // 1/1000
+    uint32_t generator_mode;       // 0: IIR oscillator, 1: NCO
+    uint32_t filter_kind;          // low_pass_filter_kind_t
+    uint32_t noise_canceller;      // 0: low pass filter, 1: NLMS q15, 2: NLMS q31
+    uint32_t canceller_taps;
+    uint32_t canceller_step;       // 1/10000
+    uint32_t block_len;            // samples, up to LOW_PASS_FILTER_MAX_BLOCK
+  } signal_chain_config_t;
+
+  typedef struct
+  {
+    signal_chain_config_t config;
+    q15_t signal_scale;
+    q15_t noise_scale;
+    sine_generator_q15_t signal_iir;
+    sine_generator_q15_t noise_iir;
+    sine_generator_nco_q15_t signal_nco;
+    sine_generator_nco_q15_t noise_nco;
+    low_pass_filter_q15_t filter;
+    noise_canceller_q15_t canceller;
+    q31_t filter_state[LOW_PASS_FILTER_STATE_LEN(LOW_PASS_FILTER_MAX_BLOCK)];
+    q31_t canceller_work[NOISE_CANCELLER_WORK_LEN(NOISE_CANCELLER_MAX_TAPS, LOW_PASS_FILTER_MAX_BLOCK)];
+    saturation_stats_t stats[SIGNAL_CHAIN_STREAMS];
+  } signal_chain_q15_t;
+
+  // the configuration DirtyFilter.c ships with
+  void signal_chain_default_config(signal_chain_config_t *config);
+
+  arm_status signal_chain_init(signal_chain_q15_t *chain_desc, const signal_chain_config_t *config);
+
+  // Stages of the chain, shared with the DirtyFilter.c tasks so that the
+  // golden vectors check the code the target runs. Gain: scales a
+  // generator output with saturation (scale_fract from
+  // SIGNAL_CHAIN_GAIN_SCALE). Mix: saturating sum of signal and noise.
+  // Filter: the low pass filter, or the canceller if one is given
+  // (noise as reference, sine for its residual metric); the filtered
+  // stream is tracked in stats. len must match the block length the
+  // filter or canceller was initialized with.
+  q15_t signal_chain_gain_q15(saturation_stats_t *stats, q15_t sample, q15_t scale_fract);
+  void signal_chain_gain_block_q15(saturation_stats_t *stats, q15_t *block, q15_t scale_fract, uint32_t len);
+  q15_t signal_chain_mix_q15(saturation_stats_t *stats, q15_t sine, q15_t noise);
+  void signal_chain_mix_block_q15(saturation_stats_t *stats, const q15_t *sine, const q15_t *noise, q15_t *disturbed,
+                                  uint32_t len);
+  void signal_chain_filter_block_q15(low_pass_filter_q15_t *filter, noise_canceller_q15_t *canceller,
+                                     saturation_stats_t *stats, q15_t *disturbed, q15_t *noise, q15_t *sine,
+                                     q15_t *filtered, uint32_t len);
+
+  // one block of config.block_len samples of every stream
+  void signal_chain_block(signal_chain_q15_t *chain_desc, q15_t *sine, q15_t *noise, q15_t *disturbed,
+                          q15_t *filtered);
+
+#endif
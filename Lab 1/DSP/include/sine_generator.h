@@ -7,9 +7,27 @@
 	  arm_biquad_casd_df1_inst_q15 iir_sine_generator_instance;
 	  q15_t coeff[6];
 	  q15_t state[4];
+	  uint32_t renorm_period;   // samples between state corrections, 0: off
+	  uint32_t renorm_count;    // samples left until the next one
+	  uint32_t phase;           // reference phase of the last output, 2^32 = one period
+	  uint32_t phase_inc;       // pole angle of the coefficients as phase step
 	} sine_generator_q15_t;
 	
-  void sine_generator_init_q15(sine_generator_q15_t *sine_desc, q15_t sine_frequency, q15_t sampling_frequency);
+	typedef struct
+	{
+	  uint32_t phase;       // phase accumulator, 2^32 = one period
+	  uint32_t phase_inc;   // phase step per sample
+	} sine_generator_nco_q15_t;
+	
+  void sine_generator_init_q15(sine_generator_q15_t *sine_desc, uint32_t sine_frequency, uint32_t sampling_frequency);
   q15_t sine_calc_sample_q15(sine_generator_q15_t *sine_desc);
+  void sine_calc_block_q15(sine_generator_q15_t *sine_desc, q15_t *output, uint32_t block_len);
+
+  // correct amplitude and phase every period samples (0: never, the default)
+  void sine_generator_renorm_q15(sine_generator_q15_t *sine_desc, uint32_t period);
+
+  void sine_generator_nco_init_q15(sine_generator_nco_q15_t *nco_desc, uint32_t sine_frequency, uint32_t sampling_frequency);
+  q15_t sine_nco_calc_sample_q15(sine_generator_nco_q15_t *nco_desc);
+  void sine_nco_calc_block_q15(sine_generator_nco_q15_t *nco_desc, q15_t *output, uint32_t block_len);
 
 #endif
@@ -0,0 +1,60 @@
+#ifndef SPECTRUM_ANALYZER_H
+
+  #define SPECTRUM_ANALYZER_H
+
+  #define SPECTRUM_MAX_LEN    (1024u)
+  #define SPECTRUM_MAX_BINS   (SPECTRUM_MAX_LEN / 2u)
+
+  // level[] unit: 0.5 dB below a full scale sine, 0 .. 255 (-127.5 dB)
+  #define SPECTRUM_LEVEL_STEPS_PER_DB (2u)
+
+  // work buffer size (q15 samples) the caller provides for an FFT
+  // length: history and frame of both streams (4 * fft_len), FFT
+  // buffer (3 * fft_len) and window (fft_len)
+  #define SPECTRUM_WORK_LEN(fft_len) (8u * (fft_len))
+
+  typedef struct
+  {
+    uint32_t frames;                // spectra computed
+    uint32_t dropped;               // frames skipped, the previous one was still being analyzed or drawn
+    uint32_t fft_cycles;            // last frame: window, FFT and levels, in CYCLE_COUNTER_UNIT
+    uint32_t draw_cycles;           // last frame: display, set by the caller
+    uint32_t frames_per_sec;        // achieved frame rate, set by the caller once per second
+  } spectrum_stats_t;
+
+  // Two streams (0: disturbed, 1: filtered) analyzed together. The
+  // caller feeds both from the filter task; every hop samples the last
+  // fft_len samples are taken as a frame, unless the previous frame is
+  // still busy, and analyzed later in a lower priority task.
+  typedef struct
+  {
+    uint32_t fft_len;               // 256, 512 or 1024
+    uint32_t hop;                   // samples between frames: update rate = sampling frequency / hop
+    uint32_t count;                 // samples since the last frame
+    uint32_t write;                 // next history index
+    q15_t *history[2];              // last fft_len samples of each stream, circular
+    q15_t *frame[2];                // frame taken for the analyzer
+    q15_t *fft;
+    q15_t *window;                  // Hann
+    arm_cfft_radix4_instance_q15 cfft_instance;
+    arm_rfft_instance_q15 rfft_instance;
+    volatile uint32_t busy;         // frame taken and not yet released
+    uint16_t peak_bin[2];           // strongest bin of the last spectrum
+    uint8_t level[2][SPECTRUM_MAX_BINS];
+    spectrum_stats_t stats;
+  } spectrum_analyzer_q15_t;
+
+  arm_status spectrum_analyzer_init_q15(spectrum_analyzer_q15_t *spectrum_desc, uint32_t fft_len, uint32_t hop,
+                                        q15_t *work);
+
+  // filter task side: returns 1 when a frame was taken, i.e. the
+  // analyzer task has to be woken
+  uint32_t spectrum_analyzer_block_q15(spectrum_analyzer_q15_t *spectrum_desc, const q15_t *disturbed,
+                                       const q15_t *filtered, uint32_t len);
+
+  // analyzer task side: computes level[] of the frame taken; level[]
+  // stays valid until spectrum_analyzer_release
+  void spectrum_analyzer_process_q15(spectrum_analyzer_q15_t *spectrum_desc);
+  void spectrum_analyzer_release(spectrum_analyzer_q15_t *spectrum_desc);
+
+#endif
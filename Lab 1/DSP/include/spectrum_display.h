@@ -0,0 +1,30 @@
+#ifndef SPECTRUM_DISPLAY_H
+
+  #define SPECTRUM_DISPLAY_H
+
+  // levels shown, 0 dB at the top of the plot
+  #define SPECTRUM_DISPLAY_RANGE_DB (80u)
+
+  typedef enum
+  {
+    SPECTRUM_DISPLAY_BARS = 0,      // one bar per column, redrawn in place, no flicker
+    SPECTRUM_DISPLAY_LINES          // two polylines, the plot is cleared every frame
+  } spectrum_display_style_t;
+
+  typedef struct
+  {
+    spectrum_display_style_t style;
+    uint32_t sampling_frequency;
+    uint16_t width;
+    uint16_t plot_top;
+    uint16_t plot_height;
+    uint16_t text_top;              // status lines below the plot
+  } spectrum_display_t;
+
+  // STM32F429I-Discovery LCD through the BSP_LCD_* driver: disturbed
+  // spectrum in red, filtered in green, one plot over the full width
+  void spectrum_display_init(spectrum_display_t *display_desc, spectrum_display_style_t style,
+                             uint32_t sampling_frequency);
+  void spectrum_display_draw(const spectrum_display_t *display_desc, const spectrum_analyzer_q15_t *spectrum_desc);
+
+#endif
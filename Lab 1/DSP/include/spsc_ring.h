@@ -0,0 +1,25 @@
+#ifndef SPSC_RING_H
+
+  #define SPSC_RING_H
+
+  // Single-producer / single-consumer ring buffer of q15 samples.
+  // The producer only writes head, the consumer only writes tail, so
+  // one task (or ISR) may push while another pops without locking.
+  // size must be a power of two.
+
+  typedef struct
+  {
+    q15_t *buffer;
+    uint32_t mask;
+    volatile uint32_t head;
+    volatile uint32_t tail;
+    uint32_t overflows;
+  } spsc_ring_q15_t;
+
+  void spsc_ring_init(spsc_ring_q15_t *ring, q15_t *buffer, uint32_t size);
+  uint32_t spsc_ring_count(spsc_ring_q15_t *ring);
+  uint32_t spsc_ring_space(spsc_ring_q15_t *ring);
+  uint32_t spsc_ring_push(spsc_ring_q15_t *ring, q15_t *src, uint32_t len);
+  uint32_t spsc_ring_pop(spsc_ring_q15_t *ring, q15_t *dst, uint32_t len);
+
+#endif
@@ -0,0 +1,41 @@
+#ifndef STACK_MONITOR_H
+
+  #define STACK_MONITOR_H
+
+  #define STACK_MONITOR_MAX_STACKS (8u)
+
+  // fill of unused stack words
+  #define STACK_MONITOR_PAINT      (0xCDCDCDCDu)
+
+  typedef struct
+  {
+    const char *name;
+    uint32_t *stack;
+    uint32_t size;                  // bytes
+    uint32_t high_water;            // most bytes used, at the last query
+  } stack_monitor_entry_t;
+
+  // Task stacks painted before the task starts; the high-water mark
+  // is the part above the lowest word that no longer holds the paint.
+  // A call that reserves stack without writing all of it can leave
+  // painted words below the real peak, so keep a margin.
+  typedef struct
+  {
+    stack_monitor_entry_t entry[STACK_MONITOR_MAX_STACKS];
+    uint32_t count;
+  } stack_monitor_t;
+
+  void stack_monitor_init(stack_monitor_t *monitor_desc);
+
+  // paints stack (size bytes, 8 byte aligned) and keeps it for the report;
+  // call before the task is created on it
+  arm_status stack_monitor_add(stack_monitor_t *monitor_desc, const char *name, void *stack, uint32_t size);
+
+  // bytes of a painted stack used so far
+  uint32_t stack_monitor_high_water(const void *stack, uint32_t size);
+
+  // updates the high-water marks and prints, per stack, the size, the
+  // most used and the size recommended with margin_percent on top
+  void stack_monitor_report(stack_monitor_t *monitor_desc, uint32_t margin_percent);
+
+#endif
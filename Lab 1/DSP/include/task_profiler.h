@@ -0,0 +1,88 @@
+#ifndef TASK_PROFILER_H
+
+  #define TASK_PROFILER_H
+
+  // slot 0 is the idle demon, slot n the RTX task with id n
+  #define TASK_PROFILER_MAX_TASKS (16u)
+  #define TASK_PROFILER_IDLE_ID   (255u)
+
+  // wake-up latency histogram: bin 0 counts latencies below
+  // 2^TASK_PROFILER_BIN0_BITS cycles, every further bin doubles the
+  // limit and the last one takes everything above
+  #define TASK_PROFILER_BINS      (16u)
+  #define TASK_PROFILER_BIN0_BITS (8u)
+
+  // trace record events
+  #define TASK_PROFILER_READY     ('R')   // task put on the ready list (woken)
+  #define TASK_PROFILER_SWITCH    ('S')   // task switched in
+
+  // 8 bytes per kernel event; dumped as text lines
+  //   P <event> <cycles, 8 hex digits> <task id>
+  // after a line "P F <cycles per second>", which task_profiler.c built
+  // with TASK_PROFILER_REPLAY reads back on the host
+  typedef struct
+  {
+    uint32_t cycles;
+    uint8_t event;
+    uint8_t task_id;
+    uint16_t reserved;
+  } task_profiler_record_t;
+
+  typedef struct
+  {
+    const char *name;
+    uint32_t run_cycles;            // time switched in since the last reset
+    uint32_t switches;              // times switched in
+    uint32_t wakes;                 // switches that ended a wait (latency counted)
+    uint32_t latency_max;           // cycles from ready to running
+    uint32_t latency_hist[TASK_PROFILER_BINS];
+    uint32_t ready_at;              // valid while ready_pending
+    uint8_t ready_pending;
+  } task_profiler_task_t;
+
+  // CPU time and wake-up latency per task from the kernel's task switch
+  // and ready events: the run time of a task is the time between its
+  // switch in and the next switch, its latency the time from being put
+  // on the ready list (by an event, a delay or an interval expiring) to
+  // its switch in. A running task requeued by round robin or os_tsk_pass
+  // is not a wake-up. Cycle counts are 32 bit: reset at least every
+  // 2^32 cycles (80 s at the 53.76 MHz HCLK of the board).
+  typedef struct
+  {
+    task_profiler_task_t task[TASK_PROFILER_MAX_TASKS];
+    uint32_t cycles_per_sec;
+    uint32_t running;               // slot switched in last
+    uint32_t switched_at;
+    uint32_t window_start;
+    uint32_t unknown;               // events of task ids without a slot
+    task_profiler_record_t *trace;  // NULL: no trace
+    uint32_t trace_len;
+    uint32_t trace_count;
+    uint32_t trace_lost;            // events after the trace filled up
+  } task_profiler_t;
+
+  // trace: trace_len records kept from the start until full, or NULL
+  void task_profiler_init(task_profiler_t *profiler_desc, uint32_t cycles_per_sec,
+                          task_profiler_record_t *trace, uint32_t trace_len);
+  void task_profiler_name(task_profiler_t *profiler_desc, uint32_t task_id, const char *name);
+
+  // On the target: starts the DWT cycle counter and hooks the profiler
+  // into the RTX kernel; running_id is the caller (os_tsk_self()).
+  // Stopped (or never started) the hooks cost a load and a compare.
+  void task_profiler_start(task_profiler_t *profiler_desc, uint32_t running_id);
+  void task_profiler_stop(void);
+
+  // kernel events; called by the hooks, or by the replay on the host
+  void task_profiler_ready(task_profiler_t *profiler_desc, uint32_t task_id, uint32_t now);
+  void task_profiler_switch(task_profiler_t *profiler_desc, uint32_t task_id, uint32_t now);
+
+  // starts a new measurement window, keeps names and the trace
+  void task_profiler_reset(task_profiler_t *profiler_desc, uint32_t now);
+
+  // load per task in 0.1 % and latency percentiles since the last reset
+  void task_profiler_report(const task_profiler_t *profiler_desc, uint32_t now);
+
+  // prints the trace in the replay format
+  void task_profiler_dump(const task_profiler_t *profiler_desc);
+
+#endif
@@ -0,0 +1,25 @@
+#ifndef TONE_BANK_H
+
+  #define TONE_BANK_H
+
+  #define TONE_BANK_MAX_TONES (8u)   // must be even
+
+  // N IIR oscillators in structure-of-arrays layout.
+  // Each state word packs y[n-1] (low half) and y[n-2] (high half), each
+  // coefficient word packs cos(w) and -0.5, so one dual 16-bit multiply
+  // steps one oscillator. The gains of all tones should add up to 1.0
+  // at most, otherwise the mix accumulator can overflow.
+
+  typedef struct
+  {
+    uint32_t state[TONE_BANK_MAX_TONES];
+    uint32_t coeff[TONE_BANK_MAX_TONES];
+    q15_t gain[TONE_BANK_MAX_TONES];
+    uint32_t num_tones;
+  } tone_bank_q15_t;
+
+  void tone_bank_init_q15(tone_bank_q15_t *bank_desc);
+  int32_t tone_bank_add_q15(tone_bank_q15_t *bank_desc, uint32_t tone_frequency, uint32_t sampling_frequency, q15_t gain);
+  void tone_bank_calc_block_q15(tone_bank_q15_t *bank_desc, q15_t *output, uint32_t block_len);
+
+#endif
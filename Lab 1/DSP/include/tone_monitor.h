@@ -0,0 +1,33 @@
+#ifndef TONE_MONITOR_H
+
+  #define TONE_MONITOR_H
+
+  #define TONE_MONITOR_MAX_BINS (4u)
+
+  // One Goertzel resonator per watched frequency. power is the mean
+  // square of the tone relative to full scale (a full scale sine reads
+  // 0.5), measured over the last completed window.
+  typedef struct
+  {
+    float32_t coeff;     // 2 cos(w)
+    float32_t s1;
+    float32_t s2;
+    float32_t power;
+  } tone_monitor_bin_t;
+
+  typedef struct
+  {
+    tone_monitor_bin_t bin[TONE_MONITOR_MAX_BINS];
+    uint32_t num_bins;
+    uint32_t window_len;
+    uint32_t count;      // samples into the current window
+    uint32_t windows;    // completed windows
+  } tone_monitor_q15_t;
+
+  void tone_monitor_init(tone_monitor_q15_t *monitor_desc, uint32_t window_len);
+  arm_status tone_monitor_add_bin(tone_monitor_q15_t *monitor_desc, uint32_t frequency, uint32_t sampling_frequency);
+  uint32_t tone_monitor_block(tone_monitor_q15_t *monitor_desc, const q15_t *input, uint32_t len);
+  float32_t tone_monitor_ratio_db(const tone_monitor_q15_t *monitor_a, uint32_t bin_a,
+                                  const tone_monitor_q15_t *monitor_b, uint32_t bin_b);
+
+#endif
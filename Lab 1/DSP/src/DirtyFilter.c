@@ -18,9 +18,25 @@
 #include <stdio.h>
 
 #include "arm_math.h"
+#include "stm32f4xx.h"
 #include "sine_generator.h"
 #include "rtxtime.h"
 #include "low_pass_filter.h"
+#include "spsc_ring.h"
+#include "block_pool.h"
+#include "dataflow.h"
+#include "noise_canceller.h"
+#include "tone_monitor.h"
+#include "spectrum_analyzer.h"
+#include "spectrum_display.h"
+#include "dac_output.h"
+#include "task_profiler.h"
+#include "cycle_counter.h"
+#include "event_trace.h"
+#include "stack_monitor.h"
+#include "saturation.h"
+#include "signal_chain.h"
+#include "dsp_bench.h"
 
 //-------- <<< Use Configuration Wizard in Context Menu >>> -----------------
 //
@@ -29,7 +45,7 @@
 
 #define ENABLE_CONFIG 1
 // =============================
-//   <o>Oscillator Sampling Frequency [Hz] <1000-10000>
+//   <o>Oscillator Sampling Frequency [Hz] <1000-48000>
 //   <i> Set the oscillator sampling frequency.
 //   <i> Default: 5000  (5 KHz)
 #define SAMPLING_FREQ 1000  // generating task (5 KHz)
@@ -44,24 +60,529 @@
 //   <i> Default: 330 Hz
 #define SIGNAL_FREQ    10  // disturbed signal (250 Hz)
 
+//   <o>Signal Gain [1/1000] <0-3999>
+//   <i> Scale applied to the signal oscillator output, with saturation.
+//   <i> Default: 500
+#define SIGNAL_GAIN    500
+
+//   <o>Noise Gain [1/1000] <0-3999>
+//   <i> Scale applied to the noise oscillator output, with saturation.
+//   <i> Default: 167
+#define NOISE_GAIN     167
+
+//   <o>Oscillator Type <0=>IIR oscillator <1=>NCO (phase accumulator)
+//   <i> IIR: marginally stable biquad, amplitude drifts with q15 rounding.
+//   <i> NCO: quarter-wave table with linear interpolation, drift free.
+#define GENERATOR_MODE 0
+
+//   <o>IIR Oscillator Renormalization [samples] <0-10000>
+//   <i> Reloads the IIR oscillator state from a phase accumulator every N samples,
+//   <i> so amplitude and phase stay on the ideal sine in long (soak) runs.
+//   <i> Lower is smoother at low SIGNAL_FREQ / SAMPLING_FREQ. 0: off.
+//   <i> Default: 0
+#define OSC_RENORM_PERIOD 0
+
 // </e>
+//
+// <h>Filter Configuration
+//   <o>Filter Type <0=>32-tap FIR (q15) <2=>Biquad cascade (q31)
+//   <i> The 4th-order biquad cascade needs 10 MACs per sample instead of 32.
+//   <i> There is no q15 biquad choice: with q15 state it keeps a 37 LSB limit cycle
+//   <i> and reaches only -45 dB at 50 Hz (18 bit coefficients needed, see
+//   <i> coeff_analysis.c). It is kept for dsp_bench and the golden vectors only.
+#define FILTER_KIND      0
+
+//   <q>Design FIR taps from the frequency plan
+//   <i> Checks the FIR taps at startup against SIGNAL_FREQ / NOISE_FREQ / SAMPLING_FREQ
+//   <i> (1 dB passband ripple, stopband attenuation a 32-tap Kaiser design can reach).
+//   <i> The fixed table (tuned for 10 Hz / 50 Hz at 1 kHz) is kept if it meets them,
+//   <i> otherwise the taps are designed for the plan.
+#define FILTER_DESIGN    0
+
+//   <o>Noise Removal <0=>Low pass filter <1=>Adaptive NLMS canceller (q15) <2=>Adaptive NLMS canceller (q31)
+//   <i> The canceller subtracts an adaptive estimate of the noise, computed from the
+//   <i> noise generator output. It does not attenuate or delay the signal and also
+//   <i> works when the noise is close to the signal band.
+#define NOISE_CANCELLER  0
+
+//   <o>Canceller Taps <2-64>
+//   <i> Length of the adaptive filter.
+#define CANCELLER_TAPS   16
+
+//   <o>Canceller Step Size [1/10000] <1-9999>
+//   <i> Normalized LMS step. Larger converges faster, smaller rejects more and
+//   <i> notches less of the signal. The q15 kind needs at least about 50.
+#define CANCELLER_STEP   20
+
+//   <o>Filter Block Length [samples] <1-256>
+//   <i> Number of samples processed per FIR call.
+//   <i> The filtered output is delayed by one block.
+//   <i> Default: 1
+#define FILTER_BLOCK_LEN 1
+
+//   <q>Run DSP benchmarks at startup
+//   <i> Prints cycle counts of the DSP blocks on the ITM console.
+#define DSP_BENCH        0
+
+// </h>
+//
+// <h>Pipeline Configuration
+//   <o>Task Hand-off <0=>Per-sample events <1=>Block pipeline <2=>Mailbox pipeline <3=>Dataflow graph
+//   <i> Per-sample events: each stage wakes the next one for every sample,
+//   <i> and filter_tsk wakes sine_gen for the next one of the tick.
+//   <i> Block pipeline: stages pass FILTER_BLOCK_LEN sample blocks through
+//   <i> lock-free ring buffers and are only woken when a block is ready.
+//   <i> Mailbox pipeline: blocks come from a pool and are passed between the
+//   <i> stages by pointer in RTX mailboxes, without copies or shared samples.
+//   <i> Dataflow graph: the stages are a const table run by the dataflow
+//   <i> scheduler, in one task or spread over several (see below).
+#define PIPELINE_MODE     0
+
+//   <o>Ring Buffer Size [samples] <256=>256 <1024=>1024 <4096=>4096
+//   <i> Must hold at least one tick worth of samples plus one block.
+#define PIPELINE_RING_LEN 1024
+
+//   <o>Frame Pool Size [blocks] <4-128>
+//   <i> Mailbox pipeline: frames of FILTER_BLOCK_LEN samples in flight.
+//   <i> Frame_pool.stats.high_water shows how many were needed.
+#define PIPELINE_POOL_LEN 32
+
+//   <q>Spread Graph over Tasks
+//   <i> Dataflow graph: run the generators, the mixer and the filter stage in
+//   <i> three tasks. Off: the whole graph runs in one task, without context
+//   <i> switches between the stages.
+#define GRAPH_SPREAD      0
+
+//   <q>Graph Stage Report
+//   <i> Dataflow graph: prints firings and cycles of every stage every 10 s.
+#define GRAPH_REPORT      0
+
+// </h>
+//
+// <h>Quality Monitor
+//   <q>Tone power monitor
+//   <i> Goertzel bins at SIGNAL_FREQ and NOISE_FREQ on the disturbed and the
+//   <i> filtered stream (4 multiply-adds per sample). Filter_quality shows the
+//   <i> SNR before and after the filter and the noise rejection in dB.
+#define TONE_MONITOR           1
+
+//   <o>Monitor Window [ms] <10-1000>
+//   <i> SIGNAL_FREQ and NOISE_FREQ should be multiples of 1000 / window,
+//   <i> otherwise the two tones leak into each other's bins.
+#define TONE_MONITOR_WINDOW_MS 100
+
+// </h>
+//
+// <h>Spectrum Analyzer
+//   <q>Spectrum analyzer
+//   <i> Hann windowed q15 FFT of the disturbed and the filtered stream, computed in
+//   <i> a task below the pipeline priority: a frame is dropped rather than delaying
+//   <i> the filter. Spectrum.level has the bins, Spectrum.stats the frame rate.
+#define SPECTRUM_ANALYZER      0
+
+//   <o>FFT Length <256=>256 <512=>512 <1024=>1024
+#define SPECTRUM_FFT_LEN       256
+
+//   <o>Update Rate [frames/s] <1-50>
+//   <i> One frame every SAMPLING_FREQ / rate samples; frames overlap when this is
+//   <i> shorter than the FFT length. Spectrum.stats.frames_per_sec shows the rate achieved.
+#define SPECTRUM_RATE_HZ       4
+
+//   <o>Display <0=>None (Watch window / console) <1=>LCD, bars <2=>LCD, lines
+//   <i> The LCD needs the STM32F429I-Discovery and the BSP_LCD_* drivers of the
+//   <i> lab1 project, with src/spectrum_display.c added to the build.
+#define SPECTRUM_LCD           0
+
+// </h>
+//
+// <h>Output
+//   <q>DAC output
+//   <i> Plays the filtered signal on DAC channel 1 (PA4), paced by TIM6 and fed
+//   <i> by DMA from a double buffer; the filter stage only writes into a ring.
+#define DAC_OUTPUT             0
+
+//   <o>DAC Half Buffer [samples] <4-1024>
+//   <i> At least the samples delivered per tick in every pipeline mode
+//   <i> (SAMPLING_FREQ / 100) plus the worst filter delay; the output lags
+//   <i> the filter by three halves.
+//   <i> Dac_output.stats counts underruns.
+#define DAC_HALF_LEN           32
+
+// </h>
+//
+// <h>Profiler
+//   <q>Task profiler
+//   <i> CPU load and wake-up latency of every task from the RTX task switches,
+//   <i> timed with the DWT cycle counter; printed every 10 s. Off, the kernel
+//   <i> hooks cost a load and a compare per event.
+#define TASK_PROFILER          0
+
+//   <o>Trace Length [records] <0-4096>
+//   <i> Kernel events kept from the start (8 bytes each) and printed once full,
+//   <i> for task_profiler.c built with TASK_PROFILER_REPLAY on a PC. 0: no trace.
+#define TASK_PROFILER_TRACE_LEN 256
+
+//   <q>Event trace
+//   <i> Filter stage and spectrum frame spans, sync ticks and the DAC ring fill
+//   <i> recorded as 8 byte records in a RAM ring, sent over SWO (ITM port 1)
+//   <i> for src/event_trace.c built with EVENT_TRACE_EXPORT on a PC.
+#define EVENT_TRACE            0
+
+//   <o>Trace Ring [records] <256=>256 <1024=>1024 <4096=>4096
+#define EVENT_TRACE_LEN        1024
+
+//   <o>Dump After [s] <0-60>
+//   <i> Stops the trace and sends the ring once. 0: never, read Event_trace
+//   <i> in the debugger instead.
+#define EVENT_TRACE_DUMP_S     10
+
+// </h>
+//
+// <h>Task Stacks
+//   <i> The pipeline tasks run on stacks of their own size (os_tsk_create_user,
+//   <i> counted in OS_PRIVCNT); OS_STKSIZE only applies to main_tsk. Size them
+//   <i> from the stack report or from src/stack_estimate.c.
+//   <o>Generator Task Stacks [bytes] <128-4096:8>
+//   <i> sine_gen, noise_gen and disturb_gen, each.
+#define GEN_STACK_SIZE         512
+
+//   <o>Filter Task Stack [bytes] <128-4096:8>
+//   <i> filter_tsk, or every graph_tsk in the dataflow graph mode.
+#define FILTER_STACK_SIZE      512
+
+//   <o>Sync Task Stack [bytes] <128-4096:8>
+#define SYNC_STACK_SIZE        512
+
+//   <o>Spectrum Task Stack [bytes] <128-4096:8>
+#define SPECTRUM_STACK_SIZE    1024
+
+//   <q>Stack report
+//   <i> Prints the high-water mark of every task stack every 10 s, with the size
+//   <i> it suggests (25 % on top). Stack_monitor has the marks of the last report.
+#define STACK_REPORT           0
+
+// </h>
 //------------- <<< end of configuration section >>> -----------------------
 
+// OS_TICK in RTX_Conf_STM32F4.c is 10 ms
+#define SYNC_TICK_HZ      100
+#define SAMPLES_PER_TICK  (SAMPLING_FREQ / SYNC_TICK_HZ)
+
+// the ticks release whole samples only, a remainder would be lost
+#if (SAMPLING_FREQ % SYNC_TICK_HZ)
+  #error "SAMPLING_FREQ must be a multiple of SYNC_TICK_HZ (100 Hz)"
+#endif
+
+// the spectrum analyzer only gets the time the pipeline leaves
+#define PIPELINE_PRIORITY 2
+#define SPECTRUM_PRIORITY 1
+
+// pipeline stages, index into Pipeline_stats.activations
+#define STAGE_SINE        0
+#define STAGE_NOISE       1
+#define STAGE_DISTURB     2
+#define STAGE_FILTER      3
+#define STAGE_SYNC        4
+#define STAGE_COUNT       5
 
-sine_generator_q15_t Signal_set;
-sine_generator_q15_t Noise_set;
+// event numbers of the trace, names in trace_names
+#define TRACE_SYNC        0               // instant, arg: tick within the second
+#define TRACE_FILTER      1               // span of a filter task activation or firing
+#define TRACE_SPECTRUM    2               // span of a spectrum frame
+#define TRACE_DAC_FILL    3               // counter: samples in the DAC ring
+#define TRACE_COUNT       4
+
+#if (GENERATOR_MODE == 0)
+  typedef sine_generator_q15_t generator_q15_t;
+  #define generator_init_q15        sine_generator_init_q15
+  #define generator_calc_sample_q15 sine_calc_sample_q15
+  #define generator_calc_block_q15  sine_calc_block_q15
+#else
+  typedef sine_generator_nco_q15_t generator_q15_t;
+  #define generator_init_q15        sine_generator_nco_init_q15
+  #define generator_calc_sample_q15 sine_nco_calc_sample_q15
+  #define generator_calc_block_q15  sine_nco_calc_block_q15
+#endif
+
+typedef struct
+{
+  U32 activations[STAGE_COUNT];   // task wake-ups, i.e. context switches into each stage
+  U32 samples;                    // samples delivered by the filter stage
+  U32 dropped;                    // samples not generated, the pipeline was full
+  U32 activations_per_sec;        // updated once per second by sync_tsk
+  U32 samples_per_sec;
+} pipeline_stats_t;
+
+typedef struct
+{
+  U32 windows;                    // completed monitor windows
+  float snr_in_db;                // signal over noise tone, disturbed stream
+  float snr_out_db;               // same on the filtered stream
+  float rejection_db;             // noise tone attenuation through the filter
+  float signal_gain_db;           // signal tone gain through the filter
+} filter_quality_t;
+
+
+generator_q15_t Signal_set;
+generator_q15_t Noise_set;
 
 q15_t sine;
 q15_t noise;
 q15_t disturbed;
 q15_t filtered;
 
+low_pass_filter_q15_t Filter_set;
+q31_t filter_state[LOW_PASS_FILTER_STATE_LEN(FILTER_BLOCK_LEN)];
+
+#if NOISE_CANCELLER
+noise_canceller_q15_t Canceller_set;
+#if (PIPELINE_MODE == 0)
+q31_t canceller_work[NOISE_CANCELLER_WORK_LEN(CANCELLER_TAPS, 1)];
+#else
+q31_t canceller_work[NOISE_CANCELLER_WORK_LEN(CANCELLER_TAPS, FILTER_BLOCK_LEN)];
+#endif
+#endif
+
+#if (PIPELINE_MODE == 0)
+low_pass_filter_pingpong_q15_t Filter_pingpong;
+q15_t filter_input[2 * FILTER_BLOCK_LEN];
+q15_t filter_output[2 * FILTER_BLOCK_LEN];
+#elif (PIPELINE_MODE == 2)
+// one block of every stream; each stage fills its part in place and
+// passes the frame on, filter_tsk returns it to the pool
+typedef struct
+{
+  q15_t sine[FILTER_BLOCK_LEN];
+  q15_t noise[FILTER_BLOCK_LEN];
+  q15_t disturbed[FILTER_BLOCK_LEN];
+  q15_t filtered[FILTER_BLOCK_LEN];
+} pipeline_frame_t;
+
+BLOCK_POOL_DECLARE(frame_box, sizeof(pipeline_frame_t), PIPELINE_POOL_LEN);
+block_pool_t Frame_pool;
+
+// deep enough for every frame of the pool, so a send never blocks
+os_mbx_declare(noise_mbx, PIPELINE_POOL_LEN);
+os_mbx_declare(disturb_mbx, PIPELINE_POOL_LEN);
+os_mbx_declare(filter_mbx, PIPELINE_POOL_LEN);
+#elif (PIPELINE_MODE == 1)
+spsc_ring_q15_t sine_ring;
+spsc_ring_q15_t noise_ring;
+spsc_ring_q15_t disturbed_ring;
+
+q15_t sine_ring_buffer[PIPELINE_RING_LEN];
+q15_t noise_ring_buffer[PIPELINE_RING_LEN];
+q15_t disturbed_ring_buffer[PIPELINE_RING_LEN];
+
+#if NOISE_CANCELLER
+// the canceller also needs the noise reference, and the clean
+// signal for its residual metric
+spsc_ring_q15_t reference_ring;
+spsc_ring_q15_t wanted_ring;
+
+q15_t reference_ring_buffer[PIPELINE_RING_LEN];
+q15_t wanted_ring_buffer[PIPELINE_RING_LEN];
+
+static q15_t canceller_block[2][FILTER_BLOCK_LEN];
+#endif
+
+// per-task work buffers, kept off the task stacks
+static q15_t sine_block[FILTER_BLOCK_LEN];
+static q15_t noise_block[FILTER_BLOCK_LEN];
+static q15_t disturb_block[2][FILTER_BLOCK_LEN];
+static q15_t filter_block[2][FILTER_BLOCK_LEN];
+#elif (PIPELINE_MODE == 3)
+#if GRAPH_SPREAD
+  #define GRAPH_TASKS     3
+  #define GRAPH_TASK(t)   (t)
+#else
+  #define GRAPH_TASKS     1
+  #define GRAPH_TASK(t)   0
+#endif
+
+// gain stage behind a generator, context of the two source stages
+typedef struct
+{
+  generator_q15_t *generator;
+  q15_t scale_fract;
+  saturation_stats_t *stats;
+  q15_t *mirror;                  // Logic Analyzer variable
+} graph_source_t;
+
+dataflow_graph_t Graph;
+OS_TID graph_tid[GRAPH_TASKS];
+
+static q15_t graph_scratch[GRAPH_TASKS * DATAFLOW_SCRATCH_LEN(FILTER_BLOCK_LEN)];
+static q15_t sine_edge_buffer[PIPELINE_RING_LEN];
+static q15_t noise_edge_buffer[PIPELINE_RING_LEN];
+static q15_t disturbed_edge_buffer[PIPELINE_RING_LEN];
+#if NOISE_CANCELLER
+static q15_t reference_edge_buffer[PIPELINE_RING_LEN];
+static q15_t wanted_edge_buffer[PIPELINE_RING_LEN];
+#endif
+#endif
+
+pipeline_stats_t Pipeline_stats;
+
+// clip events, peak and headroom of each stage output, indexed like
+// Pipeline_stats.activations (STAGE_SYNC unused)
+saturation_stats_t Saturation_stats[STAGE_COUNT];
+
+#if TONE_MONITOR
+// bin 0: SIGNAL_FREQ, bin 1: NOISE_FREQ
+tone_monitor_q15_t Disturbed_monitor;
+tone_monitor_q15_t Filtered_monitor;
+filter_quality_t Filter_quality;
+#endif
+
+#if SPECTRUM_ANALYZER
+spectrum_analyzer_q15_t Spectrum;
+static q15_t spectrum_work[SPECTRUM_WORK_LEN(SPECTRUM_FFT_LEN)];
+static U64 spectrum_stack[SPECTRUM_STACK_SIZE / 8];
+#if SPECTRUM_LCD
+spectrum_display_t Spectrum_display;
+#endif
+OS_TID spectrum_tsk_tid;
+#endif
+
+#if DAC_OUTPUT
+dac_output_t Dac_output;
+static uint16_t dac_dma_buffer[2 * DAC_HALF_LEN];
+static q15_t dac_ring_buffer[PIPELINE_RING_LEN];
+#endif
+
+#if TASK_PROFILER
+task_profiler_t Task_profiler;
+#if TASK_PROFILER_TRACE_LEN
+static task_profiler_record_t profiler_trace[TASK_PROFILER_TRACE_LEN];
+#endif
+#endif
+
+#if EVENT_TRACE
+event_trace_t Event_trace;
+static event_trace_record_t event_trace_buffer[EVENT_TRACE_LEN];
+static const char *const trace_names[TRACE_COUNT] = { "sync", "filter", "spectrum", "dac_fill" };
+#define TRACE_EVENT(kind, number, arg) event_trace_write(&Event_trace, (kind) | (number), (arg))
+#else
+#define TRACE_EVENT(kind, number, arg)
+#endif
+
+// task stacks, painted for Stack_monitor
+#if (PIPELINE_MODE == 3)
+static U64 graph_stack[GRAPH_TASKS][FILTER_STACK_SIZE / 8];
+#else
+static U64 sine_gen_stack[GEN_STACK_SIZE / 8];
+static U64 noise_gen_stack[GEN_STACK_SIZE / 8];
+static U64 disturb_gen_stack[GEN_STACK_SIZE / 8];
+static U64 filter_tsk_stack[FILTER_STACK_SIZE / 8];
+#endif
+static U64 sync_tsk_stack[SYNC_STACK_SIZE / 8];
+stack_monitor_t Stack_monitor;
+
 OS_TID sine_gen_tid;
 OS_TID noise_gen_tid;
 OS_TID disturb_gen_tid;
 OS_TID filter_tsk_tid;
 OS_TID sync_tsk_tid;
 
+/*
+*********************************************************************
+*
+* Filter quality
+*
+* Feeds the filter input and output to the tone monitors and
+* publishes the dB figures whenever a window completes.
+*
+*********************************************************************
+*/
+
+#if TONE_MONITOR
+static void filter_quality_update(const q15_t *input, const q15_t *output, uint32_t len)
+{
+  tone_monitor_block(&Disturbed_monitor, input, len);
+  if (tone_monitor_block(&Filtered_monitor, output, len))
+  {
+    Filter_quality.snr_in_db = tone_monitor_ratio_db(&Disturbed_monitor, 0, &Disturbed_monitor, 1);
+    Filter_quality.snr_out_db = tone_monitor_ratio_db(&Filtered_monitor, 0, &Filtered_monitor, 1);
+    Filter_quality.rejection_db = tone_monitor_ratio_db(&Disturbed_monitor, 1, &Filtered_monitor, 1);
+    Filter_quality.signal_gain_db = tone_monitor_ratio_db(&Filtered_monitor, 0, &Disturbed_monitor, 0);
+    Filter_quality.windows = Filtered_monitor.windows;
+  }
+}
+#endif
+
+/*
+*********************************************************************
+*
+* Spectrum analyzer
+*
+* The filter stage hands its input and output blocks over; every
+* SAMPLING_FREQ / SPECTRUM_RATE_HZ samples a frame is taken and
+* spectrum_tsk woken to analyze (and draw) it at SPECTRUM_PRIORITY.
+*
+*********************************************************************
+*/
+
+#if SPECTRUM_ANALYZER
+static void spectrum_update(const q15_t *input, const q15_t *output, uint32_t len)
+{
+  if (spectrum_analyzer_block_q15(&Spectrum, input, output, len))
+    os_evt_set(0x0001, spectrum_tsk_tid);
+}
+
+__task void spectrum_tsk(void)
+{
+#if SPECTRUM_LCD
+  U32 start;
+#endif
+
+  while(1)
+  {
+    os_evt_wait_and(0x0001, 0xFFFF);
+    TRACE_EVENT(EVENT_TRACE_BEGIN, TRACE_SPECTRUM, Spectrum.stats.frames);
+    spectrum_analyzer_process_q15(&Spectrum);
+#if SPECTRUM_LCD
+    start = cycle_counter_read();
+    spectrum_display_draw(&Spectrum_display, &Spectrum);
+    Spectrum.stats.draw_cycles = cycle_counter_read() - start;
+#endif
+    TRACE_EVENT(EVENT_TRACE_END, TRACE_SPECTRUM, Spectrum.stats.frames);
+    if ((Spectrum.stats.frames % (10 * SPECTRUM_RATE_HZ)) == 0)
+    {
+      printf ("Spectrum: %u fps, %u dropped, fft %u, draw %u " CYCLE_COUNTER_UNIT "\n\r",
+              (unsigned)Spectrum.stats.frames_per_sec, (unsigned)Spectrum.stats.dropped,
+              (unsigned)Spectrum.stats.fft_cycles, (unsigned)Spectrum.stats.draw_cycles);
+    }
+    spectrum_analyzer_release(&Spectrum);
+  }
+}
+#endif
+
+/*
+*********************************************************************
+*
+* Filter output
+*
+* Everything downstream of the filter stage, called by it in every
+* pipeline mode with the filter input and output.
+*
+*********************************************************************
+*/
+
+static void filter_stage_output(const q15_t *input, q15_t *output, uint32_t len)
+{
+#if TONE_MONITOR
+  filter_quality_update(input, output, len);
+#endif
+#if SPECTRUM_ANALYZER
+  spectrum_update(input, output, len);
+#endif
+#if DAC_OUTPUT
+  dac_output_write(&Dac_output, output, len);
+  TRACE_EVENT(EVENT_TRACE_COUNTER, TRACE_DAC_FILL, spsc_ring_count(&Dac_output.ring));
+#endif
+}
+
 /*
 *********************************************************************
 *
@@ -70,13 +591,28 @@ OS_TID sync_tsk_tid;
 *********************************************************************
 */
 
+#if (PIPELINE_MODE == 0)
+
+// Per-sample events: sync_tsk releases one tick worth of samples
+// (SAMPLES_PER_TICK) to sine_gen, which hands them down the chain one
+// at a time and waits for filter_tsk to take each one (event 0x0002)
+// before it overwrites sine with the next.
 __task void sine_gen(void)
 {
+  U32 n;
+
   while(1)
   {
     os_evt_wait_and(0x0001, 0xFFFF);
-    sine = sine_calc_sample_q15(&Signal_set) / 2;
-    os_evt_set(0x0001, noise_gen_tid);
+    Pipeline_stats.activations[STAGE_SINE]++;
+    for (n = 0; n < SAMPLES_PER_TICK; n++)
+    {
+      sine = signal_chain_gain_q15(&Saturation_stats[STAGE_SINE], generator_calc_sample_q15(&Signal_set),
+                                   SIGNAL_CHAIN_GAIN_SCALE(SIGNAL_GAIN));
+      os_evt_set(0x0001, noise_gen_tid);
+      os_evt_wait_and(0x0002, 0xFFFF);
+      Pipeline_stats.activations[STAGE_SINE]++;
+    }
   }
 }
 
@@ -93,7 +629,9 @@ __task void noise_gen(void)
   while(1)
   {
     os_evt_wait_and(0x0001, 0xFFFF);
-    noise = sine_calc_sample_q15(&Noise_set) / 6;
+    Pipeline_stats.activations[STAGE_NOISE]++;
+    noise = signal_chain_gain_q15(&Saturation_stats[STAGE_NOISE], generator_calc_sample_q15(&Noise_set),
+                                  SIGNAL_CHAIN_GAIN_SCALE(NOISE_GAIN));
     os_evt_set(0x0001, disturb_gen_tid);
   }
 }
@@ -113,7 +651,8 @@ __task void disturb_gen(void)
   while(1)
   {
     os_evt_wait_and(0x0001, 0xFFFF);
-    disturbed = sine + noise;
+    Pipeline_stats.activations[STAGE_DISTURB]++;
+    disturbed = signal_chain_mix_q15(&Saturation_stats[STAGE_DISTURB], sine, noise);
     os_evt_set(0x0001, filter_tsk_tid);
   }
 }
@@ -130,13 +669,435 @@ __task void disturb_gen(void)
 
 __task void filter_tsk(void)
 {
+#if NOISE_CANCELLER
+  q15_t primary, reference, wanted;
+#endif
+
   while(1)
   {
     os_evt_wait_and(0x0001, 0xFFFF);
-    filtered = low_pass_filter(&disturbed); 
+    Pipeline_stats.activations[STAGE_FILTER]++;
+    TRACE_EVENT(EVENT_TRACE_BEGIN, TRACE_FILTER, 1);
+#if NOISE_CANCELLER
+    primary = disturbed;
+    reference = noise;
+    wanted = sine;
+    signal_chain_filter_block_q15(&Filter_set, &Canceller_set, &Saturation_stats[STAGE_FILTER], &primary, &reference,
+                                  &wanted, &filtered, 1);
+#else
+    filtered = low_pass_filter_pingpong(&Filter_pingpong, disturbed);
+    saturation_track_block_q15(&Saturation_stats[STAGE_FILTER], &filtered, 1);
+#endif
+    Pipeline_stats.samples++;
+    filter_stage_output(&disturbed, &filtered, 1);
+    TRACE_EVENT(EVENT_TRACE_END, TRACE_FILTER, 1);
+    os_evt_set(0x0002, sine_gen_tid);
   }
 }
 
+#elif (PIPELINE_MODE == 1)
+
+/*
+*********************************************************************
+*
+* Block pipeline
+*
+* sync_tsk releases one tick worth of samples (SAMPLES_PER_TICK) to
+* both generators. Every stage moves whole blocks of FILTER_BLOCK_LEN
+* samples through a lock-free ring buffer and wakes its consumer only
+* once a complete block is waiting.
+*
+* A stage only takes a block when its output rings have room for it,
+* so nothing is lost between the stages. When the generator rings
+* cannot take a tick, or a generator has not finished the last one,
+* sync_tsk drops the tick for both generators and counts it in
+* Pipeline_stats.dropped: sine and noise, and the wanted and
+* reference rings of the canceller, stay aligned.
+*
+*********************************************************************
+*/
+
+// ticks finished by sine_gen and noise_gen, against those released
+static volatile U32 ticks_generated[2];
+static U32 ticks_released;
+
+static void pipeline_release_tick(void)
+{
+  if ((ticks_generated[STAGE_SINE] == ticks_released) &&
+      (ticks_generated[STAGE_NOISE] == ticks_released) &&
+      (spsc_ring_space(&sine_ring) >= SAMPLES_PER_TICK) &&
+      (spsc_ring_space(&noise_ring) >= SAMPLES_PER_TICK))
+  {
+    ticks_released++;
+    os_evt_set(0x0001, sine_gen_tid);
+    os_evt_set(0x0001, noise_gen_tid);
+  }
+  else
+  {
+    Pipeline_stats.dropped += SAMPLES_PER_TICK;
+  }
+}
+
+static int disturb_room(void)
+{
+#if NOISE_CANCELLER
+  if ((spsc_ring_space(&wanted_ring) < FILTER_BLOCK_LEN) ||
+      (spsc_ring_space(&reference_ring) < FILTER_BLOCK_LEN))
+    return 0;
+#endif
+  return spsc_ring_space(&disturbed_ring) >= FILTER_BLOCK_LEN;
+}
+
+static void generate_tick(generator_q15_t *sine_desc, q15_t scale_fract, saturation_stats_t *stats,
+                          spsc_ring_q15_t *ring, q15_t *block)
+{
+  uint32_t remaining, len;
+
+  for (remaining = SAMPLES_PER_TICK; remaining > 0; remaining -= len)
+  {
+    len = (remaining < FILTER_BLOCK_LEN) ? remaining : FILTER_BLOCK_LEN;
+    generator_calc_block_q15(sine_desc, block, len);
+    signal_chain_gain_block_q15(stats, block, scale_fract, len);
+    spsc_ring_push(ring, block, len);
+  }
+}
+
+__task void sine_gen(void)
+{
+  while(1)
+  {
+    os_evt_wait_and(0x0001, 0xFFFF);
+    Pipeline_stats.activations[STAGE_SINE]++;
+    generate_tick(&Signal_set, SIGNAL_CHAIN_GAIN_SCALE(SIGNAL_GAIN), &Saturation_stats[STAGE_SINE], &sine_ring, sine_block);
+    ticks_generated[STAGE_SINE]++;
+    sine = sine_block[0];
+    if (spsc_ring_count(&sine_ring) >= FILTER_BLOCK_LEN)
+      os_evt_set(0x0001, disturb_gen_tid);
+  }
+}
+
+__task void noise_gen(void)
+{
+  while(1)
+  {
+    os_evt_wait_and(0x0001, 0xFFFF);
+    Pipeline_stats.activations[STAGE_NOISE]++;
+    generate_tick(&Noise_set, SIGNAL_CHAIN_GAIN_SCALE(NOISE_GAIN), &Saturation_stats[STAGE_NOISE], &noise_ring, noise_block);
+    ticks_generated[STAGE_NOISE]++;
+    noise = noise_block[0];
+    if (spsc_ring_count(&noise_ring) >= FILTER_BLOCK_LEN)
+      os_evt_set(0x0002, disturb_gen_tid);
+  }
+}
+
+__task void disturb_gen(void)
+{
+  while(1)
+  {
+    // 0x0004: filter_tsk made room after a stall
+    os_evt_wait_or(0x0007, 0xFFFF);
+    Pipeline_stats.activations[STAGE_DISTURB]++;
+
+    while ((spsc_ring_count(&sine_ring) >= FILTER_BLOCK_LEN) &&
+           (spsc_ring_count(&noise_ring) >= FILTER_BLOCK_LEN) && disturb_room())
+    {
+      spsc_ring_pop(&sine_ring, disturb_block[0], FILTER_BLOCK_LEN);
+      spsc_ring_pop(&noise_ring, disturb_block[1], FILTER_BLOCK_LEN);
+#if NOISE_CANCELLER
+      spsc_ring_push(&wanted_ring, disturb_block[0], FILTER_BLOCK_LEN);
+      spsc_ring_push(&reference_ring, disturb_block[1], FILTER_BLOCK_LEN);
+#endif
+      signal_chain_mix_block_q15(&Saturation_stats[STAGE_DISTURB], disturb_block[0], disturb_block[1],
+                                 disturb_block[0], FILTER_BLOCK_LEN);
+      spsc_ring_push(&disturbed_ring, disturb_block[0], FILTER_BLOCK_LEN);
+      os_evt_set(0x0001, filter_tsk_tid);
+    }
+    disturbed = disturb_block[0][0];
+  }
+}
+
+__task void filter_tsk(void)
+{
+  while(1)
+  {
+    os_evt_wait_and(0x0001, 0xFFFF);
+    Pipeline_stats.activations[STAGE_FILTER]++;
+    TRACE_EVENT(EVENT_TRACE_BEGIN, TRACE_FILTER, spsc_ring_count(&disturbed_ring));
+
+    while (spsc_ring_pop(&disturbed_ring, filter_block[0], FILTER_BLOCK_LEN))
+    {
+#if NOISE_CANCELLER
+      // pushed before the disturbed block, so always available here
+      spsc_ring_pop(&reference_ring, canceller_block[0], FILTER_BLOCK_LEN);
+      spsc_ring_pop(&wanted_ring, canceller_block[1], FILTER_BLOCK_LEN);
+      signal_chain_filter_block_q15(&Filter_set, &Canceller_set, &Saturation_stats[STAGE_FILTER], filter_block[0],
+                                    canceller_block[0], canceller_block[1], filter_block[1], FILTER_BLOCK_LEN);
+#else
+      signal_chain_filter_block_q15(&Filter_set, NULL, &Saturation_stats[STAGE_FILTER], filter_block[0], NULL, NULL,
+                                    filter_block[1], FILTER_BLOCK_LEN);
+#endif
+      Pipeline_stats.samples += FILTER_BLOCK_LEN;
+      filter_stage_output(filter_block[0], filter_block[1], FILTER_BLOCK_LEN);
+    }
+    // blocks left in the generator rings: disturb_gen stalled on a
+    // full ring and waits for the room made here
+    if ((spsc_ring_count(&sine_ring) >= FILTER_BLOCK_LEN) &&
+        (spsc_ring_count(&noise_ring) >= FILTER_BLOCK_LEN))
+      os_evt_set(0x0004, disturb_gen_tid);
+    filtered = filter_block[1][0];
+    TRACE_EVENT(EVENT_TRACE_END, TRACE_FILTER, 0);
+  }
+}
+
+#elif (PIPELINE_MODE == 2)
+
+/*
+*********************************************************************
+*
+* Mailbox pipeline
+*
+* sync_tsk grants SAMPLES_PER_TICK samples to sine_gen, which takes
+* a frame from Frame_pool for every FILTER_BLOCK_LEN samples of
+* credit and posts it to noise_gen. From there the frame travels
+* noise_gen -> disturb_gen -> filter_tsk as a pointer: whoever
+* received it owns it, nothing is shared or copied. When the pool is
+* empty the credit is kept for the next tick, up to one pool worth;
+* credit beyond that is discarded, i.e. those samples are skipped,
+* and counted in Pipeline_stats.dropped.
+*
+* sine, noise, disturbed and filtered only mirror the first sample of
+* each block for the Logic Analyzer.
+*
+*********************************************************************
+*/
+
+__task void sine_gen(void)
+{
+  U32 credit = 0;
+  pipeline_frame_t *frame;
+
+  while(1)
+  {
+    os_evt_wait_and(0x0001, 0xFFFF);
+    Pipeline_stats.activations[STAGE_SINE]++;
+
+    credit += SAMPLES_PER_TICK;
+    if (credit > PIPELINE_POOL_LEN * FILTER_BLOCK_LEN)
+    {
+      Pipeline_stats.dropped += credit - PIPELINE_POOL_LEN * FILTER_BLOCK_LEN;
+      credit = PIPELINE_POOL_LEN * FILTER_BLOCK_LEN;
+    }
+
+    for (; credit >= FILTER_BLOCK_LEN; credit -= FILTER_BLOCK_LEN)
+    {
+      frame = block_pool_alloc(&Frame_pool);
+      if (frame == NULL)
+        break;
+      generator_calc_block_q15(&Signal_set, frame->sine, FILTER_BLOCK_LEN);
+      signal_chain_gain_block_q15(&Saturation_stats[STAGE_SINE], frame->sine, SIGNAL_CHAIN_GAIN_SCALE(SIGNAL_GAIN),
+                                  FILTER_BLOCK_LEN);
+      sine = frame->sine[0];
+      os_mbx_send(noise_mbx, frame, 0xFFFF);
+    }
+  }
+}
+
+__task void noise_gen(void)
+{
+  pipeline_frame_t *frame;
+
+  while(1)
+  {
+    os_mbx_wait(noise_mbx, (void **)&frame, 0xFFFF);
+    Pipeline_stats.activations[STAGE_NOISE]++;
+    generator_calc_block_q15(&Noise_set, frame->noise, FILTER_BLOCK_LEN);
+    signal_chain_gain_block_q15(&Saturation_stats[STAGE_NOISE], frame->noise, SIGNAL_CHAIN_GAIN_SCALE(NOISE_GAIN),
+                                FILTER_BLOCK_LEN);
+    noise = frame->noise[0];
+    os_mbx_send(disturb_mbx, frame, 0xFFFF);
+  }
+}
+
+__task void disturb_gen(void)
+{
+  pipeline_frame_t *frame;
+
+  while(1)
+  {
+    os_mbx_wait(disturb_mbx, (void **)&frame, 0xFFFF);
+    Pipeline_stats.activations[STAGE_DISTURB]++;
+    signal_chain_mix_block_q15(&Saturation_stats[STAGE_DISTURB], frame->sine, frame->noise, frame->disturbed,
+                               FILTER_BLOCK_LEN);
+    disturbed = frame->disturbed[0];
+    os_mbx_send(filter_mbx, frame, 0xFFFF);
+  }
+}
+
+__task void filter_tsk(void)
+{
+  pipeline_frame_t *frame;
+
+  while(1)
+  {
+    os_mbx_wait(filter_mbx, (void **)&frame, 0xFFFF);
+    Pipeline_stats.activations[STAGE_FILTER]++;
+    TRACE_EVENT(EVENT_TRACE_BEGIN, TRACE_FILTER, FILTER_BLOCK_LEN);
+#if NOISE_CANCELLER
+    signal_chain_filter_block_q15(&Filter_set, &Canceller_set, &Saturation_stats[STAGE_FILTER], frame->disturbed,
+                                  frame->noise, frame->sine, frame->filtered, FILTER_BLOCK_LEN);
+#else
+    signal_chain_filter_block_q15(&Filter_set, NULL, &Saturation_stats[STAGE_FILTER], frame->disturbed, NULL, NULL,
+                                  frame->filtered, FILTER_BLOCK_LEN);
+#endif
+    Pipeline_stats.samples += FILTER_BLOCK_LEN;
+    filter_stage_output(frame->disturbed, frame->filtered, FILTER_BLOCK_LEN);
+    filtered = frame->filtered[0];
+    block_pool_free(&Frame_pool, frame);
+    TRACE_EVENT(EVENT_TRACE_END, TRACE_FILTER, FILTER_BLOCK_LEN);
+  }
+}
+
+#elif (PIPELINE_MODE == 3)
+
+/*
+*********************************************************************
+*
+* Dataflow graph
+*
+* The same chain as a table: sine and noise are sources of
+* FILTER_BLOCK_LEN samples, disturb mixes them and filter is the
+* sink. sync_tsk releases SAMPLES_PER_TICK samples to the sources
+* every tick; graph_tsk fires every stage of its task group that has
+* a full block on its inputs and room on its outputs. GRAPH_TASK
+* puts the three columns of the chain into their own tasks, or all
+* into task 0. Graph.stats has the cycles of every stage.
+*
+*********************************************************************
+*/
+
+static void graph_source(const dataflow_stage_t *stage, q15_t *const *input, q15_t *const *output)
+{
+  graph_source_t *source = stage->context;
+
+  generator_calc_block_q15(source->generator, output[0], stage->out_len);
+  signal_chain_gain_block_q15(source->stats, output[0], source->scale_fract, stage->out_len);
+  *(source->mirror) = output[0][0];
+}
+
+static void graph_disturb(const dataflow_stage_t *stage, q15_t *const *input, q15_t *const *output)
+{
+  signal_chain_mix_block_q15(&Saturation_stats[STAGE_DISTURB], input[0], input[1], output[0], stage->out_len);
+  disturbed = output[0][0];
+}
+
+// input 0: disturbed, canceller only: 1: noise reference, 2: clean sine
+static void graph_filter(const dataflow_stage_t *stage, q15_t *const *input, q15_t *const *output)
+{
+  TRACE_EVENT(EVENT_TRACE_BEGIN, TRACE_FILTER, stage->in_len);
+#if NOISE_CANCELLER
+  signal_chain_filter_block_q15(&Filter_set, &Canceller_set, &Saturation_stats[STAGE_FILTER], input[0], input[1],
+                                input[2], output[0], stage->in_len);
+#else
+  signal_chain_filter_block_q15(&Filter_set, NULL, &Saturation_stats[STAGE_FILTER], input[0], NULL, NULL, output[0],
+                                stage->in_len);
+#endif
+  Pipeline_stats.samples += stage->in_len;
+  filter_stage_output(input[0], output[0], stage->in_len);
+  filtered = output[0][0];
+  TRACE_EVENT(EVENT_TRACE_END, TRACE_FILTER, stage->in_len);
+}
+
+static graph_source_t sine_source = { &Signal_set, SIGNAL_CHAIN_GAIN_SCALE(SIGNAL_GAIN), &Saturation_stats[STAGE_SINE], &sine };
+static graph_source_t noise_source = { &Noise_set, SIGNAL_CHAIN_GAIN_SCALE(NOISE_GAIN), &Saturation_stats[STAGE_NOISE], &noise };
+
+#define GRAPH_SINE     0
+#define GRAPH_NOISE    1
+#define GRAPH_DISTURB  2
+#define GRAPH_FILTER   3
+
+//   name       fire           context        in out  in_len            out_len           task
+static const dataflow_stage_t graph_stages[] =
+{
+  { "sine",     graph_source,  &sine_source,  0, 1, 0,                FILTER_BLOCK_LEN, GRAPH_TASK(0) },
+  { "noise",    graph_source,  &noise_source, 0, 1, 0,                FILTER_BLOCK_LEN, GRAPH_TASK(0) },
+  { "disturb",  graph_disturb, NULL,          2, 1, FILTER_BLOCK_LEN, FILTER_BLOCK_LEN, GRAPH_TASK(1) },
+#if NOISE_CANCELLER
+  { "canceller", graph_filter, NULL,          3, 1, FILTER_BLOCK_LEN, FILTER_BLOCK_LEN, GRAPH_TASK(2) },
+#else
+  { "filter",   graph_filter,  NULL,          1, 1, FILTER_BLOCK_LEN, FILTER_BLOCK_LEN, GRAPH_TASK(2) },
+#endif
+};
+
+//   from stage, port   to stage, port      buffer                 size
+static const dataflow_edge_t graph_edges[] =
+{
+  { GRAPH_SINE, 0,      GRAPH_DISTURB, 0,   sine_edge_buffer,      PIPELINE_RING_LEN },
+  { GRAPH_NOISE, 0,     GRAPH_DISTURB, 1,   noise_edge_buffer,     PIPELINE_RING_LEN },
+  { GRAPH_DISTURB, 0,   GRAPH_FILTER, 0,    disturbed_edge_buffer, PIPELINE_RING_LEN },
+#if NOISE_CANCELLER
+  { GRAPH_NOISE, 0,     GRAPH_FILTER, 1,    reference_edge_buffer, PIPELINE_RING_LEN },
+  { GRAPH_SINE, 0,      GRAPH_FILTER, 2,    wanted_edge_buffer,    PIPELINE_RING_LEN },
+#endif
+};
+
+static void graph_notify(uint32_t task)
+{
+  os_evt_set(0x0001, graph_tid[task]);
+}
+
+// argv: task group; Pipeline_stats.activations counts the wake-ups
+// per task group in this mode
+__task void graph_tsk(void *argv)
+{
+  U32 task = (U32)argv;
+
+  while(1)
+  {
+    os_evt_wait_and(0x0001, 0xFFFF);
+    Pipeline_stats.activations[task]++;
+    dataflow_run(&Graph, task);
+  }
+}
+
+#endif
+
+/*
+*********************************************************************
+*
+* Pipeline statistics
+*
+* Called once per second; turns the running counters into rates.
+*
+*********************************************************************
+*/
+
+static void pipeline_stats_update(void)
+{
+  static U32 last_activations;
+  static U32 last_samples;
+#if SPECTRUM_ANALYZER
+  static U32 last_frames;
+#endif
+  U32 activations = 0;
+  U32 samples = Pipeline_stats.samples;
+  U32 stage;
+
+  for (stage = 0; stage < STAGE_COUNT; stage++)
+  {
+    activations += Pipeline_stats.activations[stage];
+  }
+
+  Pipeline_stats.activations_per_sec = activations - last_activations;
+  Pipeline_stats.samples_per_sec = samples - last_samples;
+  last_activations = activations;
+  last_samples = samples;
+
+#if SPECTRUM_ANALYZER
+  Spectrum.stats.frames_per_sec = Spectrum.stats.frames - last_frames;
+  last_frames = Spectrum.stats.frames;
+#endif
+}
+
 /*
 *********************************************************************
 *
@@ -149,11 +1110,66 @@ __task void filter_tsk(void)
 
 __task void sync_tsk(void)
 {
+  U32 ticks = 0;
+#if ((PIPELINE_MODE == 3) && GRAPH_REPORT) || TASK_PROFILER || STACK_REPORT
+  U32 seconds = 0;
+#endif
+#if TASK_PROFILER && TASK_PROFILER_TRACE_LEN
+  U32 trace_dumped = 0;
+#endif
+#if EVENT_TRACE && EVENT_TRACE_DUMP_S
+  U32 trace_seconds = 0;
+#endif
+
   os_itv_set (1);
 
   while(1)
   {
+    Pipeline_stats.activations[STAGE_SYNC]++;
+    TRACE_EVENT(EVENT_TRACE_INSTANT, TRACE_SYNC, ticks);
+#if (PIPELINE_MODE == 3)
+    dataflow_release(&Graph, SAMPLES_PER_TICK);
+#elif (PIPELINE_MODE == 1)
+    pipeline_release_tick();
+#else
     os_evt_set(0x0001, sine_gen_tid);
+#endif
+    if (++ticks == SYNC_TICK_HZ)
+    {
+      pipeline_stats_update();
+      ticks = 0;
+#if ((PIPELINE_MODE == 3) && GRAPH_REPORT) || TASK_PROFILER || STACK_REPORT
+      if (++seconds == 10)
+      {
+#if (PIPELINE_MODE == 3) && GRAPH_REPORT
+        dataflow_report(&Graph);
+#endif
+#if TASK_PROFILER
+        task_profiler_report(&Task_profiler, cycle_counter_read());
+        task_profiler_reset(&Task_profiler, cycle_counter_read());
+#endif
+#if STACK_REPORT
+        stack_monitor_report(&Stack_monitor, 25);
+#endif
+        seconds = 0;
+      }
+#endif
+#if TASK_PROFILER && TASK_PROFILER_TRACE_LEN
+      if (!trace_dumped && (Task_profiler.trace_count == TASK_PROFILER_TRACE_LEN))
+      {
+        task_profiler_dump(&Task_profiler);
+        trace_dumped = 1;
+      }
+#endif
+#if EVENT_TRACE && EVENT_TRACE_DUMP_S
+      if (++trace_seconds == EVENT_TRACE_DUMP_S)
+      {
+        event_trace_stop(&Event_trace);
+        printf ("Event Trace: %u records sent\n\r",
+                (unsigned)event_trace_dump_itm(&Event_trace, EVENT_TRACE_ITM_PORT, SystemCoreClock, trace_names, TRACE_COUNT));
+      }
+#endif
+    }
     os_itv_wait ();
   }
 }
@@ -168,27 +1184,166 @@ __task void sync_tsk(void)
 
 __task void main_tsk(void)
 {
-  // compute coefficients for IIR sine generators
-  sine_generator_init_q15(&Signal_set, SIGNAL_FREQ, SAMPLING_FREQ);
-  sine_generator_init_q15(&Noise_set, NOISE_FREQ, SAMPLING_FREQ);
+  U32 i;
+
+  for (i = 0; i < STAGE_COUNT; i++)
+  {
+    saturation_stats_reset(&Saturation_stats[i]);
+  }
+  stack_monitor_init(&Stack_monitor);
+
+  // HCLK, the rate of the DWT cycle counter, as set up by SystemInit
+  SystemCoreClockUpdate();
+
+#if EVENT_TRACE
+  cycle_counter_init();
+  event_trace_init(&Event_trace, event_trace_buffer, EVENT_TRACE_LEN);
+#endif
+
+  // compute coefficients for the sine generators
+  generator_init_q15(&Signal_set, SIGNAL_FREQ, SAMPLING_FREQ);
+  generator_init_q15(&Noise_set, NOISE_FREQ, SAMPLING_FREQ);
+#if (GENERATOR_MODE == 0)
+  sine_generator_renorm_q15(&Signal_set, OSC_RENORM_PERIOD);
+  sine_generator_renorm_q15(&Noise_set, OSC_RENORM_PERIOD);
+#endif
   printf ("Sine Generator Initialised\n\r");
 
+#if DSP_BENCH
+  dsp_bench_run();
+#endif
+
   // initialize low pass filter
-  low_pass_filter_init();
+#if FILTER_DESIGN
+  if (low_pass_filter_design(SIGNAL_FREQ, NOISE_FREQ, SAMPLING_FREQ) == ARM_MATH_SUCCESS)
+    printf ("Low Pass Filter Taps Meet the Frequency Plan\n\r");
+  else
+    printf ("Low Pass Filter Design Failed, the Taps do not Meet the Frequency Plan\n\r");
+#endif
+  low_pass_filter_block_init(&Filter_set, (low_pass_filter_kind_t)FILTER_KIND, filter_state, FILTER_BLOCK_LEN);
+#if (PIPELINE_MODE == 0)
+  low_pass_filter_pingpong_init(&Filter_pingpong, &Filter_set, filter_input, filter_output);
+#elif (PIPELINE_MODE == 2)
+  block_pool_init(&Frame_pool, frame_box, sizeof(frame_box), sizeof(pipeline_frame_t));
+  os_mbx_init(noise_mbx, sizeof(noise_mbx));
+  os_mbx_init(disturb_mbx, sizeof(disturb_mbx));
+  os_mbx_init(filter_mbx, sizeof(filter_mbx));
+#elif (PIPELINE_MODE == 1)
+  spsc_ring_init(&sine_ring, sine_ring_buffer, PIPELINE_RING_LEN);
+  spsc_ring_init(&noise_ring, noise_ring_buffer, PIPELINE_RING_LEN);
+  spsc_ring_init(&disturbed_ring, disturbed_ring_buffer, PIPELINE_RING_LEN);
+#endif
   printf ("Low Pass Filter Initialised\n\r");
 
+#if NOISE_CANCELLER
+#if (PIPELINE_MODE == 0)
+  noise_canceller_init(&Canceller_set, (noise_canceller_kind_t)(NOISE_CANCELLER - 1), CANCELLER_TAPS,
+                       CANCELLER_STEP / 10000.0f, canceller_work, 1);
+#else
+#if (PIPELINE_MODE == 1)
+  spsc_ring_init(&reference_ring, reference_ring_buffer, PIPELINE_RING_LEN);
+  spsc_ring_init(&wanted_ring, wanted_ring_buffer, PIPELINE_RING_LEN);
+#endif
+  noise_canceller_init(&Canceller_set, (noise_canceller_kind_t)(NOISE_CANCELLER - 1), CANCELLER_TAPS,
+                       CANCELLER_STEP / 10000.0f, canceller_work, FILTER_BLOCK_LEN);
+#endif
+  printf ("Noise Canceller Initialised\n\r");
+#endif
+
+#if TONE_MONITOR
+  tone_monitor_init(&Disturbed_monitor, SAMPLING_FREQ * TONE_MONITOR_WINDOW_MS / 1000);
+  tone_monitor_add_bin(&Disturbed_monitor, SIGNAL_FREQ, SAMPLING_FREQ);
+  tone_monitor_add_bin(&Disturbed_monitor, NOISE_FREQ, SAMPLING_FREQ);
+  tone_monitor_init(&Filtered_monitor, SAMPLING_FREQ * TONE_MONITOR_WINDOW_MS / 1000);
+  tone_monitor_add_bin(&Filtered_monitor, SIGNAL_FREQ, SAMPLING_FREQ);
+  tone_monitor_add_bin(&Filtered_monitor, NOISE_FREQ, SAMPLING_FREQ);
+  printf ("Tone Monitor Initialised\n\r");
+#endif
+
+#if SPECTRUM_ANALYZER
+  if (spectrum_analyzer_init_q15(&Spectrum, SPECTRUM_FFT_LEN, SAMPLING_FREQ / SPECTRUM_RATE_HZ,
+                                 spectrum_work) != ARM_MATH_SUCCESS)
+  {
+    printf ("Spectrum Analyzer Rejected\n\r");
+    os_tsk_delete_self();
+  }
+#if SPECTRUM_LCD
+  spectrum_display_init(&Spectrum_display, (spectrum_display_style_t)(SPECTRUM_LCD - 1), SAMPLING_FREQ);
+#endif
+  stack_monitor_add(&Stack_monitor, "spectrum_tsk", spectrum_stack, sizeof(spectrum_stack));
+  spectrum_tsk_tid = os_tsk_create_user(spectrum_tsk, SPECTRUM_PRIORITY, spectrum_stack, sizeof(spectrum_stack));
+  printf ("spectrum_tsk Task Initialised\n\r");
+#endif
+
+#if DAC_OUTPUT
+  if (dac_output_init(&Dac_output, SAMPLING_FREQ, DAC_HALF_LEN, dac_dma_buffer, dac_ring_buffer,
+                      PIPELINE_RING_LEN) != ARM_MATH_SUCCESS)
+  {
+    printf ("DAC Output Rejected\n\r");
+    os_tsk_delete_self();
+  }
+  printf ("DAC Output Initialised\n\r");
+#endif
+
+#if (PIPELINE_MODE == 3)
+  if (dataflow_init(&Graph, graph_stages, sizeof(graph_stages) / sizeof(graph_stages[0]), graph_edges,
+                    sizeof(graph_edges) / sizeof(graph_edges[0]), graph_scratch, FILTER_BLOCK_LEN,
+                    graph_notify) != ARM_MATH_SUCCESS)
+  {
+    printf ("Dataflow Graph Rejected\n\r");
+    os_tsk_delete_self();
+  }
+  for (i = 0; i < GRAPH_TASKS; i++)
+  {
+    stack_monitor_add(&Stack_monitor, "graph_tsk", graph_stack[i], sizeof(graph_stack[i]));
+    graph_tid[i] = os_tsk_create_user_ex(graph_tsk, PIPELINE_PRIORITY, graph_stack[i], sizeof(graph_stack[i]), (void *)i);
+  }
+  printf ("graph_tsk Tasks Initialised\n\r");
+#else
   // initialize the timing system to activate the four tasks 
   // of the application program
-  filter_tsk_tid = os_tsk_create(filter_tsk, 1);
+  stack_monitor_add(&Stack_monitor, "filter_tsk", filter_tsk_stack, sizeof(filter_tsk_stack));
+  filter_tsk_tid = os_tsk_create_user(filter_tsk, PIPELINE_PRIORITY, filter_tsk_stack, sizeof(filter_tsk_stack));
   printf ("filter_tsk Task Initialised\n\r");
-  disturb_gen_tid = os_tsk_create(disturb_gen, 1);
+  stack_monitor_add(&Stack_monitor, "disturb_gen", disturb_gen_stack, sizeof(disturb_gen_stack));
+  disturb_gen_tid = os_tsk_create_user(disturb_gen, PIPELINE_PRIORITY, disturb_gen_stack, sizeof(disturb_gen_stack));
   printf ("disturb_gen Task Initialised\n\r");
-  noise_gen_tid = os_tsk_create(noise_gen, 1);
+  stack_monitor_add(&Stack_monitor, "noise_gen", noise_gen_stack, sizeof(noise_gen_stack));
+  noise_gen_tid = os_tsk_create_user(noise_gen, PIPELINE_PRIORITY, noise_gen_stack, sizeof(noise_gen_stack));
   printf ("noise_gen Task Initialised\n\r");
-  sine_gen_tid = os_tsk_create(sine_gen, 1);
+  stack_monitor_add(&Stack_monitor, "sine_gen", sine_gen_stack, sizeof(sine_gen_stack));
+  sine_gen_tid = os_tsk_create_user(sine_gen, PIPELINE_PRIORITY, sine_gen_stack, sizeof(sine_gen_stack));
   printf ("sine_gen Task Initialised\n\r");
-  sync_tsk_tid = os_tsk_create(sync_tsk, 1); 
+#endif
+  stack_monitor_add(&Stack_monitor, "sync_tsk", sync_tsk_stack, sizeof(sync_tsk_stack));
+  sync_tsk_tid = os_tsk_create_user(sync_tsk, PIPELINE_PRIORITY, sync_tsk_stack, sizeof(sync_tsk_stack));
   printf ("sync_tsk Task Initialised\n\r");
+
+#if TASK_PROFILER
+#if TASK_PROFILER_TRACE_LEN
+  task_profiler_init(&Task_profiler, SystemCoreClock, profiler_trace, TASK_PROFILER_TRACE_LEN);
+#else
+  task_profiler_init(&Task_profiler, SystemCoreClock, NULL, 0);
+#endif
+  task_profiler_name(&Task_profiler, os_tsk_self(), "main_tsk");
+  task_profiler_name(&Task_profiler, sync_tsk_tid, "sync_tsk");
+#if (PIPELINE_MODE == 3)
+  for (i = 0; i < GRAPH_TASKS; i++)
+  {
+    task_profiler_name(&Task_profiler, graph_tid[i], "graph_tsk");
+  }
+#else
+  task_profiler_name(&Task_profiler, filter_tsk_tid, "filter_tsk");
+  task_profiler_name(&Task_profiler, disturb_gen_tid, "disturb_gen");
+  task_profiler_name(&Task_profiler, noise_gen_tid, "noise_gen");
+  task_profiler_name(&Task_profiler, sine_gen_tid, "sine_gen");
+#endif
+#if SPECTRUM_ANALYZER
+  task_profiler_name(&Task_profiler, spectrum_tsk_tid, "spectrum_tsk");
+#endif
+  task_profiler_start(&Task_profiler, os_tsk_self());
+  printf ("Task Profiler Started\n\r");
+#endif
   printf ("Application Running\n\r");
 
   while(1)
@@ -0,0 +1,64 @@
+/*
+*********************************************************************
+*
+*   Block pool
+*
+*   Allocation and release go through the RTX box functions
+*   (_alloc_box / _free_box), which are safe to call from any task.
+*   The occupancy counters are updated with task switching locked, so
+*   a round robin switch between two tasks cannot lose an update.
+*
+*********************************************************************
+*/
+
+#include <rtl.h>
+
+#include "arm_math.h"
+#include "block_pool.h"
+
+void block_pool_init(block_pool_t *pool_desc, void *box, uint32_t box_size, uint32_t block_size)
+{
+  // _declare_box rounds the block to words and adds a 3 word header
+  uint32_t block_words = (block_size + 3u) / 4u;
+
+  _init_box(box, box_size, block_size);
+  pool_desc->box = box;
+  pool_desc->block_size = block_size;
+  pool_desc->stats.blocks = (box_size / 4u - 3u) / block_words;
+  pool_desc->stats.in_use = 0;
+  pool_desc->stats.high_water = 0;
+  pool_desc->stats.allocations = 0;
+  pool_desc->stats.failures = 0;
+}
+
+void *block_pool_alloc(block_pool_t *pool_desc)
+{
+  block_pool_stats_t *stats = &(pool_desc->stats);
+  void *block = _alloc_box(pool_desc->box);
+
+  tsk_lock();
+  if (block != NULL)
+  {
+    stats->allocations++;
+    if (++stats->in_use > stats->high_water)
+    {
+      stats->high_water = stats->in_use;
+    }
+  }
+  else
+  {
+    stats->failures++;
+  }
+  tsk_unlock();
+
+  return block;
+}
+
+void block_pool_free(block_pool_t *pool_desc, void *block)
+{
+  _free_box(pool_desc->box, block);
+
+  tsk_lock();
+  pool_desc->stats.in_use--;
+  tsk_unlock();
+}
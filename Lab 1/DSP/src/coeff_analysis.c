@@ -0,0 +1,689 @@
+/*
+*********************************************************************
+*
+*   Coefficient quantization analysis (host tool)
+*
+*   Takes a coefficient set in full precision, quantizes it to word
+*   lengths of 8 to 24 bits the way the CMSIS kernels store it and
+*   reports, for each word length:
+*
+*     - the response error: the largest |H_q(f) - H(f)| over the
+*       band, relative to the peak gain, in dB
+*     - biquads: the pole radii (stability margin) and how far poles
+*       and zeros moved
+*     - biquads with q15 data (up to 16 bit coefficients): the
+*       zero-input limit cycle the truncating DF1 kernel settles into
+*       after a full-scale burst, in LSB
+*     - the oscillator: the frequency error in ppm
+*
+*   and suggests the shortest word length that meets the tolerance.
+*   For FIR filters it also shows the error of shorter filters
+*   (taps trimmed from both ends) at 16 bits.
+*
+*     coeff_analysis fir <file> [tolerance]
+*     coeff_analysis biquad <file> [tolerance]
+*     coeff_analysis design lowpass|bandstop taps hamming|kaiser fs f_pass f_stop [f_stop_high f_pass_high] [tolerance]
+*     coeff_analysis table fir|biquad [tolerance]
+*     coeff_analysis sine f fs [tolerance]
+*
+*   A file holds whitespace separated numbers: FIR taps, or
+*   b0 b1 b2 a1 a2 per biquad section with the CMSIS sign convention
+*   y = b0 x0 + b1 x1 + b2 x2 + a1 y1 + a2 y2. design takes the
+*   fir_gen arguments and analyzes the float taps of the design;
+*   table analyzes the tables in low_pass_filter.c (for the biquad the
+*   q31 table is the reference, the shipped q15 table gets its own
+*   line); sine the coefficient sine_generator_init_q15 computes.
+*   Tolerance: response error in dB (default -60), for sine the
+*   frequency error in ppm (default 1000).
+*
+*   Biquad coefficients are stored halved (postShift 1) like the
+*   low_pass_filter tables; the oscillator coefficient is truncated
+*   like arm_float_to_q15 does, everything else is rounded.
+*
+*   Build (with the kernels in host/):
+*
+*     gcc -O2 -DDSP_HOST_BUILD -Ihost -Iinclude src/coeff_analysis.c src/filter_design.c
+*         src/low_pass_filter.c host/arm_math_host.c -lm -o coeff_analysis
+*
+*   The exit code is non-zero if no word length up to 24 bits meets
+*   the tolerance.
+*
+*********************************************************************
+*/
+
+#include <complex.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "arm_math.h"
+#include "filter_design.h"
+#include "low_pass_filter.h"
+
+#define ANALYSIS_MAX_COEFFS   (FILTER_DESIGN_MAX_TAPS)
+#define ANALYSIS_MAX_SECTIONS (16u)
+#define ANALYSIS_GRID         (2048u)
+#define ANALYSIS_MIN_BITS     (8u)
+#define ANALYSIS_MAX_BITS     (24u)
+#define ANALYSIS_EXACT_DB     (-400.0)   // error_db of a bit exact table
+#define ANALYSIS_CYCLE_BURST  (4096u)    // full-scale excitation before the zero input
+#define ANALYSIS_CYCLE_SETTLE (60000u)   // samples allowed to decay
+#define ANALYSIS_CYCLE_WATCH  (4096u)    // samples checked for a limit cycle
+
+extern const q15_t low_pass_filter_coeff[LOW_PASS_FILTER_TAPS];
+extern q15_t low_pass_filter_biquad_coeff_q15[6 * LOW_PASS_FILTER_BIQUAD_STAGES];
+extern q31_t low_pass_filter_biquad_coeff_q31[5 * LOW_PASS_FILTER_BIQUAD_STAGES];
+
+typedef enum
+{
+  ANALYSIS_FIR = 0,
+  ANALYSIS_BIQUAD,
+  ANALYSIS_OSCILLATOR
+} analysis_kind_t;
+
+typedef struct
+{
+  analysis_kind_t kind;
+  uint32_t len;                       // taps, or 5 * sections
+  float64_t coeff[ANALYSIS_MAX_COEFFS];
+  float64_t frequency;                // oscillator: w / (2 PI)
+  uint32_t shipped;                   // shipped[] holds a quantized table too
+  uint32_t shipped_bits;
+  float64_t shipped_coeff[ANALYSIS_MAX_COEFFS];
+} analysis_set_t;
+
+typedef struct
+{
+  float64_t error_db;                 // response error relative to the peak
+  float64_t max_radius;               // largest pole radius
+  float64_t pole_shift;               // largest pole movement
+  float64_t zero_shift;               // largest zero movement
+  float64_t frequency_ppm;            // oscillator
+  int32_t limit_cycle;                // LSB, -1: not simulated
+  uint32_t ok;
+} analysis_result_t;
+
+static analysis_set_t analysis_set;
+static float64_t analysis_quantized[ANALYSIS_MAX_COEFFS];
+static float64_t analysis_ideal_mag[ANALYSIS_GRID + 1];
+static double complex analysis_ideal[ANALYSIS_GRID + 1];
+
+/*
+*********************************************************************
+*
+*   Quantization
+*
+*   FIR taps in q(bits-1), biquad coefficients halved in q(bits-1)
+*   and read back as the value the kernel really multiplies with.
+*
+*********************************************************************
+*/
+
+static float64_t analysis_quantize(float64_t value, uint32_t bits, float64_t scale, uint32_t truncate)
+{
+  float64_t full = ldexp(1.0, (int)bits - 1);
+  float64_t q = value / scale * full;
+
+  q = truncate ? trunc(q) : floor(q + 0.5);
+  if (q > full - 1.0)
+  {
+    q = full - 1.0;
+  }
+  if (q < -full)
+  {
+    q = -full;
+  }
+  return q / full * scale;
+}
+
+static void analysis_quantize_set(const analysis_set_t *set, uint32_t bits, float64_t *quantized)
+{
+  uint32_t k;
+
+  for (k = 0; k < set->len; k++)
+  {
+    switch (set->kind)
+    {
+      case ANALYSIS_FIR:
+        quantized[k] = analysis_quantize(set->coeff[k], bits, 1.0, 0);
+        break;
+      case ANALYSIS_BIQUAD:
+        quantized[k] = analysis_quantize(set->coeff[k], bits, 2.0, 0);
+        break;
+      default:
+        quantized[k] = analysis_quantize(set->coeff[k], bits, 2.0, 1);
+        break;
+    }
+  }
+}
+
+/*
+*********************************************************************
+*
+*   Frequency response, f normalized to the sampling frequency
+*
+*********************************************************************
+*/
+
+static double complex analysis_response(analysis_kind_t kind, const float64_t *coeff, uint32_t len, float64_t f)
+{
+  double complex z1 = cexp(-2.0 * PI * I * f);
+  double complex z2 = z1 * z1;
+  double complex h = 1.0, zk = 1.0;
+  uint32_t k;
+
+  if (kind == ANALYSIS_FIR)
+  {
+    h = 0.0;
+    for (k = 0; k < len; k++, zk *= z1)
+    {
+      h += coeff[k] * zk;
+    }
+    return h;
+  }
+
+  for (k = 0; k + 5 <= len; k += 5)
+  {
+    h *= (coeff[k] + coeff[k + 1] * z1 + coeff[k + 2] * z2) / (1.0 - coeff[k + 3] * z1 - coeff[k + 4] * z2);
+  }
+  return h;
+}
+
+static void analysis_reference(const analysis_set_t *set)
+{
+  uint32_t n;
+
+  for (n = 0; n <= ANALYSIS_GRID; n++)
+  {
+    analysis_ideal[n] = analysis_response(set->kind, set->coeff, set->len, 0.5 * n / ANALYSIS_GRID);
+    analysis_ideal_mag[n] = cabs(analysis_ideal[n]);
+  }
+}
+
+static float64_t analysis_error_db(const analysis_set_t *set, const float64_t *coeff, uint32_t len)
+{
+  float64_t peak = 0.0, error = 0.0, e;
+  uint32_t n;
+
+  for (n = 0; n <= ANALYSIS_GRID; n++)
+  {
+    if (analysis_ideal_mag[n] > peak)
+    {
+      peak = analysis_ideal_mag[n];
+    }
+    e = cabs(analysis_response(set->kind, coeff, len, 0.5 * n / ANALYSIS_GRID) - analysis_ideal[n]);
+    if (e > error)
+    {
+      error = e;
+    }
+  }
+  return (error > 0.0) ? 20.0 * log10(error / peak) : ANALYSIS_EXACT_DB;
+}
+
+/*
+*********************************************************************
+*
+*   Poles and zeros of a biquad section
+*
+*   Roots of z^2 - a1 z - a2 (poles) and b0 z^2 + b1 z + b2 (zeros).
+*
+*********************************************************************
+*/
+
+static void analysis_roots(float64_t a, float64_t b, float64_t c, double complex *root)
+{
+  double complex d;
+
+  if (a == 0.0)
+  {
+    root[0] = (b != 0.0) ? -c / b : 0.0;
+    root[1] = 0.0;
+    return;
+  }
+  d = csqrt((double complex)(b * b - 4.0 * a * c));
+  root[0] = (-b + d) / (2.0 * a);
+  root[1] = (-b - d) / (2.0 * a);
+}
+
+// largest distance of a root to the nearest root of the reference
+static float64_t analysis_root_shift(const double complex *root, const double complex *reference)
+{
+  float64_t straight = fmax(cabs(root[0] - reference[0]), cabs(root[1] - reference[1]));
+  float64_t crossed = fmax(cabs(root[0] - reference[1]), cabs(root[1] - reference[0]));
+
+  return fmin(straight, crossed);
+}
+
+static void analysis_poles_zeros(const analysis_set_t *set, const float64_t *coeff, analysis_result_t *result)
+{
+  double complex pole[2], zero[2], pole_ref[2], zero_ref[2];
+  uint32_t k, r;
+
+  result->max_radius = 0.0;
+  result->pole_shift = 0.0;
+  result->zero_shift = 0.0;
+  for (k = 0; k + 5 <= set->len; k += 5)
+  {
+    analysis_roots(1.0, -coeff[k + 3], -coeff[k + 4], pole);
+    analysis_roots(coeff[k], coeff[k + 1], coeff[k + 2], zero);
+    analysis_roots(1.0, -set->coeff[k + 3], -set->coeff[k + 4], pole_ref);
+    analysis_roots(set->coeff[k], set->coeff[k + 1], set->coeff[k + 2], zero_ref);
+    for (r = 0; r < 2; r++)
+    {
+      result->max_radius = fmax(result->max_radius, cabs(pole[r]));
+    }
+    result->pole_shift = fmax(result->pole_shift, analysis_root_shift(pole, pole_ref));
+    result->zero_shift = fmax(result->zero_shift, analysis_root_shift(zero, zero_ref));
+  }
+}
+
+/*
+*********************************************************************
+*
+*   Limit cycles
+*
+*   The q15 DF1 kernel with coefficients of bits bits: products of
+*   q15 samples and halved coefficients summed in 64 bits, shifted
+*   right by bits - 2 (truncation, like arm_biquad_cascade_df1_q15
+*   with postShift 1) and saturated. A full-scale two-tone burst
+*   excites the cascade, then the input is zero; whatever is still
+*   moving after ANALYSIS_CYCLE_SETTLE samples is a limit cycle.
+*   The result is the peak output in LSB (0: settles to zero).
+*
+*********************************************************************
+*/
+
+static int32_t analysis_limit_cycle(const float64_t *coeff, uint32_t len, uint32_t bits)
+{
+  q63_t c[5 * ANALYSIS_MAX_SECTIONS];
+  q31_t state[4 * ANALYSIS_MAX_SECTIONS];
+  q31_t x, y, peak = 0;
+  q63_t acc;
+  uint32_t n, k, s;
+  float64_t full = ldexp(1.0, (int)bits - 1);
+
+  for (k = 0; k < len; k++)
+  {
+    c[k] = (q63_t)floor(coeff[k] / 2.0 * full + 0.5);
+  }
+  memset(state, 0, sizeof(state));
+
+  for (n = 0; n < ANALYSIS_CYCLE_BURST + ANALYSIS_CYCLE_SETTLE + ANALYSIS_CYCLE_WATCH; n++)
+  {
+    x = 0;
+    if (n < ANALYSIS_CYCLE_BURST)
+    {
+      x = (q31_t)(16000.0 * (sin(0.0123 * n) + sin(0.731 * n)));
+    }
+    for (s = 0, k = 0; k + 5 <= len; s += 4, k += 5)
+    {
+      acc = c[k] * x + c[k + 1] * state[s] + c[k + 2] * state[s + 1] + c[k + 3] * state[s + 2] + c[k + 4] * state[s + 3];
+      y = __SSAT((q31_t)(acc >> (bits - 2)), 16);
+      state[s + 1] = state[s];
+      state[s] = x;
+      state[s + 3] = state[s + 2];
+      state[s + 2] = y;
+      x = y;
+    }
+    if ((n >= ANALYSIS_CYCLE_BURST + ANALYSIS_CYCLE_SETTLE) && (abs(x) > peak))
+    {
+      peak = abs(x);
+    }
+  }
+  return peak;
+}
+
+/*
+*********************************************************************
+*
+*   One word length
+*
+*********************************************************************
+*/
+
+static void analysis_evaluate(const analysis_set_t *set, const float64_t *coeff, uint32_t bits, float64_t tolerance,
+                              analysis_result_t *result)
+{
+  float64_t w;
+
+  memset(result, 0, sizeof(*result));
+  result->limit_cycle = -1;
+
+  if (set->kind == ANALYSIS_OSCILLATOR)
+  {
+    // y = a1 y1 + a2 y2 with a2 = -1: w = acos(a1 / 2)
+    w = acos(fmax(-1.0, fmin(1.0, coeff[3] / 2.0)));
+    result->max_radius = sqrt(-coeff[4]);
+    result->frequency_ppm = 1e6 * (w / (2.0 * PI * set->frequency) - 1.0);
+    result->ok = (fabs(result->frequency_ppm) <= tolerance) && (result->max_radius == 1.0);
+    return;
+  }
+
+  result->error_db = analysis_error_db(set, coeff, set->len);
+  result->ok = (result->error_db <= tolerance);
+  if (set->kind == ANALYSIS_BIQUAD)
+  {
+    analysis_poles_zeros(set, coeff, result);
+    result->ok = result->ok && (result->max_radius < 1.0);
+    if (bits <= 16)
+    {
+      result->limit_cycle = analysis_limit_cycle(coeff, set->len, bits);
+    }
+  }
+}
+
+static void analysis_print(const char *label, const analysis_set_t *set, const analysis_result_t *result)
+{
+  printf("%-8s", label);
+  if (set->kind == ANALYSIS_OSCILLATOR)
+  {
+    printf("  %+12.1f ppm  radius %.9f", result->frequency_ppm, result->max_radius);
+  }
+  else
+  {
+    if (result->error_db > ANALYSIS_EXACT_DB)
+    {
+      printf("  %8.1f dB", result->error_db);
+    }
+    else
+    {
+      printf("        exact");
+    }
+  }
+  if (set->kind == ANALYSIS_BIQUAD)
+  {
+    printf("  %.6f  %9.2e  %9.2e", result->max_radius, result->pole_shift, result->zero_shift);
+    if (result->limit_cycle >= 0)
+    {
+      printf("  %5d LSB", (int)result->limit_cycle);
+    }
+    else
+    {
+      printf("          -");
+    }
+  }
+  printf("%s\n", result->ok ? "" : "  *");
+}
+
+/*
+*********************************************************************
+*
+*   Inputs
+*
+*********************************************************************
+*/
+
+static int analysis_read_file(const char *name, analysis_set_t *set)
+{
+  FILE *file = fopen(name, "r");
+  double value;
+
+  if (file == NULL)
+  {
+    fprintf(stderr, "cannot open %s\n", name);
+    return 1;
+  }
+  set->len = 0;
+  while ((set->len < ANALYSIS_MAX_COEFFS) && (fscanf(file, "%lf", &value) == 1))
+  {
+    set->coeff[set->len++] = value;
+  }
+  fclose(file);
+  return 0;
+}
+
+static int analysis_design(int argc, char *argv[], analysis_set_t *set)
+{
+  static float32_t taps[FILTER_DESIGN_MAX_TAPS];
+  filter_design_spec_t spec;
+  float32_t fs;
+  uint32_t k;
+
+  memset(&spec, 0, sizeof(spec));
+  spec.type = (strcmp(argv[0], "bandstop") == 0) ? FILTER_DESIGN_BAND_STOP : FILTER_DESIGN_LOW_PASS;
+  spec.num_taps = (uint32_t)atoi(argv[1]);
+  spec.window = (strcmp(argv[2], "kaiser") == 0) ? FILTER_DESIGN_KAISER : FILTER_DESIGN_HAMMING;
+  fs = (float32_t)atof(argv[3]);
+  spec.pass_edge = (float32_t)atof(argv[4]) / fs;
+  spec.stop_edge = (float32_t)atof(argv[5]) / fs;
+  if (spec.type == FILTER_DESIGN_BAND_STOP)
+  {
+    if (argc < 8)
+    {
+      return 1;
+    }
+    spec.stop_edge_high = (float32_t)atof(argv[6]) / fs;
+    spec.pass_edge_high = (float32_t)atof(argv[7]) / fs;
+  }
+  if (filter_design_fir_f32(&spec, taps) != ARM_MATH_SUCCESS)
+  {
+    fprintf(stderr, "invalid filter specification\n");
+    return 1;
+  }
+  set->kind = ANALYSIS_FIR;
+  set->len = spec.num_taps;
+  for (k = 0; k < set->len; k++)
+  {
+    set->coeff[k] = taps[k];
+  }
+  return 0;
+}
+
+static void analysis_table(int biquad, analysis_set_t *set)
+{
+  uint32_t k, s;
+
+  if (!biquad)
+  {
+    set->kind = ANALYSIS_FIR;
+    set->len = LOW_PASS_FILTER_TAPS;
+    for (k = 0; k < set->len; k++)
+    {
+      set->coeff[k] = low_pass_filter_coeff[k] / 32768.0;
+    }
+    return;
+  }
+
+  // reference: the q31 table; the shipped q15 table for comparison
+  set->kind = ANALYSIS_BIQUAD;
+  set->len = 5 * LOW_PASS_FILTER_BIQUAD_STAGES;
+  set->shipped = 1;
+  set->shipped_bits = 16;
+  for (s = 0; s < LOW_PASS_FILTER_BIQUAD_STAGES; s++)
+  {
+    for (k = 0; k < 5; k++)
+    {
+      set->coeff[5 * s + k] = low_pass_filter_biquad_coeff_q31[5 * s + k] / 1073741824.0;
+    }
+    set->shipped_coeff[5 * s + 0] = low_pass_filter_biquad_coeff_q15[6 * s + 0] / 16384.0;
+    set->shipped_coeff[5 * s + 1] = low_pass_filter_biquad_coeff_q15[6 * s + 2] / 16384.0;
+    set->shipped_coeff[5 * s + 2] = low_pass_filter_biquad_coeff_q15[6 * s + 3] / 16384.0;
+    set->shipped_coeff[5 * s + 3] = low_pass_filter_biquad_coeff_q15[6 * s + 4] / 16384.0;
+    set->shipped_coeff[5 * s + 4] = low_pass_filter_biquad_coeff_q15[6 * s + 5] / 16384.0;
+  }
+}
+
+// the biquad sine_generator_init_q15 builds: a1 = 2 cos(w), a2 = -1
+static void analysis_sine(float64_t frequency, float64_t sampling_frequency, analysis_set_t *set)
+{
+  set->kind = ANALYSIS_OSCILLATOR;
+  set->len = 5;
+  set->frequency = frequency / sampling_frequency;
+  set->coeff[0] = 0.0;
+  set->coeff[1] = 0.0;
+  set->coeff[2] = 0.0;
+  set->coeff[3] = 2.0 * cos(2.0 * PI * set->frequency);
+  set->coeff[4] = -1.0;
+}
+
+/*
+*********************************************************************
+*
+*   Report
+*
+*********************************************************************
+*/
+
+// Trimmed taps stay at their positions (zeroed), so the delay matches
+// the reference; the rest is rescaled to the original DC gain.
+static void analysis_trim(const analysis_set_t *set, float64_t tolerance)
+{
+  static analysis_set_t trimmed;
+  float64_t sum = 0.0, kept, error;
+  uint32_t trim, k;
+
+  for (k = 0; k < set->len; k++)
+  {
+    sum += set->coeff[k];
+  }
+
+  printf("\nshorter filters at 16 bit (taps removed from both ends, DC gain kept):\n");
+  printf("taps       error\n");
+  for (trim = 1; 2 * trim + 4 <= set->len; trim++)
+  {
+    trimmed = *set;
+    kept = 0.0;
+    for (k = 0; k < set->len; k++)
+    {
+      if ((k < trim) || (k >= set->len - trim))
+      {
+        trimmed.coeff[k] = 0.0;
+      }
+      kept += trimmed.coeff[k];
+    }
+    for (k = 0; (kept != 0.0) && (k < set->len); k++)
+    {
+      trimmed.coeff[k] *= sum / kept;
+    }
+    analysis_quantize_set(&trimmed, 16, analysis_quantized);
+    error = analysis_error_db(set, analysis_quantized, set->len);
+    printf("%4u  %9.1f dB%s\n", (unsigned)(set->len - 2 * trim), error, (error <= tolerance) ? "" : "  *");
+    if (error > tolerance + 40.0)
+    {
+      break;
+    }
+  }
+}
+
+static void usage(const char *name)
+{
+  fprintf(stderr, "usage: %s fir|biquad <file> [tolerance]\n", name);
+  fprintf(stderr, "       %s design lowpass|bandstop taps hamming|kaiser fs f_pass f_stop [f_stop_high f_pass_high] [tolerance]\n", name);
+  fprintf(stderr, "       %s table fir|biquad [tolerance]\n", name);
+  fprintf(stderr, "       %s sine f fs [tolerance]\n", name);
+}
+
+int main(int argc, char *argv[])
+{
+  analysis_set_t *set = &analysis_set;
+  analysis_result_t result;
+  const char *tolerance_arg = NULL;
+  float64_t tolerance;
+  uint32_t bits, minimum = 0;
+  char label[16];
+  int next;
+
+  if (argc < 3)
+  {
+    usage(argv[0]);
+    return 2;
+  }
+
+  if ((strcmp(argv[1], "fir") == 0) || (strcmp(argv[1], "biquad") == 0))
+  {
+    set->kind = (argv[1][0] == 'f') ? ANALYSIS_FIR : ANALYSIS_BIQUAD;
+    if (analysis_read_file(argv[2], set))
+    {
+      return 2;
+    }
+    tolerance_arg = (argc > 3) ? argv[3] : NULL;
+  }
+  else if ((strcmp(argv[1], "design") == 0) && (argc >= 8))
+  {
+    if (analysis_design(argc - 2, &argv[2], set))
+    {
+      usage(argv[0]);
+      return 2;
+    }
+    next = (strcmp(argv[2], "bandstop") == 0) ? 10 : 8;
+    tolerance_arg = (argc > next) ? argv[next] : NULL;
+  }
+  else if (strcmp(argv[1], "table") == 0)
+  {
+    analysis_table(strcmp(argv[2], "biquad") == 0, set);
+    tolerance_arg = (argc > 3) ? argv[3] : NULL;
+  }
+  else if ((strcmp(argv[1], "sine") == 0) && (argc >= 4))
+  {
+    analysis_sine(atof(argv[2]), atof(argv[3]), set);
+    tolerance_arg = (argc > 4) ? argv[4] : NULL;
+  }
+  else
+  {
+    usage(argv[0]);
+    return 2;
+  }
+
+  if ((set->len == 0) || ((set->kind == ANALYSIS_BIQUAD) &&
+                          ((set->len % 5) || (set->len > 5 * ANALYSIS_MAX_SECTIONS))))
+  {
+    fprintf(stderr, "%s: expected FIR taps or 5 coefficients per biquad section\n", argv[0]);
+    return 2;
+  }
+  tolerance = tolerance_arg ? atof(tolerance_arg) : ((set->kind == ANALYSIS_OSCILLATOR) ? 1000.0 : -60.0);
+
+  analysis_reference(set);
+
+  switch (set->kind)
+  {
+    case ANALYSIS_FIR:
+      printf("FIR, %u taps, tolerance %.1f dB\n", (unsigned)set->len, tolerance);
+      printf("bits       error\n");
+      break;
+    case ANALYSIS_BIQUAD:
+      printf("biquad cascade, %u sections, tolerance %.1f dB\n", (unsigned)(set->len / 5), tolerance);
+      printf("bits       error  radius    pole shift zero shift  limit cycle (q15 data)\n");
+      break;
+    default:
+      printf("oscillator, f = %.6f fs, tolerance %.1f ppm\n", set->frequency, tolerance);
+      printf("bits      frequency error\n");
+      break;
+  }
+
+  for (bits = ANALYSIS_MIN_BITS; bits <= ANALYSIS_MAX_BITS; bits++)
+  {
+    analysis_quantize_set(set, bits, analysis_quantized);
+    analysis_evaluate(set, analysis_quantized, bits, tolerance, &result);
+    sprintf(label, "%u", (unsigned)bits);
+    analysis_print(label, set, &result);
+    if (result.ok && (minimum == 0))
+    {
+      minimum = bits;
+    }
+    if (!result.ok)
+    {
+      minimum = 0;
+    }
+  }
+  if (set->shipped)
+  {
+    analysis_evaluate(set, set->shipped_coeff, set->shipped_bits, tolerance, &result);
+    analysis_print("shipped", set, &result);
+  }
+  printf("(* outside the tolerance%s)\n", (set->kind == ANALYSIS_BIQUAD) ? " or unstable" : "");
+
+  if (set->kind == ANALYSIS_FIR)
+  {
+    analysis_trim(set, tolerance);
+  }
+
+  if (minimum == 0)
+  {
+    printf("\nno word length up to %u bits meets the tolerance\n", (unsigned)ANALYSIS_MAX_BITS);
+    return 1;
+  }
+  printf("\nminimum word length: %u bits%s\n", (unsigned)minimum,
+         (minimum <= 16) ? " (q15 is enough)" : " (needs q31)");
+  return 0;
+}
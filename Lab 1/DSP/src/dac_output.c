@@ -0,0 +1,407 @@
+/*
+*********************************************************************
+*
+*   DAC output
+*
+*   Plays a q15 stream on the DAC without touching every sample in
+*   software. TIM6 produces a trigger at the sampling frequency, each
+*   trigger moves the DAC holding register to the output and requests
+*   the next code from DMA1 stream 5, which runs over a circular
+*   buffer of two halves. When the DMA leaves one half (half transfer
+*   and transfer complete interrupts) that half is refilled from the
+*   ring the filter task writes into, while the other one plays. The
+*   output timing therefore only depends on the timer, the filter may
+*   deliver in bursts (one tick worth at a time). The DAC starts with
+*   one half in the ring on top of the two in the DMA buffer, so
+*   bursts plus scheduling delay of up to half_len samples never let
+*   the ring run dry; if it does, the missing samples repeat the last
+*   value and are counted in stats.
+*
+*   q15 maps to the 12 bit left aligned holding register by flipping
+*   the sign bit (offset binary): -1.0 is 0 V, 0 is mid scale.
+*
+*   Compiled on a PC with DAC_OUTPUT_SINK and DSP_HOST_BUILD defined
+*   the file is a host sink for testing (see the end of the file): the
+*   signal chain writes into the ring in ticks as on the target, the
+*   DMA and its interrupts are simulated on an exact clock, and every
+*   sample that would reach the DAC is recorded with its timestamp:
+*
+*     gcc -O2 -ffp-contract=off -DDSP_HOST_BUILD -DDAC_OUTPUT_SINK
+*         -Ihost -Iinclude src/dac_output.c src/spsc_ring.c
+*         src/signal_chain.c src/sine_generator.c src/low_pass_filter.c
+*         src/filter_design.c src/noise_canceller.c src/saturation.c
+*         host/arm_math_host.c -o dac_sink -lm
+*
+*********************************************************************
+*/
+
+#include "arm_math.h"
+#include "spsc_ring.h"
+#include "dac_output.h"
+
+#ifndef DSP_HOST_BUILD
+
+#include "stm32f4xx.h"
+
+static dac_output_t *dac_output_active;
+
+static void dac_output_hw_init(dac_output_t *dac_desc)
+{
+  uint32_t timer_clock, ticks, prescaler, ppre1;
+
+  dac_output_active = dac_desc;
+
+  RCC->AHB1ENR |= RCC_AHB1ENR_GPIOAEN | RCC_AHB1ENR_DMA1EN;
+  RCC->APB1ENR |= RCC_APB1ENR_DACEN | RCC_APB1ENR_TIM6EN;
+
+  // PA4 analog
+  GPIOA->MODER |= GPIO_MODER_MODER4;
+
+  // TIM6 update as trigger output; the APB1 timer clock is twice
+  // PCLK1 when APB1 is divided
+  SystemCoreClockUpdate();
+  ppre1 = (RCC->CFGR & RCC_CFGR_PPRE1) >> 10;
+  timer_clock = (ppre1 < 4u) ? SystemCoreClock : SystemCoreClock >> (ppre1 - 4u);
+  ticks = timer_clock / dac_desc->sampling_frequency;
+  prescaler = (ticks - 1u) / 65536u;
+  TIM6->CR1 = 0;
+  TIM6->PSC = (uint16_t)prescaler;
+  TIM6->ARR = (uint16_t)(ticks / (prescaler + 1u) - 1u);
+  TIM6->CR2 = TIM_CR2_MMS_1;
+
+  // channel 1, TSEL1 = 0 (TIM6 TRGO), one DMA request per trigger
+  DAC->DHR12L1 = dac_desc->hold;
+  DAC->CR = DAC_CR_EN1 | DAC_CR_TEN1 | DAC_CR_DMAEN1;
+
+  // DMA1 stream 5 channel 7: memory to DAC, 16 bit, circular
+  DMA1_Stream5->CR = 0;
+  while (DMA1_Stream5->CR & DMA_SxCR_EN);
+  DMA1->HIFCR = DMA_HIFCR_CTCIF5 | DMA_HIFCR_CHTIF5 | DMA_HIFCR_CTEIF5 | DMA_HIFCR_CDMEIF5 | DMA_HIFCR_CFEIF5;
+  DMA1_Stream5->PAR = (uint32_t)&(DAC->DHR12L1);
+  DMA1_Stream5->M0AR = (uint32_t)dac_desc->dma_buffer;
+  DMA1_Stream5->NDTR = 2u * dac_desc->half_len;
+  DMA1_Stream5->CR = (7u * DMA_SxCR_CHSEL_0) | DMA_SxCR_MSIZE_0 | DMA_SxCR_PSIZE_0 | DMA_SxCR_MINC |
+                     DMA_SxCR_CIRC | DMA_SxCR_DIR_0 | DMA_SxCR_HTIE | DMA_SxCR_TCIE;
+  NVIC_EnableIRQ(DMA1_Stream5_IRQn);
+}
+
+static void dac_output_hw_start(void)
+{
+  DMA1_Stream5->CR |= DMA_SxCR_EN;
+  TIM6->CR1 |= TIM_CR1_CEN;
+}
+
+void DMA1_Stream5_IRQHandler(void)
+{
+  uint32_t status = DMA1->HISR & (DMA_HISR_HTIF5 | DMA_HISR_TCIF5);
+
+  DMA1->HIFCR = status;
+  if (status & DMA_HISR_HTIF5)
+  {
+    dac_output_refill(dac_output_active, 0);
+  }
+  if (status & DMA_HISR_TCIF5)
+  {
+    dac_output_refill(dac_output_active, 1);
+  }
+}
+
+#else
+
+// the host sink drives dac_output_refill itself
+static void dac_output_hw_init(dac_output_t *dac_desc)
+{
+  (void)dac_desc;
+}
+
+static void dac_output_hw_start(void)
+{
+}
+
+#endif
+
+arm_status dac_output_init(dac_output_t *dac_desc, uint32_t sampling_frequency, uint32_t half_len,
+                           uint16_t *dma_buffer, q15_t *ring_buffer, uint32_t ring_size)
+{
+  uint32_t n;
+
+  if ((sampling_frequency == 0) || (half_len < DAC_OUTPUT_MIN_HALF) || (half_len > 32768u) ||
+      ((ring_size & (ring_size - 1u)) != 0) || (ring_size < 3u * half_len))
+  {
+    return ARM_MATH_ARGUMENT_ERROR;
+  }
+
+  dac_desc->sampling_frequency = sampling_frequency;
+  dac_desc->half_len = half_len;
+  dac_desc->dma_buffer = dma_buffer;
+  dac_desc->hold = 0x8000u;
+  dac_desc->running = 0;
+  dac_desc->stats.halves = 0;
+  dac_desc->stats.underruns = 0;
+  dac_desc->stats.missing = 0;
+  dac_desc->stats.min_fill = ring_size;
+  spsc_ring_init(&(dac_desc->ring), ring_buffer, ring_size);
+
+  for (n = 0; n < 2u * half_len; n++)
+  {
+    dma_buffer[n] = dac_desc->hold;
+  }
+
+  dac_output_hw_init(dac_desc);
+  return ARM_MATH_SUCCESS;
+}
+
+uint32_t dac_output_write(dac_output_t *dac_desc, q15_t *samples, uint32_t len)
+{
+  if (spsc_ring_push(&(dac_desc->ring), samples, len) == 0)
+  {
+    return 0;
+  }
+
+  // prime both halves before the first trigger and keep a third in
+  // the ring, the cushion for a producer that delivers in bursts
+  if (!dac_desc->running && (spsc_ring_count(&(dac_desc->ring)) >= 3u * dac_desc->half_len))
+  {
+    dac_output_refill(dac_desc, 0);
+    dac_output_refill(dac_desc, 1);
+    dac_desc->running = 1;
+    dac_output_hw_start();
+  }
+  return len;
+}
+
+void dac_output_refill(dac_output_t *dac_desc, uint32_t half)
+{
+  uint32_t len = dac_desc->half_len;
+  uint16_t *code = &(dac_desc->dma_buffer[half * len]);
+  uint32_t fill = spsc_ring_count(&(dac_desc->ring));
+  uint32_t available = (fill < len) ? fill : len;
+  uint32_t n;
+
+  if (fill < dac_desc->stats.min_fill)
+  {
+    dac_desc->stats.min_fill = fill;
+  }
+
+  // pop straight into the DMA half, then convert in place
+  spsc_ring_pop(&(dac_desc->ring), (q15_t *)code, available);
+  for (n = 0; n < available; n++)
+  {
+    code[n] ^= 0x8000u;
+  }
+  if (available > 0)
+  {
+    dac_desc->hold = code[available - 1u];
+  }
+  if (available < len)
+  {
+    for (n = available; n < len; n++)
+    {
+      code[n] = dac_desc->hold;
+    }
+    dac_desc->stats.underruns++;
+    dac_desc->stats.missing += len - available;
+  }
+  dac_desc->stats.halves++;
+}
+
+#ifdef DAC_OUTPUT_SINK
+
+/*
+*********************************************************************
+*
+*   Host sink
+*
+*   dac_sink <file> [seconds] [option=value ...]
+*
+*   Options: fs (Hz), tick (producer rate, Hz), block (filter block
+*   length), half (DMA half buffer), ring (ring size) and jitter (the
+*   producer runs up to this many us late, pseudo random, per tick);
+*   defaults as in DirtyFilter.c. The producer writes fs / tick samples
+*   of the filtered stream every tick, the simulated DMA plays them at
+*   exactly 1 / fs. Every sample leaving the DMA buffer is written to
+*   the file as a text line
+*
+*     time_ns code
+*
+*   (time since the DAC started, 12 bit code). The sink checks the
+*   output against the filtered stream and reports underruns, the
+*   lowest ring fill and the latency from the producer tick to the
+*   DAC; the exit code is non-zero if a sample was lost or wrong.
+*
+*********************************************************************
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "sine_generator.h"
+#include "low_pass_filter.h"
+#include "noise_canceller.h"
+#include "saturation.h"
+#include "signal_chain.h"
+
+#define SINK_MAX_RING (65536u)
+
+static signal_chain_q15_t sink_chain;
+static dac_output_t sink_dac;
+static q15_t sink_ring[SINK_MAX_RING];
+static uint16_t sink_dma[SINK_MAX_RING];
+
+typedef struct
+{
+  FILE *file;
+  q15_t *expected;                // filtered stream as produced
+  float64_t *produced_at;         // tick time of every produced sample, ns
+  uint32_t produced;
+  uint32_t played;
+  uint32_t wrong;
+  float64_t start;                // DAC start, ns
+  float64_t min_latency;
+  float64_t max_latency;
+} sink_state_t;
+
+// the half just left by the DMA: record what was played, then refill
+static void sink_half_done(sink_state_t *sink, uint32_t half)
+{
+  const uint16_t *code = &(sink_dac.dma_buffer[half * sink_dac.half_len]);
+  float64_t period = 1e9 / (float64_t)sink_dac.sampling_frequency;
+  float64_t time, latency;
+  uint32_t n;
+
+  for (n = 0; n < sink_dac.half_len; n++, sink->played++)
+  {
+    time = (float64_t)sink->played * period;
+    fprintf(sink->file, "%.0f %u\n", time, (unsigned)(code[n] >> 4));
+    if ((sink->played >= sink->produced) || ((q15_t)(code[n] ^ 0x8000u) != sink->expected[sink->played]))
+    {
+      sink->wrong++;
+      continue;
+    }
+    latency = sink->start + time - sink->produced_at[sink->played];
+    sink->min_latency = (latency < sink->min_latency) ? latency : sink->min_latency;
+    sink->max_latency = (latency > sink->max_latency) ? latency : sink->max_latency;
+  }
+  dac_output_refill(&sink_dac, half);
+}
+
+int main(int argc, char **argv)
+{
+  static q15_t sine[LOW_PASS_FILTER_MAX_BLOCK], noise[LOW_PASS_FILTER_MAX_BLOCK];
+  static q15_t disturbed[LOW_PASS_FILTER_MAX_BLOCK], filtered[LOW_PASS_FILTER_MAX_BLOCK];
+  signal_chain_config_t config;
+  sink_state_t sink;
+  uint32_t seconds = 10, tick = 100, half = 32, ring = 1024, jitter = 0;
+  uint32_t random = 12345u, halves_done = 0, started = 0;
+  uint32_t total, per_tick, k, len, done, n;
+  float64_t tick_time, next_half;
+  const char *value;
+  int argi;
+
+  if (argc < 2)
+  {
+    fprintf(stderr, "usage: dac_sink <file> [seconds] [fs|tick|block|half|ring|jitter=value ...]\n");
+    return 2;
+  }
+
+  signal_chain_default_config(&config);
+  for (argi = 2; argi < argc; argi++)
+  {
+    value = strchr(argv[argi], '=');
+    if (value == NULL)
+      seconds = (uint32_t)strtoul(argv[argi], NULL, 0);
+    else if (strncmp(argv[argi], "fs=", 3) == 0)
+      config.sampling_frequency = (uint32_t)strtoul(value + 1, NULL, 0);
+    else if (strncmp(argv[argi], "tick=", 5) == 0)
+      tick = (uint32_t)strtoul(value + 1, NULL, 0);
+    else if (strncmp(argv[argi], "block=", 6) == 0)
+      config.block_len = (uint32_t)strtoul(value + 1, NULL, 0);
+    else if (strncmp(argv[argi], "half=", 5) == 0)
+      half = (uint32_t)strtoul(value + 1, NULL, 0);
+    else if (strncmp(argv[argi], "ring=", 5) == 0)
+      ring = (uint32_t)strtoul(value + 1, NULL, 0);
+    else if (strncmp(argv[argi], "jitter=", 7) == 0)
+      jitter = (uint32_t)strtoul(value + 1, NULL, 0);
+    else
+    {
+      fprintf(stderr, "unknown option %s\n", argv[argi]);
+      return 2;
+    }
+  }
+
+  if ((tick == 0) || (config.sampling_frequency % tick != 0) || (ring > SINK_MAX_RING) ||
+      (jitter >= 1000000u / tick) || (signal_chain_init(&sink_chain, &config) != ARM_MATH_SUCCESS) ||
+      (dac_output_init(&sink_dac, config.sampling_frequency, half, sink_dma, sink_ring, ring) != ARM_MATH_SUCCESS))
+  {
+    fprintf(stderr, "invalid configuration\n");
+    return 2;
+  }
+
+  per_tick = config.sampling_frequency / tick;
+  total = seconds * config.sampling_frequency;
+  memset(&sink, 0, sizeof(sink));
+  sink.expected = malloc(total * sizeof(q15_t));
+  sink.produced_at = malloc(total * sizeof(float64_t));
+  sink.file = fopen(argv[1], "w");
+  if ((sink.expected == NULL) || (sink.produced_at == NULL) || (sink.file == NULL))
+  {
+    fprintf(stderr, "cannot create %s\n", argv[1]);
+    return 2;
+  }
+  sink.min_latency = 1e18;
+
+  // events in time order: DMA half completions before a producer
+  // tick at the same time (the interrupt preempts the task)
+  for (k = 0; sink.produced < total; k++)
+  {
+    random = random * 1103515245u + 12345u;
+    tick_time = (float64_t)k * 1e9 / (float64_t)tick + (float64_t)((random >> 8) % (jitter + 1u)) * 1e3;
+
+    while (sink_dac.running)
+    {
+      next_half = sink.start + (float64_t)(halves_done + 1u) * (float64_t)half * 1e9 /
+                  (float64_t)config.sampling_frequency;
+      if (next_half > tick_time)
+        break;
+      sink_half_done(&sink, halves_done & 1u);
+      halves_done++;
+    }
+
+    for (done = 0; (done < per_tick) && (sink.produced < total); done += len)
+    {
+      signal_chain_block(&sink_chain, sine, noise, disturbed, filtered);
+      len = per_tick - done;
+      len = (len < config.block_len) ? len : config.block_len;
+      len = (len < total - sink.produced) ? len : total - sink.produced;
+      if (dac_output_write(&sink_dac, filtered, len) == 0)
+      {
+        fprintf(stderr, "ring overflow at sample %u\n", (unsigned)sink.produced);
+        break;
+      }
+      for (n = 0; n < len; n++, sink.produced++)
+      {
+        sink.expected[sink.produced] = filtered[n];
+        sink.produced_at[sink.produced] = tick_time;
+      }
+      if (sink_dac.running && !started)
+      {
+        sink.start = tick_time;
+        started = 1;
+      }
+    }
+  }
+  fclose(sink.file);
+
+  printf("%u samples produced, %u played at %u Hz, %u wrong\n", (unsigned)sink.produced, (unsigned)sink.played,
+         (unsigned)config.sampling_frequency, (unsigned)sink.wrong);
+  printf("%u halves of %u, %u underruns (%u samples held), lowest ring fill %u of %u\n",
+         (unsigned)sink_dac.stats.halves, (unsigned)half, (unsigned)sink_dac.stats.underruns,
+         (unsigned)sink_dac.stats.missing, (unsigned)sink_dac.stats.min_fill, (unsigned)ring);
+  printf("latency tick -> DAC %.3f .. %.3f ms, ring overflows %u\n", sink.min_latency / 1e6, sink.max_latency / 1e6,
+         (unsigned)sink_dac.ring.overflows);
+
+  return ((sink.wrong > 0) || (sink_dac.stats.underruns > 0) || (sink_dac.ring.overflows > 0)) ? 1 : 0;
+}
+
+#endif
@@ -0,0 +1,282 @@
+/*
+*********************************************************************
+*
+*   Dataflow graph runtime
+*
+*   A graph is two const tables: stages (what to run, block sizes,
+*   which task group runs it) and edges (which output feeds which
+*   input, through a lock-free ring). A stage is ready when every
+*   input holds in_len samples and every edge it feeds has room for
+*   out_len; dataflow_run fires the ready stages of one task group
+*   until none is left. The whole graph can run in one task, or each
+*   group in its own task: after a firing the groups that can now make
+*   progress (the consumers of the outputs, the producers of the
+*   inputs) are woken through the notify callback. Every edge has one
+*   producer and one consumer, so the rings need no locking even when
+*   the two sides run in different tasks.
+*
+*   Each firing is timed with the cycle counter, so per-stage cost
+*   and load are visible in the stats (Watch window) or with
+*   dataflow_report.
+*
+*********************************************************************
+*/
+
+#include <stdio.h>
+
+#include "arm_math.h"
+#include "cycle_counter.h"
+#include "spsc_ring.h"
+#include "dataflow.h"
+
+#define DATAFLOW_NO_EDGE (0xFFu)
+
+arm_status dataflow_init(dataflow_graph_t *graph, const dataflow_stage_t *stages, uint32_t num_stages,
+                         const dataflow_edge_t *edges, uint32_t num_edges, q15_t *scratch, uint32_t max_block,
+                         void (*notify)(uint32_t task))
+{
+  const dataflow_stage_t *from, *to;
+  uint32_t s, e, port;
+
+  if ((num_stages > DATAFLOW_MAX_STAGES) || (num_edges > DATAFLOW_MAX_EDGES))
+  {
+    return ARM_MATH_ARGUMENT_ERROR;
+  }
+
+  graph->stage = stages;
+  graph->edge = edges;
+  graph->num_stages = num_stages;
+  graph->num_edges = num_edges;
+  graph->num_tasks = 0;
+  graph->scratch = scratch;
+  graph->max_block = max_block;
+  graph->notify = notify;
+  graph->released = 0;
+
+  for (s = 0; s < num_stages; s++)
+  {
+    if ((stages[s].task >= DATAFLOW_MAX_TASKS) || (stages[s].num_inputs > DATAFLOW_MAX_PORTS) ||
+        (stages[s].num_outputs > DATAFLOW_MAX_PORTS) || (stages[s].in_len > max_block) ||
+        (stages[s].out_len > max_block) || (stages[s].out_len == 0) ||
+        ((stages[s].num_inputs > 0) && (stages[s].in_len == 0)))
+    {
+      return ARM_MATH_ARGUMENT_ERROR;
+    }
+    if (stages[s].task >= graph->num_tasks)
+    {
+      graph->num_tasks = stages[s].task + 1u;
+    }
+    for (port = 0; port < DATAFLOW_MAX_PORTS; port++)
+    {
+      graph->input_edge[s][port] = DATAFLOW_NO_EDGE;
+    }
+    graph->consumed[s] = 0;
+    graph->stats[s].firings = 0;
+    graph->stats[s].cycles = 0;
+    graph->stats[s].max_cycles = 0;
+    graph->stats[s].total_cycles = 0;
+  }
+
+  for (e = 0; e < num_edges; e++)
+  {
+    if ((edges[e].from_stage >= num_stages) || (edges[e].to_stage >= num_stages))
+    {
+      return ARM_MATH_ARGUMENT_ERROR;
+    }
+    from = &stages[edges[e].from_stage];
+    to = &stages[edges[e].to_stage];
+    if ((edges[e].from_port >= from->num_outputs) || (edges[e].to_port >= to->num_inputs) ||
+        (graph->input_edge[edges[e].to_stage][edges[e].to_port] != DATAFLOW_NO_EDGE) ||
+        ((edges[e].size & (edges[e].size - 1u)) != 0) || (edges[e].size < (uint32_t)from->out_len + to->in_len))
+    {
+      return ARM_MATH_ARGUMENT_ERROR;
+    }
+    graph->input_edge[edges[e].to_stage][edges[e].to_port] = (uint8_t)e;
+    spsc_ring_init(&(graph->ring[e]), edges[e].buffer, edges[e].size);
+  }
+
+  // every input must be connected
+  for (s = 0; s < num_stages; s++)
+  {
+    for (port = 0; port < stages[s].num_inputs; port++)
+    {
+      if (graph->input_edge[s][port] == DATAFLOW_NO_EDGE)
+      {
+        return ARM_MATH_ARGUMENT_ERROR;
+      }
+    }
+  }
+
+  cycle_counter_enable();
+  return ARM_MATH_SUCCESS;
+}
+
+void dataflow_release(dataflow_graph_t *graph, uint32_t samples)
+{
+  uint32_t woken = 0;
+  uint32_t s, task;
+
+  graph->released += samples;
+
+  if (graph->notify != NULL)
+  {
+    for (s = 0; s < graph->num_stages; s++)
+    {
+      task = graph->stage[s].task;
+      if ((graph->stage[s].num_inputs == 0) && !(woken & (1u << task)))
+      {
+        woken |= 1u << task;
+        graph->notify(task);
+      }
+    }
+  }
+}
+
+/*
+*********************************************************************
+*
+*   Scheduler
+*
+*********************************************************************
+*/
+
+static uint32_t dataflow_ready(dataflow_graph_t *graph, uint32_t s)
+{
+  const dataflow_stage_t *stage = &(graph->stage[s]);
+  uint32_t port, e;
+
+  if (stage->num_inputs == 0)
+  {
+    if (graph->released - graph->consumed[s] < stage->out_len)
+    {
+      return 0;
+    }
+  }
+  for (port = 0; port < stage->num_inputs; port++)
+  {
+    if (spsc_ring_count(&(graph->ring[graph->input_edge[s][port]])) < stage->in_len)
+    {
+      return 0;
+    }
+  }
+  for (e = 0; e < graph->num_edges; e++)
+  {
+    if ((graph->edge[e].from_stage == s) && (spsc_ring_space(&(graph->ring[e])) < stage->out_len))
+    {
+      return 0;
+    }
+  }
+  return 1;
+}
+
+static void dataflow_fire(dataflow_graph_t *graph, uint32_t s, uint32_t task)
+{
+  const dataflow_stage_t *stage = &(graph->stage[s]);
+  dataflow_stage_stats_t *stats = &(graph->stats[s]);
+  q15_t *scratch = &(graph->scratch[task * DATAFLOW_SCRATCH_LEN(graph->max_block)]);
+  q15_t *input[DATAFLOW_MAX_PORTS];
+  q15_t *output[DATAFLOW_MAX_PORTS];
+  uint32_t woken = 1u << task;
+  uint32_t port, start, cycles, e, other;
+
+  for (port = 0; port < DATAFLOW_MAX_PORTS; port++)
+  {
+    input[port] = &scratch[port * graph->max_block];
+    output[port] = &scratch[(DATAFLOW_MAX_PORTS + port) * graph->max_block];
+  }
+
+  for (port = 0; port < stage->num_inputs; port++)
+  {
+    e = graph->input_edge[s][port];
+    spsc_ring_pop(&(graph->ring[e]), input[port], stage->in_len);
+    // room on the edge: the producer may be waiting for it
+    other = graph->stage[graph->edge[e].from_stage].task;
+    if (!(woken & (1u << other)) && (graph->notify != NULL))
+    {
+      woken |= 1u << other;
+      graph->notify(other);
+    }
+  }
+
+  start = cycle_counter_read();
+  stage->fire(stage, input, output);
+  cycles = cycle_counter_read() - start;
+
+  stats->firings++;
+  stats->cycles = cycles;
+  stats->total_cycles += cycles;
+  if (cycles > stats->max_cycles)
+  {
+    stats->max_cycles = cycles;
+  }
+  if (stage->num_inputs == 0)
+  {
+    graph->consumed[s] += stage->out_len;
+  }
+
+  for (e = 0; e < graph->num_edges; e++)
+  {
+    if (graph->edge[e].from_stage == s)
+    {
+      spsc_ring_push(&(graph->ring[e]), output[graph->edge[e].from_port], stage->out_len);
+      other = graph->stage[graph->edge[e].to_stage].task;
+      if (!(woken & (1u << other)) && (graph->notify != NULL))
+      {
+        woken |= 1u << other;
+        graph->notify(other);
+      }
+    }
+  }
+}
+
+uint32_t dataflow_run(dataflow_graph_t *graph, uint32_t task)
+{
+  uint32_t firings = 0;
+  uint32_t progress, s;
+
+  do
+  {
+    progress = 0;
+    for (s = 0; s < graph->num_stages; s++)
+    {
+      if ((graph->stage[s].task == task) && dataflow_ready(graph, s))
+      {
+        dataflow_fire(graph, s, task);
+        progress++;
+      }
+    }
+    firings += progress;
+  } while (progress > 0);
+
+  return firings;
+}
+
+/*
+*********************************************************************
+*
+*   Report: firings, average and worst cycles per firing and the
+*   share of the graph total, to find the bottleneck stage
+*
+*********************************************************************
+*/
+
+void dataflow_report(const dataflow_graph_t *graph)
+{
+  const dataflow_stage_stats_t *stats;
+  uint64_t total = 0;
+  uint32_t s;
+
+  for (s = 0; s < graph->num_stages; s++)
+  {
+    total += graph->stats[s].total_cycles;
+  }
+
+  printf("stage         task  firings  avg " CYCLE_COUNTER_UNIT "  max " CYCLE_COUNTER_UNIT "  share\n\r");
+  for (s = 0; s < graph->num_stages; s++)
+  {
+    stats = &(graph->stats[s]);
+    printf("%-12s %5u %8u %8u %8u %5u%%\n\r", graph->stage[s].name, (unsigned)graph->stage[s].task,
+           (unsigned)stats->firings, (unsigned)(stats->firings ? stats->total_cycles / stats->firings : 0),
+           (unsigned)stats->max_cycles, (unsigned)(total ? stats->total_cycles * 100u / total : 0));
+  }
+}
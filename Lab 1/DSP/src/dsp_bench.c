@@ -0,0 +1,882 @@
+/*
+*********************************************************************
+*
+*   DSP benchmarks
+*
+*   Measures the cost of the DSP building blocks with the DWT cycle
+*   counter and prints the results on the ITM console.
+*   The file can also be compiled on a PC with DSP_HOST_BUILD defined
+*   (together with the CMSIS-DSP kernels in host/, see
+*   arm_math_host.c); the timings are then reported in nanoseconds.
+*
+*********************************************************************
+*/
+
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+
+#include "arm_math.h"
+#include "cycle_counter.h"
+#include "low_pass_filter.h"
+#include "sine_generator.h"
+#include "tone_bank.h"
+#include "multirate_filter.h"
+#include "filter_design.h"
+#include "fft_filter.h"
+#include "noise_canceller.h"
+#include "tone_monitor.h"
+#include "dsp_kernels.h"
+#include "dsp_bench.h"
+
+#define BENCH_SAMPLES (4096u)
+#define BENCH_BLOCK   (256u)
+
+// long run oscillator test: 10^7 samples of a 10 Hz tone at 1 kHz
+#define BENCH_LONG_RUN     (10000000u)
+#define BENCH_SINE_FREQ    (10u)
+#define BENCH_SINE_FS      (1000u)
+#define BENCH_SINE_WINDOW  (100000u)   // amplitude is measured over the first and last window
+
+#ifdef DSP_HOST_BUILD
+  #define BENCH_PASSES (100u)   // host timer is too coarse for a single pass
+#else
+  #define BENCH_PASSES (1u)
+#endif
+
+static q15_t bench_input[BENCH_SAMPLES];
+static q15_t bench_output[BENCH_SAMPLES];
+static q31_t bench_fir_state[LOW_PASS_FILTER_STATE_LEN(LOW_PASS_FILTER_MAX_BLOCK)];
+
+/*
+*********************************************************************
+*
+*   Test stimulus: pseudo random samples at half scale
+*
+*********************************************************************
+*/
+
+static void bench_fill_input(void)
+{
+  uint32_t seed = 12345u;
+  uint32_t n;
+
+  for (n = 0; n < BENCH_SAMPLES; n++)
+  {
+    seed = seed * 1664525u + 1013904223u;
+    bench_input[n] = (q15_t)((int32_t)seed >> 17);
+  }
+}
+
+// param 0 leaves the parameter column empty
+static void bench_report(const char *name, uint32_t param, uint32_t elapsed, uint32_t samples)
+{
+  uint32_t per_sample_x100 = (uint32_t)(((uint64_t)elapsed * 100u) / samples);
+
+  if (param)
+    printf("%-12s %4u:", name, (unsigned)param);
+  else
+    printf("%-12s     :", name);
+  printf(" %5u.%02u %s/sample\n\r", (unsigned)(per_sample_x100 / 100u), (unsigned)(per_sample_x100 % 100u),
+         CYCLE_COUNTER_UNIT);
+}
+
+/*
+*********************************************************************
+*
+*   32-tap FIR: cycles per sample versus block length
+*
+*********************************************************************
+*/
+
+void dsp_bench_fir_block(void)
+{
+  low_pass_filter_q15_t filter;
+  uint32_t block_len, pass, n, start, elapsed;
+
+  for (block_len = 1; block_len <= LOW_PASS_FILTER_MAX_BLOCK; block_len <<= 1)
+  {
+    low_pass_filter_block_init(&filter, LOW_PASS_FILTER_FIR_Q15, bench_fir_state, block_len);
+
+    start = cycle_counter_read();
+    for (pass = 0; pass < BENCH_PASSES; pass++)
+    {
+      for (n = 0; n < BENCH_SAMPLES; n += block_len)
+      {
+        low_pass_filter_block(&filter, &bench_input[n], &bench_output[n]);
+      }
+    }
+    elapsed = cycle_counter_read() - start;
+
+    bench_report("fir32 block", block_len, elapsed, BENCH_SAMPLES * BENCH_PASSES);
+  }
+}
+
+/*
+*********************************************************************
+*
+*   Filter kinds: FIR versus biquad cascade
+*
+*   Reports cycles per sample (the number column is MACs per sample),
+*   then the gain at the signal frequency (passband error) and at 50,
+*   100 and 200 Hz (stopband rejection), measured with half scale
+*   tones at 1 kHz sampling.
+*
+*********************************************************************
+*/
+
+#define BENCH_GAIN_SETTLE  (2000u)   // samples skipped while the filter settles
+#define BENCH_GAIN_MEASURE (5000u)   // whole periods of every test tone
+
+static float32_t bench_filter_gain_db(low_pass_filter_kind_t kind, uint32_t tone_frequency)
+{
+  low_pass_filter_q15_t filter;
+  sine_generator_nco_q15_t tone;
+  uint64_t power_in = 0, power_out = 0;
+  uint32_t n, k;
+
+  low_pass_filter_block_init(&filter, kind, bench_fir_state, BENCH_BLOCK);
+  sine_generator_nco_init_q15(&tone, tone_frequency, BENCH_SINE_FS);
+
+  for (n = 0; n < BENCH_GAIN_SETTLE + BENCH_GAIN_MEASURE; n += BENCH_BLOCK)
+  {
+    sine_nco_calc_block_q15(&tone, bench_input, BENCH_BLOCK);
+    for (k = 0; k < BENCH_BLOCK; k++)
+    {
+      bench_input[k] >>= 1;
+    }
+    low_pass_filter_block(&filter, bench_input, bench_output);
+
+    for (k = 0; (k < BENCH_BLOCK) && (n + k < BENCH_GAIN_SETTLE + BENCH_GAIN_MEASURE); k++)
+    {
+      if (n + k >= BENCH_GAIN_SETTLE)
+      {
+        power_in += (int32_t)bench_input[k] * bench_input[k];
+        power_out += (int32_t)bench_output[k] * bench_output[k];
+      }
+    }
+  }
+
+  if (power_out == 0)
+  {
+    return -200.0f;
+  }
+  return 10.0f * log10f((float32_t)power_out / (float32_t)power_in);
+}
+
+void dsp_bench_filter_kinds(void)
+{
+  static const char *names[] = {"fir q15", "biquad q15", "biquad q31"};
+  low_pass_filter_q15_t filter;
+  uint32_t kind, pass, n, start, elapsed;
+
+  for (kind = LOW_PASS_FILTER_FIR_Q15; kind <= LOW_PASS_FILTER_BIQUAD_Q31; kind++)
+  {
+    low_pass_filter_block_init(&filter, (low_pass_filter_kind_t)kind, bench_fir_state, BENCH_BLOCK);
+
+    start = cycle_counter_read();
+    for (pass = 0; pass < BENCH_PASSES; pass++)
+    {
+      for (n = 0; n < BENCH_SAMPLES; n += BENCH_BLOCK)
+      {
+        low_pass_filter_block(&filter, &bench_input[n], &bench_output[n]);
+      }
+    }
+    elapsed = cycle_counter_read() - start;
+    bench_report(names[kind], low_pass_filter_macs((low_pass_filter_kind_t)kind), elapsed, BENCH_SAMPLES * BENCH_PASSES);
+
+    printf("%-12s gain 10 Hz %6.2f dB, 50 Hz %6.1f dB, 100 Hz %6.1f dB, 200 Hz %6.1f dB\n\r", names[kind],
+           bench_filter_gain_db((low_pass_filter_kind_t)kind, 10), bench_filter_gain_db((low_pass_filter_kind_t)kind, 50),
+           bench_filter_gain_db((low_pass_filter_kind_t)kind, 100), bench_filter_gain_db((low_pass_filter_kind_t)kind, 200));
+  }
+
+  bench_fill_input();
+}
+
+/*
+*********************************************************************
+*
+*   Multi-rate chain: decimate by M, 32-tap FIR at R/M, interpolate
+*
+*   Compared with running the 32-tap FIR at the full rate. MACs are
+*   counted per full-rate input sample.
+*
+*********************************************************************
+*/
+
+void dsp_bench_multirate(void)
+{
+  static q15_t decimator_coeff[MULTIRATE_COEFF_LEN(MULTIRATE_MAX_FACTOR)];
+  static q15_t interpolator_coeff[MULTIRATE_COEFF_LEN(MULTIRATE_MAX_FACTOR)];
+  static q15_t decimator_state[MULTIRATE_DECIMATOR_STATE_LEN(MULTIRATE_MAX_FACTOR, BENCH_BLOCK)];
+  static q15_t interpolator_state[MULTIRATE_INTERPOLATOR_STATE_LEN(2, BENCH_BLOCK / 2)];
+  static q15_t low_rate[2][BENCH_BLOCK / 2];
+  multirate_decimator_q15_t decimator;
+  multirate_interpolator_q15_t interpolator;
+  low_pass_filter_q15_t filter;
+  uint32_t factor, pass, n, start, elapsed, macs;
+
+  for (factor = 2; factor <= MULTIRATE_MAX_FACTOR; factor <<= 1)
+  {
+    multirate_decimator_init_q15(&decimator, factor, decimator_coeff, decimator_state, BENCH_BLOCK);
+    multirate_interpolator_init_q15(&interpolator, factor, interpolator_coeff, interpolator_state, BENCH_BLOCK / factor);
+    low_pass_filter_block_init(&filter, LOW_PASS_FILTER_FIR_Q15, bench_fir_state, BENCH_BLOCK / factor);
+
+    start = cycle_counter_read();
+    for (pass = 0; pass < BENCH_PASSES; pass++)
+    {
+      for (n = 0; n < BENCH_SAMPLES; n += BENCH_BLOCK)
+      {
+        multirate_decimate_q15(&decimator, &bench_input[n], low_rate[0]);
+        low_pass_filter_block(&filter, low_rate[0], low_rate[1]);
+        multirate_interpolate_q15(&interpolator, low_rate[1], &bench_output[n]);
+      }
+    }
+    elapsed = cycle_counter_read() - start;
+    bench_report("multirate", factor, elapsed, BENCH_SAMPLES * BENCH_PASSES);
+
+    macs = 2 * multirate_macs_per_input(factor) + LOW_PASS_FILTER_TAPS / factor;
+    printf("%-12s %4u: %u MACs/input sample (full rate FIR %u)\n\r", "multirate", (unsigned)factor,
+           (unsigned)macs, (unsigned)LOW_PASS_FILTER_TAPS);
+  }
+}
+
+/*
+*********************************************************************
+*
+*   Long filters: direct form arm_fir_q15 versus overlap-save FFT
+*
+*   Both run the same low pass taps over the same input from a zero
+*   state; the largest output difference is reported in LSBs together
+*   with the first tap count at which the FFT path is faster.
+*
+*********************************************************************
+*/
+
+void dsp_bench_fft_filter(void)
+{
+  static q15_t coeff[FFT_FILTER_MAX_TAPS];
+  static q15_t direct_state[FFT_FILTER_MAX_TAPS + BENCH_BLOCK - 1];
+  static q31_t fft_work[FFT_FILTER_WORK_LEN(FFT_FILTER_MAX_TAPS)];
+  static q15_t fft_output[BENCH_SAMPLES];
+  filter_design_spec_t spec;
+  arm_fir_instance_q15 direct;
+  fft_filter_q15_t fft_filter;
+  uint32_t num_taps, block_len, pass, n, start, direct_elapsed, fft_elapsed;
+  uint32_t crossover = 0;
+  int32_t error, max_error;
+
+  spec.type = FILTER_DESIGN_LOW_PASS;
+  spec.window = FILTER_DESIGN_KAISER;
+  spec.stop_edge_high = 0.0f;
+  spec.pass_edge_high = 0.0f;
+  spec.kaiser_beta = 0.0f;
+  spec.gain = 1.0f;
+
+  for (num_taps = FFT_FILTER_MIN_TAPS; num_taps <= FFT_FILTER_MAX_TAPS; num_taps <<= 1)
+  {
+    // transition band shrinks with the length, as a long filter would be used
+    spec.num_taps = num_taps;
+    spec.pass_edge = 0.1f;
+    spec.stop_edge = 0.1f + 4.0f / (float32_t)num_taps;
+    filter_design_fir_q15(&spec, coeff);
+
+    arm_fir_init_q15(&direct, (uint16_t)num_taps, coeff, direct_state, BENCH_BLOCK);
+    start = cycle_counter_read();
+    for (pass = 0; pass < BENCH_PASSES; pass++)
+    {
+      for (n = 0; n < BENCH_SAMPLES; n += BENCH_BLOCK)
+      {
+        arm_fir_q15(&direct, &bench_input[n], &bench_output[n], BENCH_BLOCK);
+      }
+    }
+    direct_elapsed = cycle_counter_read() - start;
+
+    fft_filter_init_q15(&fft_filter, num_taps, coeff, fft_work);
+    block_len = FFT_FILTER_BLOCK_LEN(num_taps);
+    start = cycle_counter_read();
+    for (pass = 0; pass < BENCH_PASSES; pass++)
+    {
+      for (n = 0; n < BENCH_SAMPLES; n += block_len)
+      {
+        fft_filter_q15(&fft_filter, &bench_input[n], &fft_output[n]);
+      }
+    }
+    fft_elapsed = cycle_counter_read() - start;
+
+    // compare one pass from a zero state
+    arm_fir_init_q15(&direct, (uint16_t)num_taps, coeff, direct_state, BENCH_BLOCK);
+    fft_filter_init_q15(&fft_filter, num_taps, coeff, fft_work);
+    max_error = 0;
+    for (n = 0; n < BENCH_SAMPLES; n += BENCH_BLOCK)
+    {
+      arm_fir_q15(&direct, &bench_input[n], &bench_output[n], BENCH_BLOCK);
+    }
+    for (n = 0; n < BENCH_SAMPLES; n += block_len)
+    {
+      fft_filter_q15(&fft_filter, &bench_input[n], &fft_output[n]);
+    }
+    for (n = 0; n < BENCH_SAMPLES; n++)
+    {
+      error = (int32_t)fft_output[n] - (int32_t)bench_output[n];
+      error = (error < 0) ? -error : error;
+      max_error = (error > max_error) ? error : max_error;
+    }
+
+    bench_report("fir direct", num_taps, direct_elapsed, BENCH_SAMPLES * BENCH_PASSES);
+    bench_report("fft conv", num_taps, fft_elapsed, BENCH_SAMPLES * BENCH_PASSES);
+    printf("%-12s %4u: fft %u, block %u, max error %d LSB\n\r", "fft conv", (unsigned)num_taps,
+           (unsigned)FFT_FILTER_FFT_LEN(num_taps), (unsigned)block_len, (int)max_error);
+
+    if ((crossover == 0) && (fft_elapsed < direct_elapsed))
+    {
+      crossover = num_taps;
+    }
+  }
+
+  if (crossover)
+  {
+    printf("fft conv faster from %u taps\n\r", (unsigned)crossover);
+  }
+  else
+  {
+    printf("fft conv not faster up to %u taps\n\r", (unsigned)FFT_FILTER_MAX_TAPS);
+  }
+}
+
+/*
+*********************************************************************
+*
+*   Adaptive noise canceller
+*
+*   A 10 Hz tone at half scale plus a tone noise that reaches the
+*   input through a different gain and phase than the reference.
+*   Reports cycles per sample, the convergence time and the rejection
+*   after BENCH_CANCEL_RUN samples, for noise far from (50 Hz) and
+*   close to (12 Hz) the signal.
+*
+*********************************************************************
+*/
+
+#define BENCH_CANCEL_TAPS (16u)
+#define BENCH_CANCEL_STEP (0.002f)
+#define BENCH_CANCEL_RUN  (100000u)
+
+void dsp_bench_noise_canceller(void)
+{
+  static const char *names[] = {"nlms q15", "nlms q31"};
+  static const uint32_t noise_frequency[] = {50, 12};
+  static q31_t canceller_work[NOISE_CANCELLER_WORK_LEN(BENCH_CANCEL_TAPS, BENCH_BLOCK)];
+  static q15_t reference[BENCH_BLOCK];
+  static q15_t wanted[BENCH_BLOCK];
+  noise_canceller_q15_t canceller;
+  sine_generator_nco_q15_t signal_tone, noise_tone, path_tone;
+  uint32_t kind, tone, n, k, elapsed;
+
+  for (kind = NOISE_CANCELLER_Q15; kind <= NOISE_CANCELLER_Q31; kind++)
+  {
+    for (tone = 0; tone < 2; tone++)
+    {
+      noise_canceller_init(&canceller, (noise_canceller_kind_t)kind, BENCH_CANCEL_TAPS, BENCH_CANCEL_STEP,
+                           canceller_work, BENCH_BLOCK);
+      sine_generator_nco_init_q15(&signal_tone, BENCH_SINE_FREQ, BENCH_SINE_FS);
+      sine_generator_nco_init_q15(&noise_tone, noise_frequency[tone], BENCH_SINE_FS);
+      sine_generator_nco_init_q15(&path_tone, noise_frequency[tone], BENCH_SINE_FS);
+      // the noise path lags the reference by about 40 degrees
+      for (k = 0; k < BENCH_SINE_FS / (9 * noise_frequency[tone]); k++)
+      {
+        sine_nco_calc_sample_q15(&noise_tone);
+      }
+
+      elapsed = 0;
+      for (n = 0; n < BENCH_CANCEL_RUN; n += BENCH_BLOCK)
+      {
+        sine_nco_calc_block_q15(&signal_tone, wanted, BENCH_BLOCK);
+        sine_nco_calc_block_q15(&noise_tone, reference, BENCH_BLOCK);
+        sine_nco_calc_block_q15(&path_tone, bench_output, BENCH_BLOCK);
+        for (k = 0; k < BENCH_BLOCK; k++)
+        {
+          wanted[k] = wanted[k] / 2;
+          bench_input[k] = wanted[k] + bench_output[k] / 10;
+          reference[k] = reference[k] / 6;
+        }
+        k = cycle_counter_read();
+        noise_canceller_block(&canceller, bench_input, reference, bench_output, wanted);
+        elapsed += cycle_counter_read() - k;
+      }
+
+      bench_report(names[kind], noise_frequency[tone], elapsed, BENCH_CANCEL_RUN - BENCH_CANCEL_RUN % BENCH_BLOCK);
+      if (canceller.stats.converged_at)
+      {
+        printf("%-12s %4u: converged after %u samples, rejection %5.1f dB\n\r", names[kind],
+               (unsigned)noise_frequency[tone], (unsigned)canceller.stats.converged_at,
+               noise_canceller_rejection_db(&canceller.stats));
+      }
+      else
+      {
+        printf("%-12s %4u: not converged, rejection %5.1f dB\n\r", names[kind],
+               (unsigned)noise_frequency[tone], noise_canceller_rejection_db(&canceller.stats));
+      }
+    }
+  }
+
+  bench_fill_input();
+}
+
+/*
+*********************************************************************
+*
+*   Tone monitor: cost per sample of a two-bin monitor, and the
+*   figures it reports for each low pass kind on the DirtyFilter
+*   signals (10 Hz at half scale plus 50 Hz at 1/6 scale, 1 kHz)
+*
+*********************************************************************
+*/
+
+#define BENCH_MONITOR_WINDOW (100u)
+#define BENCH_MONITOR_RUN    (2000u)
+
+void dsp_bench_tone_monitor(void)
+{
+  static const char *names[] = {"fir q15", "biquad q15", "biquad q31"};
+  tone_monitor_q15_t input_monitor, output_monitor;
+  sine_generator_nco_q15_t signal_tone, noise_tone;
+  low_pass_filter_q15_t filter;
+  uint32_t kind, pass, n, k, start, elapsed;
+
+  tone_monitor_init(&input_monitor, BENCH_MONITOR_WINDOW);
+  tone_monitor_add_bin(&input_monitor, BENCH_SINE_FREQ, BENCH_SINE_FS);
+  tone_monitor_add_bin(&input_monitor, 5 * BENCH_SINE_FREQ, BENCH_SINE_FS);
+
+  start = cycle_counter_read();
+  for (pass = 0; pass < BENCH_PASSES; pass++)
+  {
+    tone_monitor_block(&input_monitor, bench_input, BENCH_SAMPLES);
+  }
+  elapsed = cycle_counter_read() - start;
+  bench_report("tone monitor", input_monitor.num_bins, elapsed, BENCH_SAMPLES * BENCH_PASSES);
+
+  for (kind = LOW_PASS_FILTER_FIR_Q15; kind <= LOW_PASS_FILTER_BIQUAD_Q31; kind++)
+  {
+    low_pass_filter_block_init(&filter, (low_pass_filter_kind_t)kind, bench_fir_state, BENCH_MONITOR_WINDOW);
+    sine_generator_nco_init_q15(&signal_tone, BENCH_SINE_FREQ, BENCH_SINE_FS);
+    sine_generator_nco_init_q15(&noise_tone, 5 * BENCH_SINE_FREQ, BENCH_SINE_FS);
+    tone_monitor_init(&input_monitor, BENCH_MONITOR_WINDOW);
+    tone_monitor_add_bin(&input_monitor, BENCH_SINE_FREQ, BENCH_SINE_FS);
+    tone_monitor_add_bin(&input_monitor, 5 * BENCH_SINE_FREQ, BENCH_SINE_FS);
+    output_monitor = input_monitor;
+
+    for (n = 0; n < BENCH_MONITOR_RUN; n += BENCH_MONITOR_WINDOW)
+    {
+      sine_nco_calc_block_q15(&signal_tone, bench_input, BENCH_MONITOR_WINDOW);
+      sine_nco_calc_block_q15(&noise_tone, bench_output, BENCH_MONITOR_WINDOW);
+      for (k = 0; k < BENCH_MONITOR_WINDOW; k++)
+      {
+        bench_input[k] = bench_input[k] / 2 + bench_output[k] / 6;
+      }
+      low_pass_filter_block(&filter, bench_input, bench_output);
+      tone_monitor_block(&input_monitor, bench_input, BENCH_MONITOR_WINDOW);
+      tone_monitor_block(&output_monitor, bench_output, BENCH_MONITOR_WINDOW);
+    }
+
+    printf("%-12s snr in %5.1f dB, out %5.1f dB, rejection %5.1f dB, signal gain %5.2f dB\n\r", names[kind],
+           tone_monitor_ratio_db(&input_monitor, 0, &input_monitor, 1),
+           tone_monitor_ratio_db(&output_monitor, 0, &output_monitor, 1),
+           tone_monitor_ratio_db(&input_monitor, 1, &output_monitor, 1),
+           tone_monitor_ratio_db(&output_monitor, 0, &input_monitor, 0));
+  }
+
+  bench_fill_input();
+}
+
+/*
+*********************************************************************
+*
+*   Sine generators: IIR oscillator versus NCO
+*
+*   Cycles per sample, then a long run that tracks the peak amplitude
+*   at start and end and counts positive zero crossings to measure the
+*   frequency error.
+*
+*********************************************************************
+*/
+
+typedef struct
+{
+  q15_t peak_start;
+  q15_t peak_end;
+  uint32_t crossings;
+  q15_t last;
+} bench_sine_track_t;
+
+static void bench_sine_track(bench_sine_track_t *track, q15_t *block, uint32_t first_sample)
+{
+  uint32_t n;
+
+  for (n = 0; n < BENCH_BLOCK; n++)
+  {
+    q15_t y = block[n];
+    q15_t mag = (y < 0) ? (q15_t)(-y) : y;
+
+    if ((track->last < 0) && (y >= 0))
+      track->crossings++;
+    track->last = y;
+
+    if ((first_sample + n < BENCH_SINE_WINDOW) && (mag > track->peak_start))
+      track->peak_start = mag;
+    if ((first_sample + n >= BENCH_LONG_RUN - BENCH_SINE_WINDOW) && (mag > track->peak_end))
+      track->peak_end = mag;
+  }
+}
+
+static void bench_sine_report(const char *name, bench_sine_track_t *track)
+{
+  int32_t expected = (int32_t)((uint64_t)BENCH_LONG_RUN * BENCH_SINE_FREQ / BENCH_SINE_FS);
+  int32_t error_ppm = (int32_t)(((int64_t)((int32_t)track->crossings - expected) * 1000000) / expected);
+
+  printf("%-12s amplitude start %5d end %5d, crossings %u/%d (%d ppm)\n\r", name,
+         track->peak_start, track->peak_end, (unsigned)track->crossings, (int)expected, (int)error_ppm);
+}
+
+void dsp_bench_sine_generators(void)
+{
+  sine_generator_q15_t iir;
+  sine_generator_nco_q15_t nco;
+  bench_sine_track_t iir_track = {0};
+  bench_sine_track_t nco_track = {0};
+  uint32_t pass, n, start, elapsed;
+
+  memset(&iir, 0, sizeof(iir));
+  sine_generator_init_q15(&iir, BENCH_SINE_FREQ, BENCH_SINE_FS);
+  sine_generator_nco_init_q15(&nco, BENCH_SINE_FREQ, BENCH_SINE_FS);
+
+  start = cycle_counter_read();
+  for (pass = 0; pass < BENCH_PASSES; pass++)
+  {
+    for (n = 0; n < BENCH_SAMPLES; n++)
+    {
+      bench_output[n] = sine_calc_sample_q15(&iir);
+    }
+  }
+  elapsed = cycle_counter_read() - start;
+  bench_report("iir sample", 1, elapsed, BENCH_SAMPLES * BENCH_PASSES);
+
+  start = cycle_counter_read();
+  for (pass = 0; pass < BENCH_PASSES; pass++)
+  {
+    for (n = 0; n < BENCH_SAMPLES; n += BENCH_BLOCK)
+    {
+      sine_calc_block_q15(&iir, &bench_output[n], BENCH_BLOCK);
+    }
+  }
+  elapsed = cycle_counter_read() - start;
+  bench_report("iir block", BENCH_BLOCK, elapsed, BENCH_SAMPLES * BENCH_PASSES);
+
+  start = cycle_counter_read();
+  for (pass = 0; pass < BENCH_PASSES; pass++)
+  {
+    for (n = 0; n < BENCH_SAMPLES; n++)
+    {
+      bench_output[n] = sine_nco_calc_sample_q15(&nco);
+    }
+  }
+  elapsed = cycle_counter_read() - start;
+  bench_report("nco sample", 1, elapsed, BENCH_SAMPLES * BENCH_PASSES);
+
+  start = cycle_counter_read();
+  for (pass = 0; pass < BENCH_PASSES; pass++)
+  {
+    for (n = 0; n < BENCH_SAMPLES; n += BENCH_BLOCK)
+    {
+      sine_nco_calc_block_q15(&nco, &bench_output[n], BENCH_BLOCK);
+    }
+  }
+  elapsed = cycle_counter_read() - start;
+  bench_report("nco block", BENCH_BLOCK, elapsed, BENCH_SAMPLES * BENCH_PASSES);
+
+  // long run, both generators restarted from phase zero
+  memset(&iir, 0, sizeof(iir));
+  sine_generator_init_q15(&iir, BENCH_SINE_FREQ, BENCH_SINE_FS);
+  sine_generator_nco_init_q15(&nco, BENCH_SINE_FREQ, BENCH_SINE_FS);
+
+  for (n = 0; n < BENCH_LONG_RUN; n += BENCH_BLOCK)
+  {
+    sine_calc_block_q15(&iir, bench_output, BENCH_BLOCK);
+    bench_sine_track(&iir_track, bench_output, n);
+    sine_nco_calc_block_q15(&nco, bench_output, BENCH_BLOCK);
+    bench_sine_track(&nco_track, bench_output, n);
+  }
+
+  bench_sine_report("iir long run", &iir_track);
+  bench_sine_report("nco long run", &nco_track);
+}
+
+/*
+*********************************************************************
+*
+*   Tone bank versus separate oscillators
+*
+*   Mixes N equally weighted tones, once with the SoA tone bank and
+*   once with N sine_generator_q15_t instances stepped per sample.
+*
+*********************************************************************
+*/
+
+void dsp_bench_tone_bank(void)
+{
+  static sine_generator_q15_t separate[TONE_BANK_MAX_TONES];
+  tone_bank_q15_t bank;
+  uint32_t num_tones, k, pass, n, start, elapsed;
+  q31_t acc;
+
+  for (num_tones = 2; num_tones <= TONE_BANK_MAX_TONES; num_tones <<= 1)
+  {
+    tone_bank_init_q15(&bank);
+    memset(separate, 0, sizeof(separate));
+    for (k = 0; k < num_tones; k++)
+    {
+      tone_bank_add_q15(&bank, 10 + 40 * k, BENCH_SINE_FS, (q15_t)(32767 / num_tones));
+      sine_generator_init_q15(&separate[k], 10 + 40 * k, BENCH_SINE_FS);
+    }
+
+    start = cycle_counter_read();
+    for (pass = 0; pass < BENCH_PASSES; pass++)
+    {
+      for (n = 0; n < BENCH_SAMPLES; n += BENCH_BLOCK)
+      {
+        tone_bank_calc_block_q15(&bank, &bench_output[n], BENCH_BLOCK);
+      }
+    }
+    elapsed = cycle_counter_read() - start;
+    bench_report("tone bank", num_tones, elapsed, BENCH_SAMPLES * BENCH_PASSES);
+
+    start = cycle_counter_read();
+    for (pass = 0; pass < BENCH_PASSES; pass++)
+    {
+      for (n = 0; n < BENCH_SAMPLES; n++)
+      {
+        acc = 0;
+        for (k = 0; k < num_tones; k++)
+        {
+          acc += sine_calc_sample_q15(&separate[k]);
+        }
+        bench_output[n] = (q15_t)(acc / (q31_t)num_tones);
+      }
+    }
+    elapsed = cycle_counter_read() - start;
+    bench_report("separate", num_tones, elapsed, BENCH_SAMPLES * BENCH_PASSES);
+  }
+}
+
+/*
+*********************************************************************
+*
+*   Precision matrix: oscillator and 32-tap FIR in q15, q31, f32
+*
+*   Time per sample, and SNR against a double precision reference:
+*   for the oscillator a sine at the frequency and amplitude of its
+*   quantized coefficient and start value, so that only the rounding
+*   of the recursion counts; the detuning is reported separately as
+*   frequency error. For the FIR the unquantized taps applied to the
+*   unquantized input (10 Hz at half scale plus 50 Hz at 1/6). One
+*   bench function per precision is generated from the same macro,
+*   like the kernels themselves.
+*
+*********************************************************************
+*/
+
+#define BENCH_PRECISION_TAPS (32u)
+#define BENCH_PRECISION_RUN  (16384u)
+
+typedef struct
+{
+  float64_t signal;
+  float64_t noise;
+} bench_snr_t;
+
+static float32_t bench_precision_taps[BENCH_PRECISION_TAPS];
+static float32_t bench_float[BENCH_BLOCK];
+
+static float64_t bench_precision_tone(uint32_t n)
+{
+  float64_t w = 2.0 * 3.14159265358979 * BENCH_SINE_FREQ / BENCH_SINE_FS;
+
+  return 0.5 * sin(w * n) + (1.0 / 6.0) * sin(5.0 * w * n);
+}
+
+static void bench_precision_input(float32_t *block, uint32_t first_sample)
+{
+  uint32_t n;
+
+  for (n = 0; n < BENCH_BLOCK; n++)
+  {
+    block[n] = (float32_t)bench_precision_tone(first_sample + n);
+  }
+}
+
+// the oscillator output is -A sin((n + 1) w), see dsp_kernels.c;
+// w and A from kernel_oscillator_pole
+static void bench_snr_oscillator(bench_snr_t *snr, const float32_t *block, uint32_t first_sample, float64_t w,
+                                 float64_t amplitude)
+{
+  float64_t ideal, error;
+  uint32_t n;
+
+  for (n = 0; n < BENCH_BLOCK; n++)
+  {
+    ideal = -amplitude * sin(w * (first_sample + n + 1));
+    error = block[n] - ideal;
+    snr->signal += ideal * ideal;
+    snr->noise += error * error;
+  }
+}
+
+static void bench_snr_fir(bench_snr_t *snr, const float32_t *block, uint32_t first_sample)
+{
+  float64_t ideal, error;
+  uint32_t n, k;
+
+  for (n = 0; n < BENCH_BLOCK; n++)
+  {
+    // taps in CMSIS order: the first one weights the oldest sample
+    ideal = 0.0;
+    for (k = 0; k < BENCH_PRECISION_TAPS; k++)
+    {
+      if (first_sample + n + k + 1 >= BENCH_PRECISION_TAPS)
+      {
+        ideal += bench_precision_taps[k] * (float64_t)(float32_t)bench_precision_tone(first_sample + n + k + 1 - BENCH_PRECISION_TAPS);
+      }
+    }
+    error = block[n] - ideal;
+    snr->signal += ideal * ideal;
+    snr->noise += error * error;
+  }
+}
+
+static float32_t bench_snr_db(const bench_snr_t *snr)
+{
+  if (snr->noise <= 0.0)
+  {
+    return 300.0f;
+  }
+  return (float32_t)(10.0 * log10(snr->signal / snr->noise));
+}
+
+#define BENCH_PRECISION_DEFINE(type_t, sfx)                                                                     \
+  static void bench_precision_##sfx(const char *name)                                                           \
+  {                                                                                                             \
+    static type_t coeff[BENCH_PRECISION_TAPS];                                                                  \
+    static type_t state[KERNEL_FIR_STATE_LEN(BENCH_PRECISION_TAPS, BENCH_BLOCK)];                               \
+    static type_t block[2][BENCH_BLOCK];                                                                        \
+    kernel_oscillator_##sfx##_t oscillator;                                                                     \
+    kernel_fir_##sfx##_t fir;                                                                                   \
+    bench_snr_t oscillator_snr = {0.0, 0.0};                                                                    \
+    bench_snr_t fir_snr = {0.0, 0.0};                                                                           \
+    uint32_t pass, n, start, oscillator_elapsed, fir_elapsed;                                                   \
+    float64_t w, amplitude;                                                                                     \
+                                                                                                                \
+    kernel_oscillator_init_##sfx(&oscillator, BENCH_SINE_FREQ, BENCH_SINE_FS);                                  \
+    start = cycle_counter_read();                                                                               \
+    for (pass = 0; pass < BENCH_PASSES; pass++)                                                                 \
+    {                                                                                                           \
+      for (n = 0; n < BENCH_SAMPLES; n += BENCH_BLOCK)                                                          \
+      {                                                                                                         \
+        kernel_oscillator_block_##sfx(&oscillator, block[0], BENCH_BLOCK);                                      \
+      }                                                                                                         \
+    }                                                                                                           \
+    oscillator_elapsed = cycle_counter_read() - start;                                                          \
+                                                                                                                \
+    kernel_fir_init_##sfx(&fir, bench_precision_taps, BENCH_PRECISION_TAPS, coeff, state, BENCH_BLOCK);         \
+    bench_precision_input(bench_float, 0);                                                                      \
+    kernel_from_float_##sfx(bench_float, block[0], BENCH_BLOCK);                                                \
+    start = cycle_counter_read();                                                                               \
+    for (pass = 0; pass < BENCH_PASSES; pass++)                                                                 \
+    {                                                                                                           \
+      for (n = 0; n < BENCH_SAMPLES; n += BENCH_BLOCK)                                                          \
+      {                                                                                                         \
+        kernel_fir_block_##sfx(&fir, block[0], block[1]);                                                       \
+      }                                                                                                         \
+    }                                                                                                           \
+    fir_elapsed = cycle_counter_read() - start;                                                                 \
+                                                                                                                \
+    kernel_oscillator_init_##sfx(&oscillator, BENCH_SINE_FREQ, BENCH_SINE_FS);                                  \
+    kernel_oscillator_pole_##sfx(&oscillator, &w, &amplitude);                                                  \
+    kernel_fir_init_##sfx(&fir, bench_precision_taps, BENCH_PRECISION_TAPS, coeff, state, BENCH_BLOCK);         \
+    for (n = 0; n < BENCH_PRECISION_RUN; n += BENCH_BLOCK)                                                      \
+    {                                                                                                           \
+      kernel_oscillator_block_##sfx(&oscillator, block[0], BENCH_BLOCK);                                        \
+      kernel_to_float_##sfx(block[0], bench_float, BENCH_BLOCK);                                                \
+      bench_snr_oscillator(&oscillator_snr, bench_float, n, w, amplitude);                                      \
+                                                                                                                \
+      bench_precision_input(bench_float, n);                                                                    \
+      kernel_from_float_##sfx(bench_float, block[0], BENCH_BLOCK);                                              \
+      kernel_fir_block_##sfx(&fir, block[0], block[1]);                                                         \
+      kernel_to_float_##sfx(block[1], bench_float, BENCH_BLOCK);                                                \
+      bench_snr_fir(&fir_snr, bench_float, n);                                                                  \
+    }                                                                                                           \
+                                                                                                                \
+    bench_report(name, 0, oscillator_elapsed, BENCH_SAMPLES * BENCH_PASSES);                                    \
+    bench_report(name, BENCH_PRECISION_TAPS, fir_elapsed, BENCH_SAMPLES * BENCH_PASSES);                        \
+    printf("%-12s oscillator snr %6.1f dB, frequency error %+9.2f ppm, fir%u snr %6.1f dB\n\r", name,           \
+           bench_snr_db(&oscillator_snr), 1e6 * (w * BENCH_SINE_FS / (2.0 * PI * BENCH_SINE_FREQ) - 1.0),       \
+           (unsigned)BENCH_PRECISION_TAPS, bench_snr_db(&fir_snr));                                             \
+  }
+
+BENCH_PRECISION_DEFINE(q15_t, q15)
+BENCH_PRECISION_DEFINE(q31_t, q31)
+BENCH_PRECISION_DEFINE(float32_t, f32)
+
+void dsp_bench_precision(void)
+{
+  filter_design_spec_t spec;
+
+  // the same plan as the fixed low pass: pass 20 Hz, stop 50 Hz at 1 kHz
+  spec.type = FILTER_DESIGN_LOW_PASS;
+  spec.window = FILTER_DESIGN_KAISER;
+  spec.num_taps = BENCH_PRECISION_TAPS;
+  spec.pass_edge = 0.02f;
+  spec.stop_edge = 0.05f;
+  spec.stop_edge_high = 0.0f;
+  spec.pass_edge_high = 0.0f;
+  spec.kaiser_beta = 0.0f;
+  spec.gain = 1.0f;
+  filter_design_fir_f32(&spec, bench_precision_taps);
+
+  bench_precision_q15("q15");
+  bench_precision_q31("q31");
+  bench_precision_f32("f32");
+}
+
+/*
+*********************************************************************
+*
+*   Run all benchmarks
+*
+*********************************************************************
+*/
+
+void dsp_bench_run(void)
+{
+  cycle_counter_init();
+  bench_fill_input();
+
+  dsp_bench_fir_block();
+  dsp_bench_filter_kinds();
+  dsp_bench_multirate();
+  dsp_bench_fft_filter();
+  dsp_bench_noise_canceller();
+  dsp_bench_tone_monitor();
+  dsp_bench_sine_generators();
+  dsp_bench_tone_bank();
+  dsp_bench_precision();
+}
+
+#ifdef DSP_HOST_BUILD
+
+int main(void)
+{
+  dsp_bench_run();
+  return 0;
+}
+
+#endif
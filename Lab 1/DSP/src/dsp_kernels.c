@@ -0,0 +1,208 @@
+/*
+*********************************************************************
+*
+*   Precision-generic kernels
+*
+*   The IIR oscillator of sine_generator.c and the FIR of
+*   low_pass_filter.c, written once as a macro and instantiated for
+*   q15, q31 and float32 with matching names and arguments. q15 is
+*   the cheapest in memory, q31 lowers the FIR noise floor by about
+*   85 dB and keeps the oscillator on frequency (the q15 cos(w)
+*   coefficient detunes it), float32 uses the M4 FPU and needs no
+*   scaling. dsp_bench_precision measures the trade-off.
+*
+*   The CMSIS calls differ between the types in a few places (biquad
+*   coefficient layout and post shift, the float conversions); those
+*   are isolated in the per-precision glue below, everything else is
+*   shared.
+*
+*********************************************************************
+*/
+
+#include "arm_math.h"
+#include "dsp_kernels.h"
+
+/*
+*********************************************************************
+*
+*   Per-precision glue
+*
+*   Oscillator: y[n] = a1 y[n-1] + a2 y[n-2] with a1 = 2 cos(w),
+*   a2 = -1. The fixed point kinds store a1 / 2, a2 / 2 and use a
+*   post shift of 1; q15 has the extra zero of its 6 tap layout.
+*   The pole glue reads back the quantized cos(w) and y[n-2] start.
+*
+*********************************************************************
+*/
+
+static void kernel_glue_from_float_q15(float32_t *input, q15_t *output, uint32_t len)
+{
+  arm_float_to_q15(input, output, len);
+}
+
+static void kernel_glue_to_float_q15(q15_t *input, float32_t *output, uint32_t len)
+{
+  arm_q15_to_float(input, output, len);
+}
+
+static void kernel_glue_oscillator_q15(kernel_oscillator_q15_t *oscillator_desc, float32_t a1, float32_t a2)
+{
+  float32_t half[2];
+
+  half[0] = a1 / 2;
+  half[1] = a2 / 2;
+  arm_fill_q15(0, oscillator_desc->coeff, 4);
+  arm_float_to_q15(half, &(oscillator_desc->coeff[4]), 2);
+  arm_biquad_cascade_df1_init_q15(&(oscillator_desc->biquad_instance), 1, oscillator_desc->coeff,
+                                  oscillator_desc->state, 1);
+}
+
+static void kernel_glue_oscillator_pole_q15(const kernel_oscillator_q15_t *oscillator_desc, float64_t *cos_w,
+                                            float64_t *start)
+{
+  *cos_w = oscillator_desc->coeff[4] / 32768.0;
+  *start = oscillator_desc->state[3] / 32768.0;
+}
+
+static void kernel_glue_fir_q15(kernel_fir_q15_t *fir_desc, uint32_t num_taps, q15_t *coeff, q15_t *state,
+                                uint32_t block_len)
+{
+  arm_fir_init_q15(&(fir_desc->fir_instance), (uint16_t)num_taps, coeff, state, block_len);
+}
+
+static void kernel_glue_from_float_q31(float32_t *input, q31_t *output, uint32_t len)
+{
+  arm_float_to_q31(input, output, len);
+}
+
+static void kernel_glue_to_float_q31(q31_t *input, float32_t *output, uint32_t len)
+{
+  arm_q31_to_float(input, output, len);
+}
+
+static void kernel_glue_oscillator_q31(kernel_oscillator_q31_t *oscillator_desc, float32_t a1, float32_t a2)
+{
+  float32_t half[2];
+
+  half[0] = a1 / 2;
+  half[1] = a2 / 2;
+  arm_fill_q31(0, oscillator_desc->coeff, 3);
+  arm_float_to_q31(half, &(oscillator_desc->coeff[3]), 2);
+  arm_biquad_cascade_df1_init_q31(&(oscillator_desc->biquad_instance), 1, oscillator_desc->coeff,
+                                  oscillator_desc->state, 1);
+}
+
+static void kernel_glue_oscillator_pole_q31(const kernel_oscillator_q31_t *oscillator_desc, float64_t *cos_w,
+                                            float64_t *start)
+{
+  *cos_w = oscillator_desc->coeff[3] / 2147483648.0;
+  *start = oscillator_desc->state[3] / 2147483648.0;
+}
+
+static void kernel_glue_fir_q31(kernel_fir_q31_t *fir_desc, uint32_t num_taps, q31_t *coeff, q31_t *state,
+                                uint32_t block_len)
+{
+  arm_fir_init_q31(&(fir_desc->fir_instance), (uint16_t)num_taps, coeff, state, block_len);
+}
+
+static void kernel_glue_from_float_f32(float32_t *input, float32_t *output, uint32_t len)
+{
+  arm_copy_f32(input, output, len);
+}
+
+static void kernel_glue_to_float_f32(float32_t *input, float32_t *output, uint32_t len)
+{
+  arm_copy_f32(input, output, len);
+}
+
+static void kernel_glue_oscillator_f32(kernel_oscillator_f32_t *oscillator_desc, float32_t a1, float32_t a2)
+{
+  arm_fill_f32(0.0f, oscillator_desc->coeff, 3);
+  oscillator_desc->coeff[3] = a1;
+  oscillator_desc->coeff[4] = a2;
+  arm_biquad_cascade_df1_init_f32(&(oscillator_desc->biquad_instance), 1, oscillator_desc->coeff,
+                                  oscillator_desc->state);
+}
+
+static void kernel_glue_oscillator_pole_f32(const kernel_oscillator_f32_t *oscillator_desc, float64_t *cos_w,
+                                            float64_t *start)
+{
+  *cos_w = oscillator_desc->coeff[3] / 2.0;
+  *start = oscillator_desc->state[3];
+}
+
+static void kernel_glue_fir_f32(kernel_fir_f32_t *fir_desc, uint32_t num_taps, float32_t *coeff, float32_t *state,
+                                uint32_t block_len)
+{
+  arm_fir_init_f32(&(fir_desc->fir_instance), (uint16_t)num_taps, coeff, state, block_len);
+}
+
+/*
+*********************************************************************
+*
+*   Shared implementation
+*
+*   The oscillator starts with y[n-1] = 0 and y[n-2] = A sin(w), like
+*   sine_generator_init_q15, so every precision produces the same
+*   sine, -A sin((n + 1) w), with A = KERNEL_OSCILLATOR_AMPLITUDE.
+*   With the coefficient and start value quantized it really runs
+*   -y[n-2] sin((n + 1) wq) / sin(wq) at the pole angle wq, which
+*   kernel_oscillator_pole returns.
+*
+*********************************************************************
+*/
+
+#define DSP_KERNELS_DEFINE(type_t, sfx)                                                                         \
+  void kernel_from_float_##sfx(float32_t *input, type_t *output, uint32_t len)                                  \
+  {                                                                                                             \
+    kernel_glue_from_float_##sfx(input, output, len);                                                           \
+  }                                                                                                             \
+                                                                                                                \
+  void kernel_to_float_##sfx(type_t *input, float32_t *output, uint32_t len)                                    \
+  {                                                                                                             \
+    kernel_glue_to_float_##sfx(input, output, len);                                                             \
+  }                                                                                                             \
+                                                                                                                \
+  void kernel_oscillator_init_##sfx(kernel_oscillator_##sfx##_t *oscillator_desc, uint32_t sine_frequency,      \
+                                    uint32_t sampling_frequency)                                                \
+  {                                                                                                             \
+    float32_t w = 2 * PI * (float32_t)sine_frequency / (float32_t)sampling_frequency;                           \
+    float32_t start = KERNEL_OSCILLATOR_AMPLITUDE * arm_sin_f32(w);                                             \
+                                                                                                                \
+    kernel_glue_oscillator_##sfx(oscillator_desc, 2 * arm_cos_f32(w), -1.0f);                                   \
+    kernel_glue_from_float_##sfx(&start, &(oscillator_desc->state[3]), 1);                                      \
+  }                                                                                                             \
+                                                                                                                \
+  void kernel_oscillator_block_##sfx(kernel_oscillator_##sfx##_t *oscillator_desc, type_t *output,              \
+                                     uint32_t block_len)                                                        \
+  {                                                                                                             \
+    arm_fill_##sfx(0, output, block_len);                                                                       \
+    arm_biquad_cascade_df1_##sfx(&(oscillator_desc->biquad_instance), output, output, block_len);               \
+  }                                                                                                             \
+                                                                                                                \
+  void kernel_oscillator_pole_##sfx(const kernel_oscillator_##sfx##_t *oscillator_desc, float64_t *w,           \
+                                    float64_t *amplitude)                                                       \
+  {                                                                                                             \
+    float64_t cos_w, start;                                                                                     \
+                                                                                                                \
+    kernel_glue_oscillator_pole_##sfx(oscillator_desc, &cos_w, &start);                                         \
+    *w = acos(cos_w);                                                                                           \
+    *amplitude = start / sin(*w);                                                                               \
+  }                                                                                                             \
+                                                                                                                \
+  void kernel_fir_init_##sfx(kernel_fir_##sfx##_t *fir_desc, const float32_t *taps, uint32_t num_taps,          \
+                             type_t *coeff, type_t *state, uint32_t block_len)                                  \
+  {                                                                                                             \
+    kernel_glue_from_float_##sfx((float32_t *)taps, coeff, num_taps);                                           \
+    kernel_glue_fir_##sfx(fir_desc, num_taps, coeff, state, block_len);                                         \
+    fir_desc->block_len = block_len;                                                                            \
+  }                                                                                                             \
+                                                                                                                \
+  void kernel_fir_block_##sfx(kernel_fir_##sfx##_t *fir_desc, type_t *input, type_t *output)                    \
+  {                                                                                                             \
+    arm_fir_##sfx(&(fir_desc->fir_instance), input, output, fir_desc->block_len);                               \
+  }
+
+DSP_KERNELS_DEFINE(q15_t, q15)
+DSP_KERNELS_DEFINE(q31_t, q31)
+DSP_KERNELS_DEFINE(float32_t, f32)
@@ -0,0 +1,370 @@
+/*
+*********************************************************************
+*
+*   Event trace
+*
+*   A RAM ring of 8 byte records (cycle counter, event id, argument)
+*   that tasks and interrupts write in a few cycles each, without
+*   locks: the slot is claimed with an exclusive load / store on head,
+*   so an interrupt that writes between the claim and the store of a
+*   task just takes the next slot. The ring keeps the newest records;
+*   stopped, it is sent as 32 bit words on an ITM stimulus port, which
+*   the SWO trace of STM32_SWO.ini carries to the debug probe:
+*
+*     word    "ETRC" (0x43525445)
+*     word    cycles per second
+*     word    number of names, then per name:
+*       word    event number << 16 | length, then the characters,
+*               padded with zeros to whole words
+*     word    number of records, then per record:
+*       word    cycles
+*       word    id | arg << 16
+*
+*   Compiled on a PC with EVENT_TRACE_EXPORT and DSP_HOST_BUILD
+*   defined the file converts a capture of the SWO stream (or of the
+*   words alone) to the Chrome trace JSON format, for chrome://tracing
+*   or ui.perfetto.dev; every event number gets its own row:
+*
+*     gcc -O2 -DDSP_HOST_BUILD -DEVENT_TRACE_EXPORT -Ihost -Iinclude
+*         src/event_trace.c -o trace_export
+*     ./trace_export swo.bin trace.json
+*
+*********************************************************************
+*/
+
+#include <stdio.h>
+
+#include "arm_math.h"
+#include "cycle_counter.h"
+#include "event_trace.h"
+
+#define EVENT_TRACE_MAGIC (0x43525445u)
+
+void event_trace_init(event_trace_t *trace, event_trace_record_t *buffer, uint32_t size)
+{
+  trace->buffer = buffer;
+  trace->mask = size - 1u;
+  trace->head = 0;
+  trace->enabled = 1;
+}
+
+void event_trace_stop(event_trace_t *trace)
+{
+  trace->enabled = 0;
+}
+
+void event_trace_start(event_trace_t *trace)
+{
+  trace->enabled = 1;
+}
+
+#ifndef DSP_HOST_BUILD
+
+#define EVENT_TRACE_ITM_STIM(port) (*(volatile uint32_t *)(0xE0000000u + 4u * (port)))
+#define EVENT_TRACE_ITM_TER        (*(volatile uint32_t *)0xE0000E00u)
+#define EVENT_TRACE_ITM_TCR        (*(volatile uint32_t *)0xE0000E80u)
+
+static void event_trace_itm_word(uint32_t port, uint32_t word)
+{
+  // reads as 1 once the stimulus FIFO takes another word
+  while (EVENT_TRACE_ITM_STIM(port) == 0)
+  {
+  }
+  EVENT_TRACE_ITM_STIM(port) = word;
+}
+
+uint32_t event_trace_dump_itm(const event_trace_t *trace, uint32_t port, uint32_t cycles_per_sec,
+                              const char *const *names, uint32_t num_names)
+{
+  const event_trace_record_t *record;
+  uint32_t head = trace->head;
+  uint32_t size = trace->mask + 1u;
+  uint32_t count = (head < size) ? head : size;
+  uint32_t named = 0;
+  uint32_t n, k, length, word;
+
+  if (!(EVENT_TRACE_ITM_TCR & 1u) || !(EVENT_TRACE_ITM_TER & (1u << port)))
+  {
+    return 0;
+  }
+
+  event_trace_itm_word(port, EVENT_TRACE_MAGIC);
+  event_trace_itm_word(port, cycles_per_sec);
+  for (n = 0; n < num_names; n++)
+  {
+    named += (names[n] != NULL);
+  }
+  event_trace_itm_word(port, named);
+  for (n = 0; n < num_names; n++)
+  {
+    if (names[n] == NULL)
+    {
+      continue;
+    }
+    length = strlen(names[n]);
+    event_trace_itm_word(port, (n << 16) | length);
+    for (k = 0; k < length; k += 4u)
+    {
+      word = 0;
+      memcpy(&word, names[n] + k, (length - k < 4u) ? length - k : 4u);
+      event_trace_itm_word(port, word);
+    }
+  }
+
+  event_trace_itm_word(port, count);
+  for (k = head - count; k != head; k++)
+  {
+    record = &trace->buffer[k & trace->mask];
+    event_trace_itm_word(port, record->cycles);
+    event_trace_itm_word(port, record->id | ((uint32_t)record->arg << 16));
+  }
+  return count;
+}
+
+#endif
+
+#if defined(DSP_HOST_BUILD) && defined(EVENT_TRACE_EXPORT)
+
+/*
+*********************************************************************
+*
+*   Chrome trace exporter
+*
+*   The SWO stream is a sequence of ITM packets: a header byte, for
+*   software stimulus packets port << 3 | size (1, 2 or 4 bytes as 1,
+*   2 or 3), followed by the payload; sync, overflow, timestamp and
+*   hardware source packets in between are skipped. The payload of
+*   the dump port is collected and searched for the dump.
+*
+*********************************************************************
+*/
+
+#include <stdlib.h>
+#include <string.h>
+
+#define EXPORT_MAX_EVENTS (EVENT_TRACE_ID + 1u)
+
+typedef struct
+{
+  char *name[EXPORT_MAX_EVENTS];
+  uint32_t count[EXPORT_MAX_EVENTS];
+  uint32_t span_max[EXPORT_MAX_EVENTS];     // longest begin to end, cycles
+  uint64_t begin_at[EXPORT_MAX_EVENTS];
+  uint8_t open[EXPORT_MAX_EVENTS];
+} export_events_t;
+
+static uint32_t export_itm_payload(const uint8_t *capture, uint32_t len, uint32_t port, uint8_t *payload)
+{
+  static const uint32_t sizes[4] = { 0, 1, 2, 4 };
+  uint32_t k = 0, out = 0;
+  uint32_t header, size;
+
+  while (k < len)
+  {
+    header = capture[k++];
+    if ((header & 0x03u) != 0)
+    {
+      // stimulus (bit 2 clear) or hardware source packet
+      size = sizes[header & 0x03u];
+      if ((k + size <= len) && !(header & 0x04u) && ((header >> 3) == port))
+      {
+        memcpy(payload + out, capture + k, size);
+        out += size;
+      }
+      k += size;
+    }
+    else if ((header & 0x80u) && (header != 0x80u))
+    {
+      // timestamp or extension packet with continuation bytes
+      while ((k < len) && (capture[k++] & 0x80u))
+      {
+      }
+    }
+    // else sync (0x00, 0x80 ends it) or overflow (0x70)
+  }
+  return out;
+}
+
+static uint32_t export_word(const uint8_t *data)
+{
+  return (uint32_t)data[0] | ((uint32_t)data[1] << 8) | ((uint32_t)data[2] << 16) | ((uint32_t)data[3] << 24);
+}
+
+static void export_name(FILE *json, const export_events_t *events, uint32_t number)
+{
+  if (events->name[number] != NULL)
+    fprintf(json, "\"%s\"", events->name[number]);
+  else
+    fprintf(json, "\"event %u\"", (unsigned)number);
+}
+
+int main(int argc, char **argv)
+{
+  static export_events_t events;
+  uint8_t *capture, *data;
+  uint32_t port = EVENT_TRACE_ITM_PORT, raw = 0;
+  uint32_t len, at, cycles_per_sec, named, count, n, k, word, id, number, length;
+  uint32_t cycles, last_cycles = 0;
+  uint64_t now = 0;
+  const char *kind;
+  FILE *file, *json;
+  long size;
+  int argi;
+
+  if (argc < 3)
+  {
+    fprintf(stderr, "usage: trace_export <swo capture> <trace.json> [port=n] [raw]\n");
+    return 2;
+  }
+  for (argi = 3; argi < argc; argi++)
+  {
+    if (strncmp(argv[argi], "port=", 5) == 0)
+      port = (uint32_t)strtoul(argv[argi] + 5, NULL, 0);
+    else if (strcmp(argv[argi], "raw") == 0)
+      raw = 1;
+    else
+    {
+      fprintf(stderr, "unknown option %s\n", argv[argi]);
+      return 2;
+    }
+  }
+
+  file = fopen(argv[1], "rb");
+  if ((file == NULL) || (fseek(file, 0, SEEK_END) != 0) || ((size = ftell(file)) <= 0))
+  {
+    fprintf(stderr, "cannot read %s\n", argv[1]);
+    return 2;
+  }
+  rewind(file);
+  capture = malloc((size_t)size);
+  data = malloc((size_t)size);
+  if ((capture == NULL) || (data == NULL) || (fread(capture, 1, (size_t)size, file) != (size_t)size))
+  {
+    fprintf(stderr, "cannot read %s\n", argv[1]);
+    return 2;
+  }
+  fclose(file);
+
+  if (raw)
+  {
+    memcpy(data, capture, (size_t)size);
+    len = (uint32_t)size;
+  }
+  else
+  {
+    len = export_itm_payload(capture, (uint32_t)size, port, data);
+  }
+
+  for (at = 0; (at + 16u <= len) && (export_word(data + at) != EVENT_TRACE_MAGIC); at++)
+  {
+  }
+  if (at + 16u > len)
+  {
+    fprintf(stderr, "no trace dump in %s (port %u)\n", argv[1], (unsigned)port);
+    return 1;
+  }
+  cycles_per_sec = export_word(data + at + 4u);
+  named = export_word(data + at + 8u);
+  at += 12u;
+  for (n = 0; (n < named) && (at + 4u <= len); n++)
+  {
+    word = export_word(data + at);
+    number = (word >> 16) & EVENT_TRACE_ID;
+    length = word & 0xFFFFu;
+    at += 4u;
+    if (at + length > len)
+      break;
+    free(events.name[number]);
+    events.name[number] = malloc(length + 1u);
+    memcpy(events.name[number], data + at, length);
+    events.name[number][length] = '\0';
+    at += (length + 3u) & ~3u;
+  }
+  if ((n < named) || (at + 4u > len) || (cycles_per_sec == 0))
+  {
+    fprintf(stderr, "truncated trace dump\n");
+    return 1;
+  }
+  count = export_word(data + at);
+  at += 4u;
+  if ((uint64_t)count * 8u > len - at)
+  {
+    fprintf(stderr, "truncated trace dump: %u of %u records\n", (unsigned)((len - at) / 8u), (unsigned)count);
+    count = (len - at) / 8u;
+  }
+
+  json = fopen(argv[2], "w");
+  if (json == NULL)
+  {
+    fprintf(stderr, "cannot create %s\n", argv[2]);
+    return 2;
+  }
+  fprintf(json, "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[\n");
+  fprintf(json, "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,\"args\":{\"name\":\"target\"}}");
+  for (number = 0; number < EXPORT_MAX_EVENTS; number++)
+  {
+    if (events.name[number] != NULL)
+    {
+      fprintf(json, ",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%u,\"args\":{\"name\":", (unsigned)number);
+      export_name(json, &events, number);
+      fprintf(json, "}}");
+    }
+  }
+
+  for (k = 0; k < count; k++, at += 8u)
+  {
+    cycles = export_word(data + at);
+    word = export_word(data + at + 4u);
+    id = word & 0xFFFFu;
+    number = id & EVENT_TRACE_ID;
+
+    // 64 bit time line; writers that interrupted each other may step back a little
+    now = (k == 0) ? 0 : now + (int64_t)(int32_t)(cycles - last_cycles);
+    last_cycles = cycles;
+
+    switch (id & EVENT_TRACE_KIND)
+    {
+      case EVENT_TRACE_BEGIN:
+        kind = "B";
+        events.begin_at[number] = now;
+        events.open[number] = 1;
+        break;
+      case EVENT_TRACE_END:
+        kind = "E";
+        if (events.open[number] && (now - events.begin_at[number] > events.span_max[number]))
+          events.span_max[number] = (uint32_t)(now - events.begin_at[number]);
+        events.open[number] = 0;
+        break;
+      case EVENT_TRACE_COUNTER:
+        kind = "C";
+        break;
+      default:
+        kind = "i";
+        break;
+    }
+    events.count[number]++;
+
+    fprintf(json, ",\n{\"name\":");
+    export_name(json, &events, number);
+    fprintf(json, ",\"ph\":\"%s\",\"ts\":%.3f,\"pid\":1,\"tid\":%u,\"args\":{\"%s\":%u}%s}", kind,
+            (double)now * 1e6 / cycles_per_sec, (unsigned)number, (*kind == 'C') ? "value" : "arg",
+            (unsigned)(word >> 16), (*kind == 'i') ? ",\"s\":\"t\"" : "");
+  }
+  fprintf(json, "\n]}\n");
+  fclose(json);
+
+  printf("%u records over %.3f ms\n", (unsigned)count, (double)now * 1e3 / cycles_per_sec);
+  for (number = 0; number < EXPORT_MAX_EVENTS; number++)
+  {
+    if (events.count[number] > 0)
+    {
+      printf("%-16s %8u", (events.name[number] != NULL) ? events.name[number] : "-", (unsigned)events.count[number]);
+      if (events.span_max[number] > 0)
+        printf("  longest span %.3f us", (double)events.span_max[number] * 1e6 / cycles_per_sec);
+      printf("\n");
+    }
+  }
+  return 0;
+}
+
+#endif
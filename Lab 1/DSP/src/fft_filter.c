@@ -0,0 +1,152 @@
+/*
+*********************************************************************
+*
+*   Overlap-save FFT convolution
+*
+*   The direct form FIR costs num_taps MACs per sample. For long
+*   filters (64 .. 1024 taps) it is cheaper to filter a block at a
+*   time in the frequency domain: transform fft_len input samples
+*   (the new block plus the previous fft_len / 2), multiply by the
+*   spectrum of the taps, transform back and keep the last fft_len / 2
+*   samples, which are free of circular wrap-around.
+*
+*   The samples are q15, the transforms are the radix-4 q31 real FFTs
+*   of CMSIS-DSP. The q15 transforms lose log2(fft_len) bits to their
+*   internal scaling, which would leave little of a q15 result. With
+*   the q31 ones the rounding noise of the transforms stays below
+*   the q15 LSB and the output is within +-1 LSB of arm_fir_q15 with
+*   the same coefficients; dsp_bench_fft_filter reports the largest
+*   difference.
+*
+*   Scaling: the forward transform returns DFT / fft_len, the inverse
+*   returns the IDFT. With the product shifted by 31 - log2(fft_len)
+*   the inverse transform yields y * 2^31 / fft_len, which is shifted
+*   down to q15 with the truncation of arm_fir_q15.
+*
+*********************************************************************
+*/
+
+#include "arm_math.h"
+#include "fft_filter.h"
+
+static uint32_t fft_filter_log2(uint32_t value)
+{
+  uint32_t bits = 0;
+
+  while (value > 1u)
+  {
+    value >>= 1;
+    bits++;
+  }
+  return bits;
+}
+
+/*
+*********************************************************************
+*
+*   Init: coeff is in the time reversed order of arm_fir_q15
+*
+*********************************************************************
+*/
+
+arm_status fft_filter_init_q15(fft_filter_q15_t *fft_filter_desc, uint32_t num_taps, const q15_t *coeff, q31_t *work)
+{
+  uint32_t fft_len, n;
+  arm_status status;
+
+  if ((num_taps < FFT_FILTER_MIN_TAPS) || (num_taps > FFT_FILTER_MAX_TAPS))
+  {
+    return ARM_MATH_ARGUMENT_ERROR;
+  }
+
+  fft_len = FFT_FILTER_FFT_LEN(num_taps);
+
+  fft_filter_desc->num_taps = num_taps;
+  fft_filter_desc->fft_len = fft_len;
+  fft_filter_desc->block_len = fft_len / 2u;
+  fft_filter_desc->spectrum_shift = 31u - fft_filter_log2(fft_len);
+  fft_filter_desc->output_shift = 16u - fft_filter_log2(fft_len);
+  fft_filter_desc->response = work;
+  fft_filter_desc->spectrum = fft_filter_desc->response + fft_len + 2u;
+  fft_filter_desc->time = fft_filter_desc->spectrum + 2u * fft_len;
+  fft_filter_desc->overlap = fft_filter_desc->time + fft_len;
+
+  status = arm_rfft_init_q31(&(fft_filter_desc->rfft_instance), &(fft_filter_desc->cfft_instance), fft_len, 0u, 1u);
+  if (status != ARM_MATH_SUCCESS)
+  {
+    return status;
+  }
+  status = arm_rfft_init_q31(&(fft_filter_desc->rifft_instance), &(fft_filter_desc->cifft_instance), fft_len, 1u, 1u);
+  if (status != ARM_MATH_SUCCESS)
+  {
+    return status;
+  }
+
+  // spectrum of the impulse response, zero padded to fft_len
+  for (n = 0; n < fft_len; n++)
+  {
+    fft_filter_desc->time[n] = (n < num_taps) ? ((q31_t)coeff[num_taps - 1u - n] << 16) : 0;
+  }
+  arm_rfft_q31(&(fft_filter_desc->rfft_instance), fft_filter_desc->time, fft_filter_desc->spectrum);
+  for (n = 0; n < fft_len + 2u; n++)
+  {
+    fft_filter_desc->response[n] = fft_filter_desc->spectrum[n];
+  }
+
+  for (n = 0; n < fft_len / 2u; n++)
+  {
+    fft_filter_desc->overlap[n] = 0;
+  }
+
+  return ARM_MATH_SUCCESS;
+}
+
+/*
+*********************************************************************
+*
+*   Filter one block of block_len samples
+*
+*********************************************************************
+*/
+
+void fft_filter_q15(fft_filter_q15_t *fft_filter_desc, q15_t *input, q15_t *output)
+{
+  uint32_t block_len = fft_filter_desc->block_len;
+  uint32_t spectrum_shift = fft_filter_desc->spectrum_shift;
+  uint32_t output_shift = fft_filter_desc->output_shift;
+  q31_t *time = fft_filter_desc->time;
+  q31_t *spectrum = fft_filter_desc->spectrum;
+  q31_t *response = fft_filter_desc->response;
+  q31_t x_re, x_im, h_re, h_im;
+  uint32_t n;
+
+  // previous block followed by the new one; the transform
+  // overwrites its input, so the new block is saved as well
+  for (n = 0; n < block_len; n++)
+  {
+    time[n] = fft_filter_desc->overlap[n];
+    time[block_len + n] = (q31_t)input[n] << 16;
+    fft_filter_desc->overlap[n] = time[block_len + n];
+  }
+
+  arm_rfft_q31(&(fft_filter_desc->rfft_instance), time, spectrum);
+
+  // only bins 0 .. fft_len / 2 are read by the inverse real transform
+  for (n = 0; n <= 2u * block_len; n += 2u)
+  {
+    x_re = spectrum[n];
+    x_im = spectrum[n + 1u];
+    h_re = response[n];
+    h_im = response[n + 1u];
+    spectrum[n] = clip_q63_to_q31((((q63_t)x_re * h_re) - ((q63_t)x_im * h_im)) >> spectrum_shift);
+    spectrum[n + 1u] = clip_q63_to_q31((((q63_t)x_re * h_im) + ((q63_t)x_im * h_re)) >> spectrum_shift);
+  }
+
+  arm_rfft_q31(&(fft_filter_desc->rifft_instance), spectrum, time);
+
+  // the first half is corrupted by circular wrap-around
+  for (n = 0; n < block_len; n++)
+  {
+    output[n] = (q15_t)__SSAT(time[block_len + n] >> output_shift, 16);
+  }
+}
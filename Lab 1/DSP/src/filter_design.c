@@ -0,0 +1,426 @@
+/*
+*********************************************************************
+*
+*   Windowed-sinc FIR design
+*
+*   Computes low pass and band stop taps for a given tap count and
+*   band edges, windowed with Hamming or Kaiser, normalized to unity
+*   DC gain and quantized to q15 so that the taps still add up to one
+*   (within one LSB). Taps are computed one at a time, so no floating
+*   point buffer is needed.
+*
+*   Compiled on a PC with FILTER_DESIGN_GENERATOR defined (together
+*   with the CMSIS-DSP kernels in host/) the file is a table
+*   generator: it designs and checks a filter and prints the
+*   taps as a const array, so the table can live in flash with no
+*   startup cost. Example:
+*
+*     fir_gen low_pass_filter_coeff lowpass 32 kaiser 1000 10 46.4
+*
+*********************************************************************
+*/
+
+#include <math.h>
+
+#include "arm_math.h"
+#include "filter_design.h"
+
+#define FILTER_DESIGN_GRID (512u)   // frequency points used by the response check
+
+static float32_t sinc_low_pass(float32_t cutoff, float32_t n)
+{
+  if (n == 0.0f)
+  {
+    return 2.0f * cutoff;
+  }
+  return arm_sin_f32(2.0f * PI * cutoff * n) / (PI * n);
+}
+
+// modified Bessel function of the first kind, order zero
+static float32_t bessel_i0(float32_t x)
+{
+  float32_t sum = 1.0f, term = 1.0f;
+  uint32_t k;
+
+  for (k = 1; k < 50; k++)
+  {
+    term *= (x / (2.0f * k)) * (x / (2.0f * k));
+    sum += term;
+    if (term < 1e-8f * sum)
+      break;
+  }
+  return sum;
+}
+
+static float32_t transition_width(const filter_design_spec_t *spec)
+{
+  float32_t width = spec->stop_edge - spec->pass_edge;
+
+  if ((spec->type == FILTER_DESIGN_BAND_STOP) && (spec->pass_edge_high - spec->stop_edge_high < width))
+  {
+    width = spec->pass_edge_high - spec->stop_edge_high;
+  }
+  return width;
+}
+
+/*
+*********************************************************************
+*
+*   Attenuation the window can reach for the given transition width
+*
+*   Kaiser's estimate A = 2.285 * 2pi * df * (N - 1) + 8 dB; the
+*   Hamming window is limited to about 53 dB. A band stop is built
+*   from two low passes whose ripples can add up, which costs 6 dB.
+*   Rounding the taps to q15 leaves a noise floor of roughly
+*   2^-15 * sqrt(N / 12) rms, with peaks about 10 dB above that.
+*
+*********************************************************************
+*/
+
+static float32_t window_attenuation_db(const filter_design_spec_t *spec)
+{
+  float32_t atten = 2.285f * 2.0f * PI * transition_width(spec) * (float32_t)(spec->num_taps - 1) + 8.0f;
+
+  if ((spec->window == FILTER_DESIGN_HAMMING) && (atten > 53.0f))
+  {
+    atten = 53.0f;
+  }
+  return atten;
+}
+
+float32_t filter_design_attenuation_db(const filter_design_spec_t *spec)
+{
+  float32_t atten = window_attenuation_db(spec);
+  float32_t q15_floor = 80.3f - 10.0f * log10f((float32_t)spec->num_taps / 12.0f);
+
+  if (spec->type == FILTER_DESIGN_BAND_STOP)
+  {
+    atten -= 6.0f;
+  }
+  return (atten < q15_floor) ? atten : q15_floor;
+}
+
+static float32_t kaiser_beta(const filter_design_spec_t *spec)
+{
+  float32_t atten;
+
+  if (spec->kaiser_beta > 0.0f)
+  {
+    return spec->kaiser_beta;
+  }
+
+  atten = window_attenuation_db(spec);
+  if (atten > 50.0f)
+    return 0.1102f * (atten - 8.7f);
+  if (atten > 21.0f)
+    return 0.5842f * powf(atten - 21.0f, 0.4f) + 0.07886f * (atten - 21.0f);
+  return 0.0f;
+}
+
+/*
+*********************************************************************
+*
+*   Un-normalized windowed-sinc taps
+*
+*   A band stop needs an odd length (a zero at half the sampling
+*   rate otherwise); with an even num_taps the last tap is left zero.
+*
+*********************************************************************
+*/
+
+typedef struct
+{
+  uint32_t length;
+  float32_t center;
+  float32_t cutoff;
+  float32_t cutoff_high;
+  float32_t beta;
+  float32_t window_norm;
+} filter_design_work_t;
+
+static arm_status design_setup(const filter_design_spec_t *spec, filter_design_work_t *work)
+{
+  uint32_t num_taps = spec->num_taps;
+
+  if ((num_taps < 4) || (num_taps > FILTER_DESIGN_MAX_TAPS) ||
+      (spec->pass_edge <= 0.0f) || (spec->stop_edge <= spec->pass_edge) || (spec->stop_edge >= 0.5f))
+  {
+    return ARM_MATH_ARGUMENT_ERROR;
+  }
+  if ((spec->type == FILTER_DESIGN_BAND_STOP) &&
+      ((spec->stop_edge_high <= spec->stop_edge) || (spec->pass_edge_high <= spec->stop_edge_high) ||
+       (spec->pass_edge_high >= 0.5f)))
+  {
+    return ARM_MATH_ARGUMENT_ERROR;
+  }
+
+  work->length = ((spec->type == FILTER_DESIGN_BAND_STOP) && !(num_taps & 1u)) ? num_taps - 1 : num_taps;
+  work->center = (float32_t)(work->length - 1) / 2.0f;
+  work->cutoff = (spec->pass_edge + spec->stop_edge) / 2.0f;
+  work->cutoff_high = (spec->stop_edge_high + spec->pass_edge_high) / 2.0f;
+  work->beta = kaiser_beta(spec);
+  work->window_norm = bessel_i0(work->beta);
+
+  return ARM_MATH_SUCCESS;
+}
+
+static float32_t design_tap(const filter_design_spec_t *spec, const filter_design_work_t *work, uint32_t k)
+{
+  float32_t n = (float32_t)k - work->center;
+  float32_t x = 2.0f * (float32_t)k / (float32_t)(work->length - 1) - 1.0f;
+  float32_t window, tap;
+
+  if (k >= work->length)
+    return 0.0f;
+
+  if (spec->window == FILTER_DESIGN_KAISER)
+    window = bessel_i0(work->beta * sqrtf(1.0f - x * x)) / work->window_norm;
+  else
+    window = 0.54f - 0.46f * arm_cos_f32(2.0f * PI * (float32_t)k / (float32_t)(work->length - 1));
+
+  if (spec->type == FILTER_DESIGN_BAND_STOP)
+    tap = sinc_low_pass(work->cutoff, n) - sinc_low_pass(work->cutoff_high, n) + ((n == 0.0f) ? 1.0f : 0.0f);
+  else
+    tap = sinc_low_pass(work->cutoff, n);
+
+  return tap * window;
+}
+
+static float32_t design_sum(const filter_design_spec_t *spec, const filter_design_work_t *work)
+{
+  float32_t sum = 0.0f;
+  uint32_t k;
+
+  for (k = 0; k < work->length; k++)
+  {
+    sum += design_tap(spec, work, k);
+  }
+  return sum;
+}
+
+/*
+*********************************************************************
+*
+*   Floating point design, normalized to the wanted DC gain
+*
+*********************************************************************
+*/
+
+arm_status filter_design_fir_f32(const filter_design_spec_t *spec, float32_t *taps)
+{
+  filter_design_work_t work;
+  float32_t sum;
+  uint32_t k;
+  arm_status status;
+
+  status = design_setup(spec, &work);
+  if (status != ARM_MATH_SUCCESS)
+  {
+    return status;
+  }
+
+  sum = design_sum(spec, &work);
+  if (spec->gain > 0.0f)
+  {
+    sum /= spec->gain;
+  }
+  for (k = 0; k < spec->num_taps; k++)
+  {
+    taps[k] = design_tap(spec, &work, k) / sum;
+  }
+
+  return ARM_MATH_SUCCESS;
+}
+
+/*
+*********************************************************************
+*
+*   q15 design
+*
+*   After rounding, the difference between the tap sum and the wanted
+*   gain is moved into the center tap(s), which keeps the DC gain exact
+*   and the filter symmetric.
+*
+*********************************************************************
+*/
+
+arm_status filter_design_fir_q15(const filter_design_spec_t *spec, q15_t *taps)
+{
+  filter_design_work_t work;
+  uint32_t length, k;
+  float32_t gain, scale;
+  q31_t sum = 0, residual, value;
+  arm_status status;
+
+  status = design_setup(spec, &work);
+  if (status != ARM_MATH_SUCCESS)
+  {
+    return status;
+  }
+
+  gain = (spec->gain > 0.0f) ? spec->gain : 1.0f;
+  scale = gain * 32768.0f / design_sum(spec, &work);
+  for (k = 0; k < spec->num_taps; k++)
+  {
+    value = (q31_t)floorf(design_tap(spec, &work, k) * scale + 0.5f);
+    taps[k] = (q15_t)__SSAT(value, 16);
+    sum += taps[k];
+  }
+
+  length = work.length;
+  residual = (q31_t)(gain * 32767.0f + 0.5f) - sum;
+  if (length & 1u)
+  {
+    taps[length / 2] = (q15_t)__SSAT(taps[length / 2] + residual, 16);
+  }
+  else
+  {
+    taps[length / 2 - 1] = (q15_t)__SSAT(taps[length / 2 - 1] + residual / 2, 16);
+    taps[length / 2] = (q15_t)__SSAT(taps[length / 2] + residual / 2, 16);
+  }
+
+  return ARM_MATH_SUCCESS;
+}
+
+/*
+*********************************************************************
+*
+*   Frequency response of q15 taps
+*
+*   frequency is normalized to the sampling frequency.
+*
+*********************************************************************
+*/
+
+float32_t filter_design_response_db(const q15_t *taps, uint32_t num_taps, float32_t frequency)
+{
+  float32_t re = 0.0f, im = 0.0f, magnitude;
+  uint32_t k;
+
+  for (k = 0; k < num_taps; k++)
+  {
+    float32_t phase = 2.0f * PI * frequency * (float32_t)k;
+
+    re += (float32_t)taps[k] * arm_cos_f32(phase);
+    im -= (float32_t)taps[k] * arm_sin_f32(phase);
+  }
+
+  magnitude = sqrtf(re * re + im * im) / 32768.0f;
+  return (magnitude > 1e-10f) ? 20.0f * log10f(magnitude) : -200.0f;
+}
+
+/*
+*********************************************************************
+*
+*   Response check
+*
+*   Passes if the passband stays within +/- ripple_db of the design
+*   gain and the stopband is at least attenuation_db below it, on a
+*   uniform frequency grid.
+*
+*********************************************************************
+*/
+
+arm_status filter_design_check_q15(const filter_design_spec_t *spec, const q15_t *taps,
+                                   float32_t ripple_db, float32_t attenuation_db)
+{
+  float32_t reference = (spec->gain > 0.0f) ? 20.0f * log10f(spec->gain) : 0.0f;
+  uint32_t k;
+
+  for (k = 0; k <= FILTER_DESIGN_GRID; k++)
+  {
+    float32_t f = 0.5f * (float32_t)k / (float32_t)FILTER_DESIGN_GRID;
+    float32_t response = filter_design_response_db(taps, spec->num_taps, f) - reference;
+    int passband, stopband;
+
+    passband = (f <= spec->pass_edge) ||
+               ((spec->type == FILTER_DESIGN_BAND_STOP) && (f >= spec->pass_edge_high));
+    stopband = (f >= spec->stop_edge) &&
+               ((spec->type == FILTER_DESIGN_LOW_PASS) || (f <= spec->stop_edge_high));
+
+    if (passband && (fabsf(response) > ripple_db))
+      return ARM_MATH_TEST_FAILURE;
+    if (stopband && (response > -attenuation_db))
+      return ARM_MATH_TEST_FAILURE;
+  }
+
+  return ARM_MATH_SUCCESS;
+}
+
+#ifdef FILTER_DESIGN_GENERATOR
+
+/*
+*********************************************************************
+*
+*   Table generator
+*
+*   fir_gen <name> lowpass  <taps> <hamming|kaiser> <fs> <f_pass> <f_stop>
+*   fir_gen <name> bandstop <taps> <hamming|kaiser> <fs> <f_pass> <f_stop> <f_stop_high> <f_pass_high>
+*
+*   Frequencies in Hz. The design is checked against 1 dB passband
+*   ripple and the attenuation the window can reach (3 dB margin for
+*   quantization); the exit code is non-zero if the check fails.
+*
+*********************************************************************
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+int main(int argc, char *argv[])
+{
+  static q15_t taps[FILTER_DESIGN_MAX_TAPS];
+  filter_design_spec_t spec;
+  float32_t fs, attenuation;
+  uint32_t k;
+
+  if ((argc < 8) || ((strcmp(argv[2], "bandstop") == 0) && (argc < 10)))
+  {
+    fprintf(stderr, "usage: %s name lowpass|bandstop taps hamming|kaiser fs f_pass f_stop [f_stop_high f_pass_high]\n", argv[0]);
+    return 2;
+  }
+
+  memset(&spec, 0, sizeof(spec));
+  spec.type = (strcmp(argv[2], "bandstop") == 0) ? FILTER_DESIGN_BAND_STOP : FILTER_DESIGN_LOW_PASS;
+  spec.num_taps = (uint32_t)atoi(argv[3]);
+  spec.window = (strcmp(argv[4], "kaiser") == 0) ? FILTER_DESIGN_KAISER : FILTER_DESIGN_HAMMING;
+  fs = (float32_t)atof(argv[5]);
+  spec.pass_edge = (float32_t)atof(argv[6]) / fs;
+  spec.stop_edge = (float32_t)atof(argv[7]) / fs;
+  if (spec.type == FILTER_DESIGN_BAND_STOP)
+  {
+    spec.stop_edge_high = (float32_t)atof(argv[8]) / fs;
+    spec.pass_edge_high = (float32_t)atof(argv[9]) / fs;
+  }
+
+  if (filter_design_fir_q15(&spec, taps) != ARM_MATH_SUCCESS)
+  {
+    fprintf(stderr, "%s: invalid filter specification\n", argv[0]);
+    return 1;
+  }
+
+  attenuation = filter_design_attenuation_db(&spec) - 3.0f;
+  if (filter_design_check_q15(&spec, taps, 1.0f, attenuation) != ARM_MATH_SUCCESS)
+  {
+    fprintf(stderr, "%s: response check failed (1 dB ripple, %.1f dB attenuation)\n", argv[0], attenuation);
+    return 1;
+  }
+
+  printf("// generated by fir_gen:");
+  for (k = 1; k < (uint32_t)argc; k++)
+  {
+    printf(" %s", argv[k]);
+  }
+  printf("\n// stopband attenuation >= %.1f dB\n", attenuation);
+  printf("const q15_t %s[%u] =\n{\n", argv[1], (unsigned)spec.num_taps);
+  for (k = 0; k < spec.num_taps; k++)
+  {
+    printf("%s0x%04X,%s", (k % 8) ? " " : "  ", (unsigned)(uint16_t)taps[k], ((k % 8) == 7) ? "\n" : "");
+  }
+  printf("%s};\n", (spec.num_taps % 8) ? "\n" : "");
+
+  return 0;
+}
+
+#endif
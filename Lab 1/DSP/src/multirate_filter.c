@@ -0,0 +1,127 @@
+/*
+*********************************************************************
+*
+*   Polyphase decimator and interpolator
+*
+*   Lets a pipeline run its heavy processing at a reduced rate:
+*   decimate the input by M, filter at R/M, interpolate back by M.
+*   Both stages use the polyphase FIR kernels of CMSIS-DSP, which only
+*   compute the outputs that are kept (decimator) and skip the zero
+*   samples of the upsampled signal (interpolator). Each stage costs
+*   MULTIRATE_TAPS_PER_PHASE MACs per sample at the full rate.
+*
+*   The anti-aliasing / anti-imaging taps are designed at init with
+*   filter_design.c: passband up to a quarter of the reduced rate,
+*   stopband from its Nyquist frequency.
+*
+*********************************************************************
+*/
+
+#include "arm_math.h"
+#include "filter_design.h"
+#include "multirate_filter.h"
+
+static arm_status multirate_design(uint32_t factor, float32_t gain, q15_t *coeff)
+{
+  filter_design_spec_t spec;
+
+  if ((factor < 2) || (factor > MULTIRATE_MAX_FACTOR))
+  {
+    return ARM_MATH_ARGUMENT_ERROR;
+  }
+
+  spec.type = FILTER_DESIGN_LOW_PASS;
+  spec.window = FILTER_DESIGN_KAISER;
+  spec.num_taps = MULTIRATE_COEFF_LEN(factor);
+  spec.pass_edge = 0.25f / (float32_t)factor;
+  spec.stop_edge = 0.5f / (float32_t)factor;
+  spec.stop_edge_high = 0.0f;
+  spec.pass_edge_high = 0.0f;
+  spec.kaiser_beta = 0.0f;
+  spec.gain = gain;
+
+  return filter_design_fir_q15(&spec, coeff);
+}
+
+/*
+*********************************************************************
+*
+*   Decimator: block_len inputs -> block_len / factor outputs
+*
+*********************************************************************
+*/
+
+arm_status multirate_decimator_init_q15(multirate_decimator_q15_t *decimator_desc, uint32_t factor,
+                                        q15_t *coeff, q15_t *state, uint32_t block_len)
+{
+  arm_status status;
+
+  if (block_len % factor)
+  {
+    return ARM_MATH_LENGTH_ERROR;
+  }
+
+  status = multirate_design(factor, 1.0f, coeff);
+  if (status != ARM_MATH_SUCCESS)
+  {
+    return status;
+  }
+
+  decimator_desc->factor = factor;
+  decimator_desc->block_len = block_len;
+
+  return arm_fir_decimate_init_q15(&(decimator_desc->decimate_instance), MULTIRATE_COEFF_LEN(factor),
+                                   (uint8_t)factor, coeff, state, block_len);
+}
+
+void multirate_decimate_q15(multirate_decimator_q15_t *decimator_desc, q15_t *input, q15_t *output)
+{
+  arm_fir_decimate_q15(&(decimator_desc->decimate_instance), input, output, decimator_desc->block_len);
+}
+
+/*
+*********************************************************************
+*
+*   Interpolator: block_len inputs -> block_len * factor outputs
+*
+*   Zero stuffing leaves 1/factor of the signal energy in the wanted
+*   image, so the taps are designed with a DC gain of factor.
+*
+*********************************************************************
+*/
+
+arm_status multirate_interpolator_init_q15(multirate_interpolator_q15_t *interpolator_desc, uint32_t factor,
+                                           q15_t *coeff, q15_t *state, uint32_t block_len)
+{
+  arm_status status;
+
+  status = multirate_design(factor, (float32_t)factor, coeff);
+  if (status != ARM_MATH_SUCCESS)
+  {
+    return status;
+  }
+
+  interpolator_desc->factor = factor;
+  interpolator_desc->block_len = block_len;
+
+  return arm_fir_interpolate_init_q15(&(interpolator_desc->interpolate_instance), (uint8_t)factor,
+                                      MULTIRATE_COEFF_LEN(factor), coeff, state, block_len);
+}
+
+void multirate_interpolate_q15(multirate_interpolator_q15_t *interpolator_desc, q15_t *input, q15_t *output)
+{
+  arm_fir_interpolate_q15(&(interpolator_desc->interpolate_instance), input, output, interpolator_desc->block_len);
+}
+
+/*
+*********************************************************************
+*
+*   MACs of one stage, per sample at the full rate
+*
+*********************************************************************
+*/
+
+uint32_t multirate_macs_per_input(uint32_t factor)
+{
+  return MULTIRATE_COEFF_LEN(factor) / factor;
+}
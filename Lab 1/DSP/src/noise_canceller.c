@@ -0,0 +1,174 @@
+/*
+*********************************************************************
+*
+*   Adaptive noise canceller
+*
+*   The low pass filter separates signal and noise by frequency, so it
+*   also attenuates and delays the signal and fails when the noise is
+*   close to the signal band. Here the noise reference itself is
+*   filtered by a normalized LMS filter (arm_lms_norm_q15/q31) that
+*   adapts until its output matches the noise contained in the
+*   primary input; the error of the adaptation, primary minus the
+*   noise estimate, is the cleaned signal. Against a tonal reference
+*   the filter behaves like a notch centred on the noise frequency
+*   whose width follows the step size.
+*
+*   The q31 kind converts each block and adapts with q31 coefficients;
+*   the q15 kind stalls at small step sizes once the coefficient
+*   update falls below one LSB.
+*
+*   Metrics: the mean square of the reference and of the noise left
+*   in the output, averaged over NOISE_CANCELLER_AVERAGE samples, and
+*   the sample count at which the residual first falls
+*   NOISE_CANCELLER_TARGET_DB below the reference.
+*
+*********************************************************************
+*/
+
+#include <math.h>
+
+#include "arm_math.h"
+#include "noise_canceller.h"
+
+static float32_t noise_canceller_mean_square(const q15_t *block, uint32_t len)
+{
+  float32_t sum = 0.0f;
+  uint32_t n;
+
+  for (n = 0; n < len; n++)
+  {
+    sum += (float32_t)block[n] * (float32_t)block[n];
+  }
+  return sum / ((float32_t)len * 32768.0f * 32768.0f);
+}
+
+static void noise_canceller_update_stats(noise_canceller_q15_t *canceller_desc, const q15_t *reference,
+                                         const q15_t *output, const q15_t *wanted)
+{
+  noise_canceller_stats_t *stats = &(canceller_desc->stats);
+  uint32_t block_len = canceller_desc->block_len;
+  float32_t alpha, residual, sum;
+  uint32_t n;
+
+  alpha = (block_len >= NOISE_CANCELLER_AVERAGE) ? 1.0f : (float32_t)block_len / (float32_t)NOISE_CANCELLER_AVERAGE;
+
+  // without the wanted signal the whole output counts as residual,
+  // which is only meaningful while the primary carries noise alone
+  if (wanted)
+  {
+    sum = 0.0f;
+    for (n = 0; n < block_len; n++)
+    {
+      residual = (float32_t)output[n] - (float32_t)wanted[n];
+      sum += residual * residual;
+    }
+    residual = sum / ((float32_t)block_len * 32768.0f * 32768.0f);
+  }
+  else
+  {
+    residual = noise_canceller_mean_square(output, block_len);
+  }
+
+  stats->reference_power += alpha * (noise_canceller_mean_square(reference, block_len) - stats->reference_power);
+  stats->residual_power += alpha * (residual - stats->residual_power);
+  stats->samples += block_len;
+
+  if ((stats->converged_at == 0) && (stats->samples >= NOISE_CANCELLER_AVERAGE) &&
+      (stats->residual_power * powf(10.0f, NOISE_CANCELLER_TARGET_DB / 10.0f) <= stats->reference_power))
+  {
+    stats->converged_at = stats->samples;
+  }
+}
+
+/*
+*********************************************************************
+*
+*   Init
+*
+*   step_size is the normalized LMS step (0 .. 1); larger adapts
+*   faster but leaves more excess error and a wider notch.
+*
+*********************************************************************
+*/
+
+arm_status noise_canceller_init(noise_canceller_q15_t *canceller_desc, noise_canceller_kind_t kind, uint32_t num_taps,
+                                float32_t step_size, q31_t *work, uint32_t block_len)
+{
+  uint32_t n;
+
+  if ((num_taps < 2) || (num_taps > NOISE_CANCELLER_MAX_TAPS) || (step_size <= 0.0f) || (step_size >= 1.0f))
+  {
+    return ARM_MATH_ARGUMENT_ERROR;
+  }
+
+  canceller_desc->kind = kind;
+  canceller_desc->block_len = block_len;
+  canceller_desc->scratch = work + num_taps + block_len - 1;
+
+  canceller_desc->stats.samples = 0;
+  canceller_desc->stats.converged_at = 0;
+  canceller_desc->stats.reference_power = 0.0f;
+  canceller_desc->stats.residual_power = 0.0f;
+
+  for (n = 0; n < NOISE_CANCELLER_MAX_TAPS; n++)
+  {
+    canceller_desc->coeff[n] = 0;
+  }
+
+  if (kind == NOISE_CANCELLER_Q31)
+  {
+    arm_lms_norm_init_q31(&(canceller_desc->lms_q31_instance), (uint16_t)num_taps, canceller_desc->coeff, work,
+                          (q31_t)(step_size * 2147483648.0f), block_len, 0);
+  }
+  else
+  {
+    arm_lms_norm_init_q15(&(canceller_desc->lms_q15_instance), (uint16_t)num_taps, (q15_t *)canceller_desc->coeff,
+                          (q15_t *)work, (q15_t)(step_size * 32768.0f), block_len, 0);
+  }
+
+  return ARM_MATH_SUCCESS;
+}
+
+/*
+*********************************************************************
+*
+*   Process one block
+*
+*   primary:   signal plus noise
+*   reference: the noise source
+*   output:    primary with the noise estimate removed
+*   wanted:    the clean signal when known (for the residual metric), or NULL
+*
+*********************************************************************
+*/
+
+void noise_canceller_block(noise_canceller_q15_t *canceller_desc, q15_t *primary, q15_t *reference,
+                           q15_t *output, const q15_t *wanted)
+{
+  uint32_t block_len = canceller_desc->block_len;
+  q31_t *scratch = canceller_desc->scratch;
+
+  if (canceller_desc->kind == NOISE_CANCELLER_Q31)
+  {
+    arm_q15_to_q31(primary, &scratch[0], block_len);
+    arm_q15_to_q31(reference, &scratch[block_len], block_len);
+    arm_lms_norm_q31(&(canceller_desc->lms_q31_instance), &scratch[block_len], &scratch[0],
+                     &scratch[2 * block_len], &scratch[3 * block_len], block_len);
+    arm_q31_to_q15(&scratch[3 * block_len], output, block_len);
+  }
+  else
+  {
+    arm_lms_norm_q15(&(canceller_desc->lms_q15_instance), reference, primary, (q15_t *)scratch, output, block_len);
+  }
+
+  noise_canceller_update_stats(canceller_desc, reference, output, wanted);
+}
+
+float32_t noise_canceller_rejection_db(const noise_canceller_stats_t *stats)
+{
+  if (stats->residual_power <= 0.0f)
+  {
+    return 200.0f;
+  }
+  return 10.0f * log10f(stats->reference_power / stats->residual_power);
+}
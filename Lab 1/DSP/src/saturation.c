@@ -0,0 +1,144 @@
+/*
+*********************************************************************
+*
+*   Saturating q15 arithmetic with instrumentation
+*
+*   Plain C arithmetic on q15 values wraps around when the result
+*   leaves -32768 .. 32767, turning a small overload into a full
+*   scale spike at the filter input. These primitives saturate
+*   instead (SSAT) and count every clipped result, track the peak
+*   magnitude and derive the headroom left, so stage gains can be
+*   chosen from measurements.
+*
+*********************************************************************
+*/
+
+#include "arm_math.h"
+#include "saturation.h"
+
+static void saturation_peak(saturation_stats_t *stats, uint32_t peak)
+{
+  if (peak > stats->peak)
+  {
+    stats->peak = peak;
+    // bits between the peak and bit 15; a peak of 16384 or more leaves none
+    stats->headroom_bits = (peak >= 0x4000u) ? 0 : __CLZ(peak) - 17u;
+  }
+}
+
+static __inline q15_t saturation_clip(saturation_stats_t *stats, q31_t value, uint32_t *peak)
+{
+  q31_t result = __SSAT(value, 16);
+  uint32_t magnitude = (uint32_t)((result < 0) ? -result : result);
+
+  if (result != value)
+  {
+    stats->clips++;
+  }
+  if (magnitude > *peak)
+  {
+    *peak = magnitude;
+  }
+  return (q15_t)result;
+}
+
+void saturation_stats_reset(saturation_stats_t *stats)
+{
+  stats->samples = 0;
+  stats->clips = 0;
+  stats->peak = 0;
+  stats->headroom_bits = 15;
+}
+
+/*
+*********************************************************************
+*
+*   Add
+*
+*********************************************************************
+*/
+
+q15_t saturation_add_q15(saturation_stats_t *stats, q15_t a, q15_t b)
+{
+  uint32_t peak = 0;
+  q15_t result = saturation_clip(stats, (q31_t)a + (q31_t)b, &peak);
+
+  stats->samples++;
+  saturation_peak(stats, peak);
+  return result;
+}
+
+void saturation_add_block_q15(saturation_stats_t *stats, const q15_t *a, const q15_t *b, q15_t *output, uint32_t len)
+{
+  uint32_t peak = 0;
+  uint32_t n;
+
+  for (n = 0; n < len; n++)
+  {
+    output[n] = saturation_clip(stats, (q31_t)a[n] + (q31_t)b[n], &peak);
+  }
+  stats->samples += len;
+  saturation_peak(stats, peak);
+}
+
+/*
+*********************************************************************
+*
+*   Scale
+*
+*********************************************************************
+*/
+
+q15_t saturation_scale_q15(saturation_stats_t *stats, q15_t x, q15_t scale_fract, int8_t shift)
+{
+  uint32_t peak = 0;
+  q15_t result = saturation_clip(stats, ((q31_t)x * scale_fract) >> (15 - shift), &peak);
+
+  stats->samples++;
+  saturation_peak(stats, peak);
+  return result;
+}
+
+void saturation_scale_block_q15(saturation_stats_t *stats, const q15_t *input, q15_t scale_fract, int8_t shift,
+                                q15_t *output, uint32_t len)
+{
+  uint32_t peak = 0;
+  uint32_t n;
+
+  for (n = 0; n < len; n++)
+  {
+    output[n] = saturation_clip(stats, ((q31_t)input[n] * scale_fract) >> (15 - shift), &peak);
+  }
+  stats->samples += len;
+  saturation_peak(stats, peak);
+}
+
+/*
+*********************************************************************
+*
+*   Track a stream without modifying it: a sample on either rail
+*   counts as a clip, since the producer has most likely saturated it
+*
+*********************************************************************
+*/
+
+void saturation_track_block_q15(saturation_stats_t *stats, const q15_t *input, uint32_t len)
+{
+  uint32_t peak = 0;
+  uint32_t magnitude, n;
+
+  for (n = 0; n < len; n++)
+  {
+    magnitude = (uint32_t)((input[n] < 0) ? -(q31_t)input[n] : (q31_t)input[n]);
+    if (magnitude >= 32767u)
+    {
+      stats->clips++;
+    }
+    if (magnitude > peak)
+    {
+      peak = magnitude;
+    }
+  }
+  stats->samples += len;
+  saturation_peak(stats, peak);
+}
@@ -0,0 +1,586 @@
+/*
+*********************************************************************
+*
+*   Offline signal chain
+*
+*   The DirtyFilter.c chain without the tasks: both generators, the
+*   gain stages, the saturating mixer and the low pass filter (or the
+*   noise canceller), run block by block in the order of the block
+*   pipeline (PIPELINE_MODE 1). The per-sample pipeline produces the
+*   same filtered stream delayed by one block, due to its ping-pong
+*   buffer. The gain, mixer and filter stages are the functions the
+*   DirtyFilter.c tasks call, so the golden vectors check the code
+*   the target runs; only the order of the calls is repeated here.
+*
+*   Compiled on a PC with SIGNAL_CHAIN_HARNESS and DSP_HOST_BUILD
+*   defined the file is a regression and throughput harness (see the
+*   end of the file):
+*
+*     gcc -O2 -ffp-contract=off -DDSP_HOST_BUILD -DSIGNAL_CHAIN_HARNESS
+*         -Ihost -Iinclude src/signal_chain.c src/sine_generator.c
+*         src/low_pass_filter.c src/filter_design.c src/noise_canceller.c
+*         src/saturation.c host/arm_math_host.c -o chain_harness -lm
+*
+*********************************************************************
+*/
+
+#include "arm_math.h"
+#include "sine_generator.h"
+#include "low_pass_filter.h"
+#include "noise_canceller.h"
+#include "saturation.h"
+#include "signal_chain.h"
+
+void signal_chain_default_config(signal_chain_config_t *config)
+{
+  config->sampling_frequency = 1000;
+  config->signal_frequency = 10;
+  config->noise_frequency = 50;
+  config->signal_gain = 500;
+  config->noise_gain = 167;
+  config->generator_mode = 0;
+  config->filter_kind = LOW_PASS_FILTER_FIR_Q15;
+  config->noise_canceller = 0;
+  config->canceller_taps = 16;
+  config->canceller_step = 20;
+  config->block_len = 1;
+}
+
+arm_status signal_chain_init(signal_chain_q15_t *chain_desc, const signal_chain_config_t *config)
+{
+  uint32_t stream;
+
+  if ((config->block_len == 0) || (config->block_len > LOW_PASS_FILTER_MAX_BLOCK) ||
+      (2 * config->signal_frequency >= config->sampling_frequency) ||
+      (2 * config->noise_frequency >= config->sampling_frequency) ||
+      (config->signal_gain >= 4000) || (config->noise_gain >= 4000) ||
+      (config->generator_mode > 1) || (config->filter_kind > LOW_PASS_FILTER_BIQUAD_Q31) ||
+      (config->noise_canceller > 2))
+  {
+    return ARM_MATH_ARGUMENT_ERROR;
+  }
+
+  chain_desc->config = *config;
+  chain_desc->signal_scale = SIGNAL_CHAIN_GAIN_SCALE(config->signal_gain);
+  chain_desc->noise_scale = SIGNAL_CHAIN_GAIN_SCALE(config->noise_gain);
+
+  if (config->generator_mode == 0)
+  {
+    sine_generator_init_q15(&(chain_desc->signal_iir), config->signal_frequency, config->sampling_frequency);
+    sine_generator_init_q15(&(chain_desc->noise_iir), config->noise_frequency, config->sampling_frequency);
+  }
+  else
+  {
+    sine_generator_nco_init_q15(&(chain_desc->signal_nco), config->signal_frequency, config->sampling_frequency);
+    sine_generator_nco_init_q15(&(chain_desc->noise_nco), config->noise_frequency, config->sampling_frequency);
+  }
+
+  if (config->noise_canceller)
+  {
+    if (noise_canceller_init(&(chain_desc->canceller), (noise_canceller_kind_t)(config->noise_canceller - 1),
+                             config->canceller_taps, config->canceller_step / 10000.0f,
+                             chain_desc->canceller_work, config->block_len) != ARM_MATH_SUCCESS)
+    {
+      return ARM_MATH_ARGUMENT_ERROR;
+    }
+  }
+  else
+  {
+    low_pass_filter_block_init(&(chain_desc->filter), (low_pass_filter_kind_t)config->filter_kind,
+                               chain_desc->filter_state, config->block_len);
+  }
+
+  for (stream = 0; stream < SIGNAL_CHAIN_STREAMS; stream++)
+  {
+    saturation_stats_reset(&(chain_desc->stats[stream]));
+  }
+
+  return ARM_MATH_SUCCESS;
+}
+
+/*
+*********************************************************************
+*
+*   Stages
+*
+*********************************************************************
+*/
+
+q15_t signal_chain_gain_q15(saturation_stats_t *stats, q15_t sample, q15_t scale_fract)
+{
+  return saturation_scale_q15(stats, sample, scale_fract, SIGNAL_CHAIN_GAIN_SHIFT);
+}
+
+void signal_chain_gain_block_q15(saturation_stats_t *stats, q15_t *block, q15_t scale_fract, uint32_t len)
+{
+  saturation_scale_block_q15(stats, block, scale_fract, SIGNAL_CHAIN_GAIN_SHIFT, block, len);
+}
+
+q15_t signal_chain_mix_q15(saturation_stats_t *stats, q15_t sine, q15_t noise)
+{
+  return saturation_add_q15(stats, sine, noise);
+}
+
+void signal_chain_mix_block_q15(saturation_stats_t *stats, const q15_t *sine, const q15_t *noise, q15_t *disturbed,
+                                uint32_t len)
+{
+  saturation_add_block_q15(stats, sine, noise, disturbed, len);
+}
+
+void signal_chain_filter_block_q15(low_pass_filter_q15_t *filter, noise_canceller_q15_t *canceller,
+                                   saturation_stats_t *stats, q15_t *disturbed, q15_t *noise, q15_t *sine,
+                                   q15_t *filtered, uint32_t len)
+{
+  if (canceller != NULL)
+  {
+    noise_canceller_block(canceller, disturbed, noise, filtered, sine);
+  }
+  else
+  {
+    low_pass_filter_block(filter, disturbed, filtered);
+  }
+  saturation_track_block_q15(stats, filtered, len);
+}
+
+void signal_chain_block(signal_chain_q15_t *chain_desc, q15_t *sine, q15_t *noise, q15_t *disturbed,
+                        q15_t *filtered)
+{
+  uint32_t block_len = chain_desc->config.block_len;
+  saturation_stats_t *stats = chain_desc->stats;
+
+  if (chain_desc->config.generator_mode == 0)
+  {
+    sine_calc_block_q15(&(chain_desc->signal_iir), sine, block_len);
+    sine_calc_block_q15(&(chain_desc->noise_iir), noise, block_len);
+  }
+  else
+  {
+    sine_nco_calc_block_q15(&(chain_desc->signal_nco), sine, block_len);
+    sine_nco_calc_block_q15(&(chain_desc->noise_nco), noise, block_len);
+  }
+  signal_chain_gain_block_q15(&stats[SIGNAL_CHAIN_SINE], sine, chain_desc->signal_scale, block_len);
+  signal_chain_gain_block_q15(&stats[SIGNAL_CHAIN_NOISE], noise, chain_desc->noise_scale, block_len);
+
+  signal_chain_mix_block_q15(&stats[SIGNAL_CHAIN_DISTURBED], sine, noise, disturbed, block_len);
+
+  signal_chain_filter_block_q15(&(chain_desc->filter),
+                                chain_desc->config.noise_canceller ? &(chain_desc->canceller) : NULL,
+                                &stats[SIGNAL_CHAIN_FILTERED], disturbed, noise, sine, filtered, block_len);
+}
+
+#ifdef SIGNAL_CHAIN_HARNESS
+
+/*
+*********************************************************************
+*
+*   Regression and throughput harness
+*
+*   chain_harness record <file> [samples] [option=value ...]
+*   chain_harness check  <file> [tolerance]
+*   chain_harness bench  [samples] [option=value ...]
+*
+*   Options are the signal_chain_config_t fields (fs, signal, noise,
+*   signal_gain, noise_gain, generator, filter, canceller, taps, step,
+*   block), defaults as in DirtyFilter.c. record writes the disturbed
+*   and filtered streams to a golden vector file, check reruns the
+*   configuration stored in the file and compares both streams
+*   (tolerance in LSB, default 0), bench only measures. All three
+*   report the chain throughput in samples/s; the exit code is
+*   non-zero if the check fails.
+*
+*   File format, little endian:
+*
+*     "DFGV", version, field count, config fields, sample count,
+*     then per sample: disturbed (int16), filtered (int16)
+*
+*   The golden/ directory holds vectors for the main configurations,
+*   recorded with the host kernels in host/.
+*
+*********************************************************************
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stddef.h>
+
+#include "cycle_counter.h"
+
+#define HARNESS_VERSION         (1u)
+#define HARNESS_FIELDS          (sizeof(signal_chain_config_t) / sizeof(uint32_t))
+#define HARNESS_DEFAULT_SAMPLES (2000u)
+#define HARNESS_BENCH_SAMPLES   (1000000u)
+#define HARNESS_MAX_SAMPLES     (10000000u)
+
+static const struct
+{
+  const char *name;
+  size_t offset;
+} harness_options[] =
+{
+  { "fs",          offsetof(signal_chain_config_t, sampling_frequency) },
+  { "signal",      offsetof(signal_chain_config_t, signal_frequency) },
+  { "noise",       offsetof(signal_chain_config_t, noise_frequency) },
+  { "signal_gain", offsetof(signal_chain_config_t, signal_gain) },
+  { "noise_gain",  offsetof(signal_chain_config_t, noise_gain) },
+  { "generator",   offsetof(signal_chain_config_t, generator_mode) },
+  { "filter",      offsetof(signal_chain_config_t, filter_kind) },
+  { "canceller",   offsetof(signal_chain_config_t, noise_canceller) },
+  { "taps",        offsetof(signal_chain_config_t, canceller_taps) },
+  { "step",        offsetof(signal_chain_config_t, canceller_step) },
+  { "block",       offsetof(signal_chain_config_t, block_len) }
+};
+
+#define HARNESS_OPTIONS (sizeof(harness_options) / sizeof(harness_options[0]))
+
+static signal_chain_q15_t harness_chain;
+
+static int harness_option(signal_chain_config_t *config, const char *argument)
+{
+  const char *value = strchr(argument, '=');
+  uint32_t k;
+
+  for (k = 0; (value != NULL) && (k < HARNESS_OPTIONS); k++)
+  {
+    if ((strlen(harness_options[k].name) == (size_t)(value - argument)) &&
+        (strncmp(argument, harness_options[k].name, (size_t)(value - argument)) == 0))
+    {
+      *(uint32_t *)((char *)config + harness_options[k].offset) = (uint32_t)strtoul(value + 1, NULL, 0);
+      return 0;
+    }
+  }
+  fprintf(stderr, "unknown option %s\n", argument);
+  return -1;
+}
+
+static void harness_print_config(const signal_chain_config_t *config, uint32_t samples)
+{
+  const uint32_t *field = (const uint32_t *)config;
+  uint32_t k;
+
+  printf("%u samples,", (unsigned)samples);
+  for (k = 0; k < HARNESS_OPTIONS; k++)
+  {
+    printf(" %s=%u", harness_options[k].name, (unsigned)field[harness_options[k].offset / sizeof(uint32_t)]);
+  }
+  printf("\n");
+}
+
+static void harness_write_u32(FILE *file, uint32_t value)
+{
+  uint8_t bytes[4];
+
+  bytes[0] = (uint8_t)value;
+  bytes[1] = (uint8_t)(value >> 8);
+  bytes[2] = (uint8_t)(value >> 16);
+  bytes[3] = (uint8_t)(value >> 24);
+  fwrite(bytes, 1, 4, file);
+}
+
+static int harness_read_u32(FILE *file, uint32_t *value)
+{
+  uint8_t bytes[4];
+
+  if (fread(bytes, 1, 4, file) != 4)
+  {
+    return -1;
+  }
+  *value = (uint32_t)bytes[0] | ((uint32_t)bytes[1] << 8) | ((uint32_t)bytes[2] << 16) | ((uint32_t)bytes[3] << 24);
+  return 0;
+}
+
+/*
+*********************************************************************
+*
+*   Runs the chain for samples samples (rounded up to whole blocks)
+*   and hands every block to the sink; returns the time spent in the
+*   chain in CYCLE_COUNTER_UNIT
+*
+*********************************************************************
+*/
+
+typedef int (*harness_sink_t)(void *context, const q15_t *disturbed, const q15_t *filtered, uint32_t len);
+
+static uint64_t harness_run(uint32_t samples, harness_sink_t sink, void *context)
+{
+  static q15_t sine[LOW_PASS_FILTER_MAX_BLOCK], noise[LOW_PASS_FILTER_MAX_BLOCK];
+  static q15_t disturbed[LOW_PASS_FILTER_MAX_BLOCK], filtered[LOW_PASS_FILTER_MAX_BLOCK];
+  uint32_t block_len = harness_chain.config.block_len;
+  uint64_t elapsed = 0;
+  uint32_t done, len, start;
+
+  for (done = 0; done < samples; done += len)
+  {
+    start = cycle_counter_read();
+    signal_chain_block(&harness_chain, sine, noise, disturbed, filtered);
+    elapsed += (uint32_t)(cycle_counter_read() - start);
+
+    len = (samples - done < block_len) ? samples - done : block_len;
+    if ((sink != NULL) && (sink(context, disturbed, filtered, len) != 0))
+    {
+      break;
+    }
+  }
+  return elapsed;
+}
+
+static void harness_report(uint32_t samples, uint64_t elapsed)
+{
+  const saturation_stats_t *stats = harness_chain.stats;
+  float64_t rate = (elapsed > 0) ? (float64_t)samples * 1e9 / (float64_t)elapsed : 0.0;
+
+  printf("throughput %.0f samples/s (%.0fx real time), clips sine %u noise %u disturbed %u filtered %u\n", rate,
+         rate / (float64_t)harness_chain.config.sampling_frequency, (unsigned)stats[SIGNAL_CHAIN_SINE].clips,
+         (unsigned)stats[SIGNAL_CHAIN_NOISE].clips, (unsigned)stats[SIGNAL_CHAIN_DISTURBED].clips,
+         (unsigned)stats[SIGNAL_CHAIN_FILTERED].clips);
+}
+
+/*
+*********************************************************************
+*
+*   Record
+*
+*********************************************************************
+*/
+
+static int harness_record_sink(void *context, const q15_t *disturbed, const q15_t *filtered, uint32_t len)
+{
+  FILE *file = (FILE *)context;
+  uint8_t bytes[4];
+  uint32_t n;
+
+  for (n = 0; n < len; n++)
+  {
+    bytes[0] = (uint8_t)disturbed[n];
+    bytes[1] = (uint8_t)((uint16_t)disturbed[n] >> 8);
+    bytes[2] = (uint8_t)filtered[n];
+    bytes[3] = (uint8_t)((uint16_t)filtered[n] >> 8);
+    if (fwrite(bytes, 1, 4, file) != 4)
+    {
+      return -1;
+    }
+  }
+  return 0;
+}
+
+static int harness_record(const char *name, uint32_t samples)
+{
+  const uint32_t *field = (const uint32_t *)&(harness_chain.config);
+  uint64_t elapsed;
+  FILE *file;
+  uint32_t k;
+
+  file = fopen(name, "wb");
+  if (file == NULL)
+  {
+    fprintf(stderr, "cannot create %s\n", name);
+    return 1;
+  }
+
+  fwrite("DFGV", 1, 4, file);
+  harness_write_u32(file, HARNESS_VERSION);
+  harness_write_u32(file, HARNESS_FIELDS);
+  for (k = 0; k < HARNESS_FIELDS; k++)
+  {
+    harness_write_u32(file, field[k]);
+  }
+  harness_write_u32(file, samples);
+
+  elapsed = harness_run(samples, harness_record_sink, file);
+  if (fclose(file) != 0)
+  {
+    fprintf(stderr, "write error on %s\n", name);
+    return 1;
+  }
+
+  printf("recorded %s: ", name);
+  harness_print_config(&(harness_chain.config), samples);
+  harness_report(samples, elapsed);
+  return 0;
+}
+
+/*
+*********************************************************************
+*
+*   Check
+*
+*********************************************************************
+*/
+
+typedef struct
+{
+  FILE *file;
+  uint32_t tolerance;
+  uint32_t index;
+  uint32_t failures[2];           // disturbed, filtered
+  uint32_t first_failure[2];
+  uint32_t max_error[2];
+  uint32_t truncated;
+} harness_check_t;
+
+static int harness_check_sink(void *context, const q15_t *disturbed, const q15_t *filtered, uint32_t len)
+{
+  harness_check_t *check = (harness_check_t *)context;
+  uint8_t bytes[4];
+  q31_t actual[2], golden[2];
+  uint32_t error, stream, n;
+
+  for (n = 0; n < len; n++, check->index++)
+  {
+    if (fread(bytes, 1, 4, check->file) != 4)
+    {
+      check->truncated = 1;
+      return -1;
+    }
+    golden[0] = (q15_t)((uint16_t)bytes[0] | ((uint16_t)bytes[1] << 8));
+    golden[1] = (q15_t)((uint16_t)bytes[2] | ((uint16_t)bytes[3] << 8));
+    actual[0] = disturbed[n];
+    actual[1] = filtered[n];
+
+    for (stream = 0; stream < 2; stream++)
+    {
+      error = (uint32_t)((actual[stream] > golden[stream]) ? actual[stream] - golden[stream] :
+                                                             golden[stream] - actual[stream]);
+      if (error > check->max_error[stream])
+      {
+        check->max_error[stream] = error;
+      }
+      if (error > check->tolerance)
+      {
+        if (check->failures[stream]++ == 0)
+        {
+          check->first_failure[stream] = check->index;
+        }
+      }
+    }
+  }
+  return 0;
+}
+
+static int harness_check(const char *name, uint32_t tolerance)
+{
+  static const char *stream_name[2] = { "disturbed", "filtered" };
+  signal_chain_config_t config;
+  uint32_t *field = (uint32_t *)&config;
+  harness_check_t check;
+  uint32_t version, fields, samples, stream, k;
+  char magic[4];
+  uint64_t elapsed;
+  int failed = 0;
+
+  memset(&check, 0, sizeof(check));
+  check.tolerance = tolerance;
+  check.file = fopen(name, "rb");
+  if (check.file == NULL)
+  {
+    fprintf(stderr, "cannot open %s\n", name);
+    return 1;
+  }
+
+  if ((fread(magic, 1, 4, check.file) != 4) || (memcmp(magic, "DFGV", 4) != 0) ||
+      harness_read_u32(check.file, &version) || (version != HARNESS_VERSION) ||
+      harness_read_u32(check.file, &fields) || (fields != HARNESS_FIELDS))
+  {
+    fprintf(stderr, "%s is not a version %u golden vector file\n", name, (unsigned)HARNESS_VERSION);
+    fclose(check.file);
+    return 1;
+  }
+  for (k = 0; k < HARNESS_FIELDS; k++)
+  {
+    if (harness_read_u32(check.file, &field[k]))
+    {
+      fprintf(stderr, "%s: truncated header\n", name);
+      fclose(check.file);
+      return 1;
+    }
+  }
+  if (harness_read_u32(check.file, &samples) || (signal_chain_init(&harness_chain, &config) != ARM_MATH_SUCCESS))
+  {
+    fprintf(stderr, "%s: invalid configuration\n", name);
+    fclose(check.file);
+    return 1;
+  }
+
+  elapsed = harness_run(samples, harness_check_sink, &check);
+  fclose(check.file);
+
+  printf("check %s: ", name);
+  harness_print_config(&config, samples);
+  if (check.truncated)
+  {
+    printf("  FAIL file ends after %u samples\n", (unsigned)check.index);
+    failed = 1;
+  }
+  for (stream = 0; stream < 2; stream++)
+  {
+    printf("  %-9s max error %u LSB, %u samples over %u LSB", stream_name[stream], (unsigned)check.max_error[stream],
+           (unsigned)check.failures[stream], (unsigned)tolerance);
+    if (check.failures[stream])
+    {
+      printf(" (first at %u) FAIL\n", (unsigned)check.first_failure[stream]);
+      failed = 1;
+    }
+    else
+    {
+      printf(" ok\n");
+    }
+  }
+  harness_report(samples, elapsed);
+  return failed;
+}
+
+int main(int argc, char *argv[])
+{
+  signal_chain_config_t config;
+  uint32_t samples, tolerance;
+  int bench, k;
+
+  bench = (argc >= 2) && (strcmp(argv[1], "bench") == 0);
+  if ((argc < 2) || (!bench && (argc < 3)) ||
+      (!bench && (strcmp(argv[1], "record") != 0) && (strcmp(argv[1], "check") != 0)))
+  {
+    fprintf(stderr, "usage: %s record <file> [samples] [option=value ...]\n", argv[0]);
+    fprintf(stderr, "       %s check  <file> [tolerance]\n", argv[0]);
+    fprintf(stderr, "       %s bench  [samples] [option=value ...]\n", argv[0]);
+    return 2;
+  }
+
+  cycle_counter_init();
+  if (strcmp(argv[1], "check") == 0)
+  {
+    tolerance = (argc > 3) ? (uint32_t)strtoul(argv[3], NULL, 0) : 0;
+    return harness_check(argv[2], tolerance);
+  }
+
+  k = bench ? 2 : 3;
+  samples = bench ? HARNESS_BENCH_SAMPLES : HARNESS_DEFAULT_SAMPLES;
+  if ((k < argc) && (strchr(argv[k], '=') == NULL))
+  {
+    samples = (uint32_t)strtoul(argv[k++], NULL, 0);
+  }
+  signal_chain_default_config(&config);
+  for (; k < argc; k++)
+  {
+    if (harness_option(&config, argv[k]) != 0)
+    {
+      return 2;
+    }
+  }
+  if ((samples == 0) || (samples > HARNESS_MAX_SAMPLES) ||
+      (signal_chain_init(&harness_chain, &config) != ARM_MATH_SUCCESS))
+  {
+    fprintf(stderr, "invalid configuration\n");
+    return 2;
+  }
+
+  if (!bench)
+  {
+    return harness_record(argv[2], samples);
+  }
+  printf("bench: ");
+  harness_print_config(&config, samples);
+  harness_report(samples, harness_run(samples, NULL, NULL));
+  return 0;
+}
+
+#endif
@@ -12,12 +12,129 @@
 *
 *   2011 - Tecnologix srl
 *
+*   The NCO mode below is the lookup-table alternative: a 32-bit phase
+*   accumulator indexes a quarter-wave sine table with linear
+*   interpolation. Its amplitude and frequency are exact by
+*   construction and do not drift over long runs.
+*
+*   The IIR oscillator frequency is set by the q15 coefficient, so it
+*   is off by up to one coefficient LSB, but constant. Its amplitude
+*   and phase are not: the biquad truncates every output sample and
+*   the state wanders off the ideal sine. For long runs
+*   sine_generator_renorm_q15 reloads the state from an NCO phase
+*   accumulator running at the coefficient frequency every few
+*   samples (see Renormalization).
+*
 *********************************************************************
 */
 
+#include <math.h>
+
 #include "arm_math.h"
 #include "sine_generator.h"
 
+#define NCO_TABLE_BITS  (8u)
+#define NCO_TABLE_LEN   (1u << NCO_TABLE_BITS)
+#define NCO_INDEX_SHIFT (30u - NCO_TABLE_BITS)   // quadrant phase is 30 bits wide
+#define NCO_FRAC_SHIFT  (NCO_INDEX_SHIFT - 15u)   // 15 bit interpolation fraction
+
+// sin(x) for x = 0 .. PI/2 in NCO_TABLE_LEN steps, plus the end point
+static const q15_t nco_quarter_sine[NCO_TABLE_LEN + 1] =
+{
+  0x0000, 0x00C9, 0x0192, 0x025B, 0x0324, 0x03ED, 0x04B6, 0x057F,
+  0x0648, 0x0711, 0x07D9, 0x08A2, 0x096B, 0x0A33, 0x0AFB, 0x0BC4,
+  0x0C8C, 0x0D54, 0x0E1C, 0x0EE4, 0x0FAB, 0x1073, 0x113A, 0x1201,
+  0x12C8, 0x138F, 0x1455, 0x151C, 0x15E2, 0x16A8, 0x176E, 0x1833,
+  0x18F9, 0x19BE, 0x1A83, 0x1B47, 0x1C0C, 0x1CD0, 0x1D93, 0x1E57,
+  0x1F1A, 0x1FDD, 0x209F, 0x2162, 0x2224, 0x22E5, 0x23A7, 0x2467,
+  0x2528, 0x25E8, 0x26A8, 0x2768, 0x2827, 0x28E5, 0x29A4, 0x2A62,
+  0x2B1F, 0x2BDC, 0x2C99, 0x2D55, 0x2E11, 0x2ECC, 0x2F87, 0x3042,
+  0x30FC, 0x31B5, 0x326E, 0x3327, 0x33DF, 0x3497, 0x354E, 0x3604,
+  0x36BA, 0x3770, 0x3825, 0x38D9, 0x398D, 0x3A40, 0x3AF3, 0x3BA5,
+  0x3C57, 0x3D08, 0x3DB8, 0x3E68, 0x3F17, 0x3FC6, 0x4074, 0x4121,
+  0x41CE, 0x427A, 0x4326, 0x43D1, 0x447B, 0x4524, 0x45CD, 0x4675,
+  0x471D, 0x47C4, 0x486A, 0x490F, 0x49B4, 0x4A58, 0x4AFB, 0x4B9E,
+  0x4C40, 0x4CE1, 0x4D81, 0x4E21, 0x4EC0, 0x4F5E, 0x4FFB, 0x5098,
+  0x5134, 0x51CF, 0x5269, 0x5303, 0x539B, 0x5433, 0x54CA, 0x5560,
+  0x55F6, 0x568A, 0x571E, 0x57B1, 0x5843, 0x58D4, 0x5964, 0x59F4,
+  0x5A82, 0x5B10, 0x5B9D, 0x5C29, 0x5CB4, 0x5D3E, 0x5DC8, 0x5E50,
+  0x5ED7, 0x5F5E, 0x5FE4, 0x6068, 0x60EC, 0x616F, 0x61F1, 0x6272,
+  0x62F2, 0x6371, 0x63EF, 0x646C, 0x64E9, 0x6564, 0x65DE, 0x6657,
+  0x66D0, 0x6747, 0x67BD, 0x6832, 0x68A7, 0x691A, 0x698C, 0x69FD,
+  0x6A6E, 0x6ADD, 0x6B4B, 0x6BB8, 0x6C24, 0x6C8F, 0x6CF9, 0x6D62,
+  0x6DCA, 0x6E31, 0x6E97, 0x6EFB, 0x6F5F, 0x6FC2, 0x7023, 0x7083,
+  0x70E3, 0x7141, 0x719E, 0x71FA, 0x7255, 0x72AF, 0x7308, 0x735F,
+  0x73B6, 0x740B, 0x7460, 0x74B3, 0x7505, 0x7556, 0x75A6, 0x75F4,
+  0x7642, 0x768E, 0x76D9, 0x7723, 0x776C, 0x77B4, 0x77FB, 0x7840,
+  0x7885, 0x78C8, 0x790A, 0x794A, 0x798A, 0x79C9, 0x7A06, 0x7A42,
+  0x7A7D, 0x7AB7, 0x7AEF, 0x7B27, 0x7B5D, 0x7B92, 0x7BC6, 0x7BF9,
+  0x7C2A, 0x7C5A, 0x7C89, 0x7CB7, 0x7CE4, 0x7D0F, 0x7D3A, 0x7D63,
+  0x7D8A, 0x7DB1, 0x7DD6, 0x7DFB, 0x7E1E, 0x7E3F, 0x7E60, 0x7E7F,
+  0x7E9D, 0x7EBA, 0x7ED6, 0x7EF0, 0x7F0A, 0x7F22, 0x7F38, 0x7F4E,
+  0x7F62, 0x7F75, 0x7F87, 0x7F98, 0x7FA7, 0x7FB5, 0x7FC2, 0x7FCE,
+  0x7FD9, 0x7FE2, 0x7FEA, 0x7FF1, 0x7FF6, 0x7FFA, 0x7FFE, 0x7FFF,
+  0x7FFF
+};
+
+/*
+*********************************************************************
+*
+*   NCO: table lookup
+*
+*   The top two phase bits select the quadrant; the second and fourth
+*   quadrants read the table backwards, the third and fourth negate.
+*
+*********************************************************************
+*/
+
+static __inline q15_t nco_lookup(uint32_t phase)
+{
+  uint32_t quadrant = phase >> 30;
+  uint32_t index = (phase & 0x3FFFFFFFu) >> NCO_INDEX_SHIFT;
+  q31_t frac = (q31_t)((phase >> NCO_FRAC_SHIFT) & 0x7FFFu);
+  q31_t y0, y1;
+
+  if (quadrant & 1u)
+  {
+    y0 = nco_quarter_sine[NCO_TABLE_LEN - index];
+    y1 = nco_quarter_sine[NCO_TABLE_LEN - 1u - index];
+  }
+  else
+  {
+    y0 = nco_quarter_sine[index];
+    y1 = nco_quarter_sine[index + 1u];
+  }
+
+  y0 += ((y1 - y0) * frac) >> 15;
+
+  return (q15_t)((quadrant & 2u) ? -y0 : y0);
+}
+
+/*
+*********************************************************************
+*
+*   Renormalization
+*
+*   The oscillator output k is sin(PI + w * (k + 1)), w the pole
+*   angle of the quantized coefficient, so after n samples the state
+*   should hold the reference sine at phase PI + w * n (last output)
+*   and one step before. sine_desc->phase tracks that phase as a
+*   32-bit accumulator like the NCO, and every renorm_period samples
+*   the state is loaded from the NCO table: amplitude and phase are
+*   back on the reference and cannot walk away between corrections
+*   by more than the truncation error of renorm_period samples.
+*
+*   Two table lookups per correction and a phase add per call.
+*
+*********************************************************************
+*/
+
+static void sine_renormalize_q15(sine_generator_q15_t *sine_desc)
+{
+  sine_desc->state[2] = nco_lookup(sine_desc->phase);
+  sine_desc->state[3] = nco_lookup(sine_desc->phase - sine_desc->phase_inc);
+}
+
 /*
 *********************************************************************
 *
@@ -28,7 +145,7 @@
 *********************************************************************
 */
 
-void sine_generator_init_q15(sine_generator_q15_t *sine_desc, q15_t sine_frequency, q15_t sampling_frequency)
+void sine_generator_init_q15(sine_generator_q15_t *sine_desc, uint32_t sine_frequency, uint32_t sampling_frequency)
 {
   float32_t y[4], coeff4, coeff5;
 
@@ -42,10 +159,25 @@ void sine_generator_init_q15(sine_generator_q15_t *sine_desc, q15_t sine_frequen
 
   arm_float_to_q15(&coeff4, &(sine_desc->coeff[4]), 1);
   arm_float_to_q15(&coeff5, &(sine_desc->coeff[5]), 1);
+  // coeff5 is -1/2 for any frequency, but computed in float it can
+  // truncate to -16383, which moves the poles inside the unit circle
+  // and lets the oscillation decay
+  sine_desc->coeff[5] = -16384;
 
   arm_biquad_cascade_df1_init_q15(&(sine_desc->iir_sine_generator_instance), 1, sine_desc->coeff, sine_desc->state, 1);
 
   arm_float_to_q15(&y[1], &(sine_desc->state[3]), 1);
+
+  sine_desc->renorm_period = 0;
+  sine_desc->renorm_count = 0;
+  sine_desc->phase = 0x80000000u;
+  sine_desc->phase_inc = (uint32_t)(acos(sine_desc->coeff[4] / 32768.0) * (4294967296.0 / (2.0 * PI)) + 0.5);
+}
+
+void sine_generator_renorm_q15(sine_generator_q15_t *sine_desc, uint32_t period)
+{
+  sine_desc->renorm_period = period;
+  sine_desc->renorm_count = period;
 }
 
 /*
@@ -62,5 +194,233 @@ q15_t sine_calc_sample_q15(sine_generator_q15_t *sine_desc)
 
   input = 0;
   arm_biquad_cascade_df1_q15(&(sine_desc->iir_sine_generator_instance), &input, &output, 1);
+  sine_desc->phase += sine_desc->phase_inc;
+  if (sine_desc->renorm_period && (--sine_desc->renorm_count == 0))
+  {
+    sine_renormalize_q15(sine_desc);
+    sine_desc->renorm_count = sine_desc->renorm_period;
+  }
   return (output);
 }
+
+/*
+*********************************************************************
+*
+*   Sine block generator
+*
+*   The oscillator has no input, so the output buffer is cleared and
+*   filtered in place, split where a renormalization is due.
+*
+*********************************************************************
+*/
+
+void sine_calc_block_q15(sine_generator_q15_t *sine_desc, q15_t *output, uint32_t block_len)
+{
+  uint32_t len;
+
+  arm_fill_q15(0, output, block_len);
+  if (sine_desc->renorm_period == 0)
+  {
+    arm_biquad_cascade_df1_q15(&(sine_desc->iir_sine_generator_instance), output, output, block_len);
+    sine_desc->phase += block_len * sine_desc->phase_inc;
+    return;
+  }
+
+  while (block_len > 0)
+  {
+    len = (block_len < sine_desc->renorm_count) ? block_len : sine_desc->renorm_count;
+    arm_biquad_cascade_df1_q15(&(sine_desc->iir_sine_generator_instance), output, output, len);
+    sine_desc->phase += len * sine_desc->phase_inc;
+    output += len;
+    block_len -= len;
+    sine_desc->renorm_count -= len;
+    if (sine_desc->renorm_count == 0)
+    {
+      sine_renormalize_q15(sine_desc);
+      sine_desc->renorm_count = sine_desc->renorm_period;
+    }
+  }
+}
+
+/*
+*********************************************************************
+*
+*   NCO: phase increment for the requested frequency
+*
+*   One full turn of the sine is 2^32 counts of the phase accumulator.
+*
+*********************************************************************
+*/
+
+void sine_generator_nco_init_q15(sine_generator_nco_q15_t *nco_desc, uint32_t sine_frequency, uint32_t sampling_frequency)
+{
+  nco_desc->phase = 0;
+  nco_desc->phase_inc = (uint32_t)((((uint64_t)sine_frequency << 32) + sampling_frequency / 2) / sampling_frequency);
+}
+
+q15_t sine_nco_calc_sample_q15(sine_generator_nco_q15_t *nco_desc)
+{
+  q15_t output = nco_lookup(nco_desc->phase);
+
+  nco_desc->phase += nco_desc->phase_inc;
+  return (output);
+}
+
+void sine_nco_calc_block_q15(sine_generator_nco_q15_t *nco_desc, q15_t *output, uint32_t block_len)
+{
+  uint32_t phase = nco_desc->phase;
+  uint32_t phase_inc = nco_desc->phase_inc;
+
+  while (block_len--)
+  {
+    *output++ = nco_lookup(phase);
+    phase += phase_inc;
+  }
+
+  nco_desc->phase = phase;
+}
+
+#ifdef SINE_DRIFT_CHECK
+
+/*
+*********************************************************************
+*
+*   Long-run drift measurement (host)
+*
+*   sine_drift [samples] [period] [frequency] [sampling frequency]
+*
+*   Runs the IIR oscillator for samples (default 10^9) with
+*   renormalization off and every period samples (default 1000), and
+*   prints at every decade the amplitude error against full scale
+*   (the NCO table amplitude) and the phase error against an ideal
+*   oscillator at the frequency the q15 coefficient really produces. The constant
+*   offset of that frequency from the requested one is printed once,
+*   in ppm. Defaults: 10 Hz at 1 kHz, as SIGNAL_FREQ in DirtyFilter.c.
+*
+*   The state is measured every DRIFT_STEP samples: with the last two
+*   samples y1, y2 and the pole angle w, y1 = A sin(p) and
+*   y1 cos(w) - y2 = A sin(w) cos(p).
+*
+*********************************************************************
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#define DRIFT_STEP            (65536u)
+#define DRIFT_DEFAULT_SAMPLES (1000000000ull)
+#define DRIFT_DEFAULT_PERIOD  (1000u)
+#define DRIFT_FULL_SCALE      (32767.0)
+
+typedef struct
+{
+  float64_t amplitude;
+  float64_t phase;
+} drift_point_t;
+
+static q15_t drift_block[DRIFT_STEP];
+
+static drift_point_t drift_measure(const sine_generator_q15_t *sine_desc, float64_t w)
+{
+  float64_t y1 = sine_desc->state[2];
+  float64_t y2 = sine_desc->state[3];
+  float64_t quadrature = (y1 * cos(w) - y2) / sin(w);
+  drift_point_t point;
+
+  point.amplitude = sqrt(y1 * y1 + quadrature * quadrature);
+  point.phase = atan2(y1, quadrature);
+  return point;
+}
+
+static float64_t drift_wrap(float64_t phase)
+{
+  return phase - 2.0 * PI * floor(phase / (2.0 * PI) + 0.5);
+}
+
+static void drift_run(uint32_t frequency, uint32_t sampling_frequency, uint32_t period, uint64_t samples)
+{
+  sine_generator_q15_t sine;
+  drift_point_t last, point;
+  float64_t w, step, phase_error = 0.0, amplitude_error, max_amplitude_error = 0.0, max_phase_error = 0.0;
+  uint64_t done = 0, decade = 1000;
+
+  sine_generator_init_q15(&sine, frequency, sampling_frequency);
+  sine_generator_renorm_q15(&sine, period);
+
+  // pole angle of the quantized coefficient
+  w = acos(sine.coeff[4] / 32768.0);
+  // the reference runs at the phase step of the accumulator, which is
+  // the pole angle rounded to 2^-32 of a period
+  step = DRIFT_STEP * (sine.phase_inc * (2.0 * PI / 4294967296.0));
+  last = drift_measure(&sine, w);
+
+  printf("renormalization %s", period ? "every " : "off\n");
+  if (period)
+  {
+    printf("%u samples\n", (unsigned)period);
+  }
+  printf("      samples  amplitude error  phase error\n");
+
+  while (done < samples)
+  {
+    sine_calc_block_q15(&sine, drift_block, DRIFT_STEP);
+    done += DRIFT_STEP;
+
+    // unwrapped: the error changes by far less than PI per step
+    point = drift_measure(&sine, w);
+    phase_error += drift_wrap(point.phase - last.phase - step);
+    last = point;
+    amplitude_error = point.amplitude / DRIFT_FULL_SCALE - 1.0;
+    if (fabs(amplitude_error) > max_amplitude_error)
+    {
+      max_amplitude_error = fabs(amplitude_error);
+    }
+    if (fabs(phase_error) > max_phase_error)
+    {
+      max_phase_error = fabs(phase_error);
+    }
+
+    if ((done >= decade) || (done >= samples))
+    {
+      printf("%13llu  %+14.4f%%  %+9.3f deg\n", (unsigned long long)done, 100.0 * amplitude_error,
+             phase_error * 180.0 / PI);
+      while (decade <= done)
+      {
+        decade *= 10;
+      }
+    }
+  }
+  printf("max |error|   %14.4f%%  %9.3f deg\n", 100.0 * max_amplitude_error, max_phase_error * 180.0 / PI);
+}
+
+int main(int argc, char **argv)
+{
+  uint64_t samples = (argc > 1) ? strtoull(argv[1], NULL, 0) : DRIFT_DEFAULT_SAMPLES;
+  uint32_t period = (argc > 2) ? (uint32_t)strtoul(argv[2], NULL, 0) : DRIFT_DEFAULT_PERIOD;
+  uint32_t frequency = (argc > 3) ? (uint32_t)strtoul(argv[3], NULL, 0) : 10u;
+  uint32_t sampling_frequency = (argc > 4) ? (uint32_t)strtoul(argv[4], NULL, 0) : 1000u;
+  sine_generator_q15_t sine;
+  float64_t w;
+
+  if ((frequency == 0) || (2 * frequency >= sampling_frequency))
+  {
+    fprintf(stderr, "frequency must be between 0 and fs / 2\n");
+    return 1;
+  }
+
+  sine_generator_init_q15(&sine, frequency, sampling_frequency);
+  w = acos(sine.coeff[4] / 32768.0);
+  printf("%u Hz at %u Hz: coefficient %d, frequency offset %+.1f ppm, start amplitude %+.4f%%\n",
+         (unsigned)frequency, (unsigned)sampling_frequency, sine.coeff[4],
+         1e6 * (w * sampling_frequency / (2.0 * PI) / frequency - 1.0),
+         100.0 * (drift_measure(&sine, w).amplitude / DRIFT_FULL_SCALE - 1.0));
+
+  drift_run(frequency, sampling_frequency, 0, samples);
+  if (period)
+  {
+    drift_run(frequency, sampling_frequency, period, samples);
+  }
+  return 0;
+}
+
+#endif
@@ -0,0 +1,251 @@
+/*
+*********************************************************************
+*
+*   Spectrum analyzer
+*
+*   Hann windowed q15 spectra of the filter input and output, for a
+*   live display. The filter task only copies its samples into a
+*   short history and, every hop samples, takes the last fft_len of
+*   them as a frame; the transform runs later in a task of lower
+*   priority, so it can never delay the filter. While a frame is
+*   being analyzed or drawn no new one is taken: frames are dropped,
+*   not queued, and stats.dropped shows how often.
+*
+*   The radix-4 complex FFT of CMSIS-DSP has 256 and 1024 points; both
+*   real streams go through one complex transform, the disturbed one
+*   as the real part and the filtered one as the imaginary part, and
+*   are separated afterwards:
+*
+*     X[k] = (Z[k] + Z*[N - k]) / 2      Y[k] = (Z[k] - Z*[N - k]) / 2j
+*
+*   512 points only exists as a real FFT, run once per stream. Both
+*   transforms scale by 1/N, so a full scale sine reads 32768 / 4 in
+*   its bin (the Hann window halves it); level[] is the power per bin
+*   relative to that, in 0.5 dB steps. The q15 transform leaves a
+*   noise floor around -80 dB.
+*
+*********************************************************************
+*/
+
+#include <math.h>
+
+#include "arm_math.h"
+#include "cycle_counter.h"
+#include "spectrum_analyzer.h"
+
+// 10 log10((32768 / 4)^2): power of a full scale sine bin
+#define SPECTRUM_FULL_SCALE_DB (78.2678f)
+
+arm_status spectrum_analyzer_init_q15(spectrum_analyzer_q15_t *spectrum_desc, uint32_t fft_len, uint32_t hop,
+                                      q15_t *work)
+{
+  arm_status status;
+  uint32_t n;
+
+  if (hop == 0)
+  {
+    return ARM_MATH_ARGUMENT_ERROR;
+  }
+  if (fft_len == 512u)
+  {
+    status = arm_rfft_init_q15(&(spectrum_desc->rfft_instance), &(spectrum_desc->cfft_instance), fft_len, 0u, 1u);
+  }
+  else if ((fft_len == 256u) || (fft_len == 1024u))
+  {
+    status = arm_cfft_radix4_init_q15(&(spectrum_desc->cfft_instance), (uint16_t)fft_len, 0u, 1u);
+  }
+  else
+  {
+    status = ARM_MATH_ARGUMENT_ERROR;
+  }
+  if (status != ARM_MATH_SUCCESS)
+  {
+    return status;
+  }
+
+  spectrum_desc->fft_len = fft_len;
+  spectrum_desc->hop = hop;
+  spectrum_desc->count = 0;
+  spectrum_desc->write = 0;
+  spectrum_desc->history[0] = work;
+  spectrum_desc->history[1] = &work[fft_len];
+  spectrum_desc->frame[0] = &work[2u * fft_len];
+  spectrum_desc->frame[1] = &work[3u * fft_len];
+  spectrum_desc->fft = &work[4u * fft_len];
+  spectrum_desc->window = &work[7u * fft_len];
+  spectrum_desc->busy = 0;
+  spectrum_desc->peak_bin[0] = 0;
+  spectrum_desc->peak_bin[1] = 0;
+  spectrum_desc->stats.frames = 0;
+  spectrum_desc->stats.dropped = 0;
+  spectrum_desc->stats.fft_cycles = 0;
+  spectrum_desc->stats.draw_cycles = 0;
+  spectrum_desc->stats.frames_per_sec = 0;
+
+  arm_fill_q15(0, work, 2u * fft_len);
+  for (n = 0; n < fft_len; n++)
+  {
+    spectrum_desc->window[n] = (q15_t)(16383.5f - 16383.5f * arm_cos_f32(2.0f * PI * (float32_t)n / (float32_t)fft_len));
+  }
+  for (n = 0; n < SPECTRUM_MAX_BINS; n++)
+  {
+    spectrum_desc->level[0][n] = 255u;
+    spectrum_desc->level[1][n] = 255u;
+  }
+
+  cycle_counter_enable();
+  return ARM_MATH_SUCCESS;
+}
+
+/*
+*********************************************************************
+*
+*   Filter task side: history and frame capture
+*
+*********************************************************************
+*/
+
+static void spectrum_take_frame(spectrum_analyzer_q15_t *spectrum_desc)
+{
+  uint32_t len = spectrum_desc->fft_len;
+  uint32_t oldest = spectrum_desc->write;
+  uint32_t s;
+
+  // unroll the circular history, oldest sample first
+  for (s = 0; s < 2; s++)
+  {
+    arm_copy_q15(&(spectrum_desc->history[s][oldest]), spectrum_desc->frame[s], len - oldest);
+    arm_copy_q15(spectrum_desc->history[s], &(spectrum_desc->frame[s][len - oldest]), oldest);
+  }
+  spectrum_desc->busy = 1;
+}
+
+uint32_t spectrum_analyzer_block_q15(spectrum_analyzer_q15_t *spectrum_desc, const q15_t *disturbed,
+                                     const q15_t *filtered, uint32_t len)
+{
+  uint32_t mask = spectrum_desc->fft_len - 1u;
+  uint32_t taken = 0;
+  uint32_t write = spectrum_desc->write;
+  uint32_t n;
+
+  for (n = 0; n < len; n++)
+  {
+    spectrum_desc->history[0][write] = disturbed[n];
+    spectrum_desc->history[1][write] = filtered[n];
+    write = (write + 1u) & mask;
+
+    if (++(spectrum_desc->count) >= spectrum_desc->hop)
+    {
+      spectrum_desc->count = 0;
+      if (spectrum_desc->busy)
+      {
+        spectrum_desc->stats.dropped++;
+      }
+      else
+      {
+        spectrum_desc->write = write;
+        spectrum_take_frame(spectrum_desc);
+        taken = 1;
+      }
+    }
+  }
+  spectrum_desc->write = write;
+
+  return taken;
+}
+
+/*
+*********************************************************************
+*
+*   Analyzer task side
+*
+*********************************************************************
+*/
+
+static uint8_t spectrum_level(float32_t re, float32_t im)
+{
+  float32_t power = re * re + im * im;
+  float32_t below;
+
+  if (power <= 0.0f)
+  {
+    return 255u;
+  }
+  below = (SPECTRUM_FULL_SCALE_DB - 10.0f * log10f(power)) * (float32_t)SPECTRUM_LEVEL_STEPS_PER_DB;
+  if (below <= 0.0f)
+  {
+    return 0;
+  }
+  return (below >= 255.0f) ? 255u : (uint8_t)(below + 0.5f);
+}
+
+// strongest bin above DC
+static uint16_t spectrum_peak(const uint8_t *level, uint32_t bins)
+{
+  uint32_t peak = 1;
+  uint32_t k;
+
+  for (k = 2; k < bins; k++)
+  {
+    if (level[k] < level[peak])
+    {
+      peak = k;
+    }
+  }
+  return (uint16_t)peak;
+}
+
+void spectrum_analyzer_process_q15(spectrum_analyzer_q15_t *spectrum_desc)
+{
+  uint32_t len = spectrum_desc->fft_len;
+  uint32_t bins = len / 2u;
+  const q15_t *window = spectrum_desc->window;
+  q15_t *fft = spectrum_desc->fft;
+  q15_t *spectrum = &fft[len];
+  float32_t z_re, z_im, m_re, m_im;
+  uint32_t start, s, n, k, mirror;
+
+  start = cycle_counter_read();
+
+  if (len == 512u)
+  {
+    for (s = 0; s < 2; s++)
+    {
+      arm_mult_q15(spectrum_desc->frame[s], (q15_t *)window, fft, len);
+      arm_rfft_q15(&(spectrum_desc->rfft_instance), fft, spectrum);
+      for (k = 0; k < bins; k++)
+      {
+        spectrum_desc->level[s][k] = spectrum_level((float32_t)spectrum[2u * k], (float32_t)spectrum[2u * k + 1u]);
+      }
+    }
+  }
+  else
+  {
+    for (n = 0; n < len; n++)
+    {
+      fft[2u * n] = (q15_t)(((q31_t)spectrum_desc->frame[0][n] * window[n]) >> 15);
+      fft[2u * n + 1u] = (q15_t)(((q31_t)spectrum_desc->frame[1][n] * window[n]) >> 15);
+    }
+    arm_cfft_radix4_q15(&(spectrum_desc->cfft_instance), fft);
+    for (k = 0; k < bins; k++)
+    {
+      mirror = (len - k) & (len - 1u);
+      z_re = (float32_t)fft[2u * k];
+      z_im = (float32_t)fft[2u * k + 1u];
+      m_re = (float32_t)fft[2u * mirror];
+      m_im = (float32_t)fft[2u * mirror + 1u];
+      spectrum_desc->level[0][k] = spectrum_level(0.5f * (z_re + m_re), 0.5f * (z_im - m_im));
+      spectrum_desc->level[1][k] = spectrum_level(0.5f * (z_im + m_im), 0.5f * (m_re - z_re));
+    }
+  }
+
+  spectrum_desc->peak_bin[0] = spectrum_peak(spectrum_desc->level[0], bins);
+  spectrum_desc->peak_bin[1] = spectrum_peak(spectrum_desc->level[1], bins);
+  spectrum_desc->stats.fft_cycles = cycle_counter_read() - start;
+  spectrum_desc->stats.frames++;
+}
+
+void spectrum_analyzer_release(spectrum_analyzer_q15_t *spectrum_desc)
+{
+  spectrum_desc->busy = 0;
+}
@@ -0,0 +1,161 @@
+/*
+*********************************************************************
+*
+*   Spectrum display
+*
+*   Draws the two spectra of a spectrum_analyzer_q15_t on the
+*   STM32F429I-Discovery LCD with the BSP_LCD_* driver of the lab1
+*   project (this file is only part of a build for that board). The
+*   bins are squeezed into the columns of the screen, each column
+*   showing the strongest bin it covers. In the bar style only the
+*   pixels of a column that change colour are rewritten, three DMA2D
+*   line fills per column, so the plot does not flicker and a frame
+*   costs about the same at every FFT length.
+*
+*********************************************************************
+*/
+
+#include <stdio.h>
+
+#include "arm_math.h"
+#include "spectrum_analyzer.h"
+#include "spectrum_display.h"
+#include "stm32f429i_discovery_lcd.h"
+
+#define SPECTRUM_DISPLAY_BACK      LCD_COLOR_BLACK
+#define SPECTRUM_DISPLAY_DISTURBED LCD_COLOR_RED
+#define SPECTRUM_DISPLAY_FILTERED  LCD_COLOR_GREEN
+#define SPECTRUM_DISPLAY_TEXT      LCD_COLOR_WHITE
+
+#define SPECTRUM_DISPLAY_LINE_HEIGHT (12u)   // Font12
+
+void spectrum_display_init(spectrum_display_t *display_desc, spectrum_display_style_t style,
+                           uint32_t sampling_frequency)
+{
+  uint32_t height;
+
+  BSP_LCD_Init();
+  BSP_LCD_LayerDefaultInit(0, LCD_FRAME_BUFFER);
+  BSP_LCD_SelectLayer(0);
+  BSP_LCD_Clear(SPECTRUM_DISPLAY_BACK);
+  BSP_LCD_DisplayOn();
+  BSP_LCD_SetFont(&Font12);
+  BSP_LCD_SetBackColor(SPECTRUM_DISPLAY_BACK);
+
+  height = BSP_LCD_GetYSize();
+  display_desc->style = style;
+  display_desc->sampling_frequency = sampling_frequency;
+  display_desc->width = (uint16_t)BSP_LCD_GetXSize();
+  display_desc->plot_top = 2u * SPECTRUM_DISPLAY_LINE_HEIGHT + 2u;
+  display_desc->text_top = (uint16_t)(height - 2u * SPECTRUM_DISPLAY_LINE_HEIGHT);
+  display_desc->plot_height = (uint16_t)(display_desc->text_top - 2u - display_desc->plot_top);
+
+  BSP_LCD_SetTextColor(SPECTRUM_DISPLAY_DISTURBED);
+  BSP_LCD_DisplayStringAt(0, 0, (uint8_t *)"disturbed", LEFT_MODE);
+  BSP_LCD_SetTextColor(SPECTRUM_DISPLAY_FILTERED);
+  BSP_LCD_DisplayStringAt(0, 0, (uint8_t *)"filtered", RIGHT_MODE);
+  BSP_LCD_SetTextColor(SPECTRUM_DISPLAY_TEXT);
+  BSP_LCD_DisplayStringAt(0, SPECTRUM_DISPLAY_LINE_HEIGHT, (uint8_t *)"0 .. -80 dB", CENTER_MODE);
+}
+
+/*
+*********************************************************************
+*
+*   Column mapping
+*
+*********************************************************************
+*/
+
+// plot height in pixels of the strongest bin in [first, last)
+static uint16_t spectrum_display_height(const spectrum_display_t *display_desc, const uint8_t *level,
+                                        uint32_t first, uint32_t last)
+{
+  uint32_t range = SPECTRUM_DISPLAY_RANGE_DB * SPECTRUM_LEVEL_STEPS_PER_DB;
+  uint32_t strongest = level[first];
+  uint32_t k;
+
+  for (k = first + 1u; k < last; k++)
+  {
+    if (level[k] < strongest)
+    {
+      strongest = level[k];
+    }
+  }
+  if (strongest >= range)
+  {
+    return 0;
+  }
+  return (uint16_t)((range - strongest) * display_desc->plot_height / range);
+}
+
+static void spectrum_display_column(const spectrum_display_t *display_desc, uint16_t x, uint16_t disturbed,
+                                    uint16_t filtered)
+{
+  uint16_t bottom = display_desc->plot_top + display_desc->plot_height;
+  uint16_t top = (disturbed > filtered) ? disturbed : filtered;
+
+  if (top < display_desc->plot_height)
+  {
+    BSP_LCD_SetTextColor(SPECTRUM_DISPLAY_BACK);
+    BSP_LCD_DrawVLine(x, display_desc->plot_top, display_desc->plot_height - top);
+  }
+  // the filtered bar in front, the disturbed one shows above it
+  if (disturbed > filtered)
+  {
+    BSP_LCD_SetTextColor(SPECTRUM_DISPLAY_DISTURBED);
+    BSP_LCD_DrawVLine(x, bottom - disturbed, disturbed - filtered);
+  }
+  if (filtered > 0)
+  {
+    BSP_LCD_SetTextColor(SPECTRUM_DISPLAY_FILTERED);
+    BSP_LCD_DrawVLine(x, bottom - filtered, filtered);
+  }
+}
+
+void spectrum_display_draw(const spectrum_display_t *display_desc, const spectrum_analyzer_q15_t *spectrum_desc)
+{
+  uint32_t bins = spectrum_desc->fft_len / 2u;
+  uint16_t bottom = display_desc->plot_top + display_desc->plot_height - 1u;
+  uint16_t height[2];
+  uint16_t last[2] = { 0, 0 };
+  uint32_t x, first, end;
+  char text[40];
+
+  if (display_desc->style == SPECTRUM_DISPLAY_LINES)
+  {
+    BSP_LCD_SetTextColor(SPECTRUM_DISPLAY_BACK);
+    BSP_LCD_FillRect(0, display_desc->plot_top, display_desc->width, display_desc->plot_height);
+  }
+
+  for (x = 0; x < display_desc->width; x++)
+  {
+    first = x * bins / display_desc->width;
+    end = (x + 1u) * bins / display_desc->width;
+    end = (end > first) ? end : first + 1u;
+    height[0] = spectrum_display_height(display_desc, spectrum_desc->level[0], first, end);
+    height[1] = spectrum_display_height(display_desc, spectrum_desc->level[1], first, end);
+
+    if (display_desc->style == SPECTRUM_DISPLAY_BARS)
+    {
+      spectrum_display_column(display_desc, (uint16_t)x, height[0], height[1]);
+    }
+    else if (x > 0)
+    {
+      BSP_LCD_SetTextColor(SPECTRUM_DISPLAY_DISTURBED);
+      BSP_LCD_DrawLine((uint16_t)(x - 1u), bottom - last[0], (uint16_t)x, bottom - height[0]);
+      BSP_LCD_SetTextColor(SPECTRUM_DISPLAY_FILTERED);
+      BSP_LCD_DrawLine((uint16_t)(x - 1u), bottom - last[1], (uint16_t)x, bottom - height[1]);
+    }
+    last[0] = height[0];
+    last[1] = height[1];
+  }
+
+  BSP_LCD_SetTextColor(SPECTRUM_DISPLAY_TEXT);
+  sprintf(text, "peak %4u Hz  %4u Hz  ",
+          (unsigned)(spectrum_desc->peak_bin[0] * display_desc->sampling_frequency / spectrum_desc->fft_len),
+          (unsigned)(spectrum_desc->peak_bin[1] * display_desc->sampling_frequency / spectrum_desc->fft_len));
+  BSP_LCD_DisplayStringAt(0, display_desc->text_top, (uint8_t *)text, LEFT_MODE);
+  sprintf(text, "%4u pt %2u fps %5u drop  ", (unsigned)spectrum_desc->fft_len,
+          (unsigned)spectrum_desc->stats.frames_per_sec, (unsigned)spectrum_desc->stats.dropped);
+  BSP_LCD_DisplayStringAt(0, display_desc->text_top + SPECTRUM_DISPLAY_LINE_HEIGHT, (uint8_t *)text, LEFT_MODE);
+}
@@ -0,0 +1,86 @@
+/*
+*********************************************************************
+*
+*   Lock-free SPSC ring buffer
+*
+*   head and tail are free running counters; the buffer index is
+*   obtained by masking, and head - tail is the fill level even after
+*   the counters wrap around.
+*   Blocks are pushed and popped as a whole: a push that does not fit
+*   is rejected and counted as an overflow, a pop of more samples than
+*   available returns nothing.
+*
+*********************************************************************
+*/
+
+#include "arm_math.h"
+#include "spsc_ring.h"
+
+// keep the compiler from moving buffer accesses across index updates
+#if defined(__CC_ARM)
+  #define SPSC_RING_BARRIER() __schedule_barrier()
+#else
+  #define SPSC_RING_BARRIER() __asm__ volatile ("" ::: "memory")
+#endif
+
+void spsc_ring_init(spsc_ring_q15_t *ring, q15_t *buffer, uint32_t size)
+{
+  ring->buffer = buffer;
+  ring->mask = size - 1;
+  ring->head = 0;
+  ring->tail = 0;
+  ring->overflows = 0;
+}
+
+uint32_t spsc_ring_count(spsc_ring_q15_t *ring)
+{
+  return ring->head - ring->tail;
+}
+
+uint32_t spsc_ring_space(spsc_ring_q15_t *ring)
+{
+  return (ring->mask + 1) - (ring->head - ring->tail);
+}
+
+uint32_t spsc_ring_push(spsc_ring_q15_t *ring, q15_t *src, uint32_t len)
+{
+  uint32_t head = ring->head;
+  uint32_t n;
+
+  if (spsc_ring_space(ring) < len)
+  {
+    ring->overflows++;
+    return 0;
+  }
+
+  for (n = 0; n < len; n++)
+  {
+    ring->buffer[(head + n) & ring->mask] = src[n];
+  }
+
+  SPSC_RING_BARRIER();
+  ring->head = head + len;
+
+  return len;
+}
+
+uint32_t spsc_ring_pop(spsc_ring_q15_t *ring, q15_t *dst, uint32_t len)
+{
+  uint32_t tail = ring->tail;
+  uint32_t n;
+
+  if (spsc_ring_count(ring) < len)
+  {
+    return 0;
+  }
+
+  for (n = 0; n < len; n++)
+  {
+    dst[n] = ring->buffer[(tail + n) & ring->mask];
+  }
+
+  SPSC_RING_BARRIER();
+  ring->tail = tail + len;
+
+  return len;
+}
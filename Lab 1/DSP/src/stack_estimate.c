@@ -0,0 +1,461 @@
+/*
+*********************************************************************
+*
+*   Worst-case task stack estimate (host tool)
+*
+*   Reads the call graphs GCC writes with -fcallgraph-info=su (one
+*   .ci file per source, with the frame size of every function) and
+*   reports for every task entry the deepest call chain: the sum of
+*   the frames along it. On top come the context RTX saves on the
+*   task stack at a switch or an interrupt (frame=, default 200 bytes:
+*   the Cortex-M4 exception frame with the FPU registers, r4-r11 and
+*   s16-s31) and a margin (margin=, default 20 %), rounded up to 8
+*   bytes: the recommended stack size.
+*
+*   Functions without a frame in the graphs (library code, the CMSIS
+*   DSP library, RTX calls) count as 0 bytes unless they are listed
+*   in an extern= file ("name bytes" per line, e.g. from the armlink
+*   --callgraph output or from a measurement with stack_monitor.c);
+*   they are named in the report, as are recursion, calls through
+*   pointers and frames of dynamic size, all of which make the figure
+*   a lower bound.
+*
+*   Generate the graphs with the target compiler, e.g.
+*
+*     arm-none-eabi-gcc -mcpu=cortex-m4 -mthumb -mfloat-abi=hard -O2
+*         -fcallgraph-info=su -c src/DirtyFilter.c ...
+*
+*   and build and run the tool on the PC:
+*
+*     gcc -O2 src/stack_estimate.c -o stack_estimate
+*     stack_estimate *.ci [extern=file] [frame=bytes] [margin=percent]
+*         [task=name ...]
+*
+*   Without task= every defined function nobody calls is reported
+*   (with DirtyFilter.c: the tasks and main). The exit code is non-zero
+*   if a graph cannot be read.
+*
+*********************************************************************
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+
+#define ESTIMATE_MAX_FUNCTIONS (4096u)   // power of two
+#define ESTIMATE_MAX_EDGES     (16384u)
+#define ESTIMATE_MAX_TASKS     (32u)
+#define ESTIMATE_MAX_NAME      (128u)
+#define ESTIMATE_LINE_LEN      (4096u)
+
+#define ESTIMATE_INDIRECT      "__indirect_call"
+
+// flags of a function, and of the worst chain below it
+#define ESTIMATE_DEFINED       (1u << 0)
+#define ESTIMATE_EXTERN        (1u << 1)   // size from the extern= file
+#define ESTIMATE_UNKNOWN       (1u << 2)   // no size at all
+#define ESTIMATE_DYNAMIC       (1u << 3)
+#define ESTIMATE_RECURSION     (1u << 4)
+#define ESTIMATE_POINTER       (1u << 5)
+
+typedef struct
+{
+  char name[ESTIMATE_MAX_NAME];
+  uint32_t frame;
+  uint32_t flags;
+  uint32_t called;
+  uint32_t first_edge;             // edges sorted by caller
+  uint32_t num_edges;
+  // depth search
+  uint32_t state;                  // 0 new, 1 on the current chain, 2 done
+  uint32_t depth;
+  uint32_t below;                  // flags of everything reachable
+  int32_t next;                    // callee on the worst chain, -1: none
+} estimate_function_t;
+
+typedef struct
+{
+  uint32_t caller;
+  uint32_t callee;
+} estimate_edge_t;
+
+static estimate_function_t estimate_function[ESTIMATE_MAX_FUNCTIONS];
+static int32_t estimate_hash[2u * ESTIMATE_MAX_FUNCTIONS];
+static uint32_t estimate_num_functions;
+static estimate_edge_t estimate_edge[ESTIMATE_MAX_EDGES];
+static uint32_t estimate_num_edges;
+
+/*
+*********************************************************************
+*
+*   Function table
+*
+*********************************************************************
+*/
+
+static uint32_t estimate_hash_name(const char *name)
+{
+  uint32_t hash = 2166136261u;
+
+  while (*name)
+  {
+    hash = (hash ^ (uint8_t)*name++) * 16777619u;
+  }
+  return hash;
+}
+
+// index of a function, added if new; -1 if the table is full
+static int32_t estimate_lookup(const char *name)
+{
+  uint32_t mask = 2u * ESTIMATE_MAX_FUNCTIONS - 1u;
+  uint32_t slot = estimate_hash_name(name) & mask;
+  estimate_function_t *function;
+
+  while (estimate_hash[slot] >= 0)
+  {
+    if (strcmp(estimate_function[estimate_hash[slot]].name, name) == 0)
+    {
+      return estimate_hash[slot];
+    }
+    slot = (slot + 1u) & mask;
+  }
+  if (estimate_num_functions == ESTIMATE_MAX_FUNCTIONS)
+  {
+    return -1;
+  }
+  function = &estimate_function[estimate_num_functions];
+  memset(function, 0, sizeof(*function));
+  strncpy(function->name, name, ESTIMATE_MAX_NAME - 1u);
+  function->next = -1;
+  estimate_hash[slot] = (int32_t)estimate_num_functions;
+  return (int32_t)estimate_num_functions++;
+}
+
+/*
+*********************************************************************
+*
+*   Reading
+*
+*   node: { title: "f" label: "f\nfile.c:10:6\n24 bytes (static)" }
+*   node: { title: "printf" label: "printf\n<built-in>" shape : ellipse }
+*   edge: { sourcename: "f" targetname: "g" label: "file.c:12:3" }
+*
+*********************************************************************
+*/
+
+// copies the quoted value after key into value; 0 if there is none
+static uint32_t estimate_field(const char *line, const char *key, char *value, uint32_t len)
+{
+  const char *start = strstr(line, key);
+  const char *end;
+
+  if (start == NULL)
+  {
+    return 0;
+  }
+  start += strlen(key);
+  end = strchr(start, '"');
+  if ((end == NULL) || ((uint32_t)(end - start) >= len))
+  {
+    return 0;
+  }
+  memcpy(value, start, (size_t)(end - start));
+  value[end - start] = '\0';
+  return 1;
+}
+
+static int estimate_read_graph(const char *path)
+{
+  static char line[ESTIMATE_LINE_LEN];
+  char title[ESTIMATE_MAX_NAME], target[ESTIMATE_MAX_NAME], label[ESTIMATE_LINE_LEN];
+  estimate_function_t *function;
+  const char *bytes;
+  int32_t caller, callee;
+  unsigned frame;
+  FILE *file;
+
+  file = fopen(path, "r");
+  if (file == NULL)
+  {
+    fprintf(stderr, "cannot open %s\n", path);
+    return 1;
+  }
+  while (fgets(line, sizeof(line), file) != NULL)
+  {
+    if ((strncmp(line, "node:", 5) == 0) && estimate_field(line, "title: \"", title, sizeof(title)))
+    {
+      caller = estimate_lookup(title);
+      if (caller < 0)
+        break;
+      function = &estimate_function[caller];
+      // the frame is in the third line of the label of a defined function
+      if (estimate_field(line, "label: \"", label, sizeof(label)) && (strstr(label, "<built-in>") == NULL) &&
+          (strcmp(title, ESTIMATE_INDIRECT) != 0) && ((bytes = strstr(label, " bytes (")) != NULL))
+      {
+        while ((bytes > label) && (bytes[-1] >= '0') && (bytes[-1] <= '9'))
+          bytes--;
+        if (sscanf(bytes, "%u", &frame) == 1)
+        {
+          function->frame = (frame > function->frame) ? frame : function->frame;
+          function->flags |= ESTIMATE_DEFINED;
+          if (strstr(bytes, "dynamic") != NULL)
+            function->flags |= ESTIMATE_DYNAMIC;
+        }
+      }
+    }
+    else if ((strncmp(line, "edge:", 5) == 0) && estimate_field(line, "sourcename: \"", title, sizeof(title)) &&
+             estimate_field(line, "targetname: \"", target, sizeof(target)))
+    {
+      caller = estimate_lookup(title);
+      callee = estimate_lookup(target);
+      if ((caller < 0) || (callee < 0) || (estimate_num_edges == ESTIMATE_MAX_EDGES))
+        break;
+      estimate_edge[estimate_num_edges].caller = (uint32_t)caller;
+      estimate_edge[estimate_num_edges].callee = (uint32_t)callee;
+      estimate_num_edges++;
+      if (caller != callee)
+        estimate_function[callee].called++;
+    }
+  }
+  if (!feof(file))
+  {
+    fprintf(stderr, "%s: too many functions or calls\n", path);
+    fclose(file);
+    return 1;
+  }
+  fclose(file);
+  return 0;
+}
+
+static int estimate_read_extern(const char *path)
+{
+  char line[256], name[ESTIMATE_MAX_NAME];
+  estimate_function_t *function;
+  unsigned frame;
+  int32_t index;
+  FILE *file;
+
+  file = fopen(path, "r");
+  if (file == NULL)
+  {
+    fprintf(stderr, "cannot open %s\n", path);
+    return 1;
+  }
+  while (fgets(line, sizeof(line), file) != NULL)
+  {
+    if ((line[0] == '#') || (sscanf(line, "%127s %u", name, &frame) != 2))
+      continue;
+    index = estimate_lookup(name);
+    if (index < 0)
+      break;
+    function = &estimate_function[index];
+    if (!(function->flags & ESTIMATE_DEFINED))
+    {
+      function->frame = frame;
+      function->flags |= ESTIMATE_EXTERN;
+    }
+  }
+  fclose(file);
+  return 0;
+}
+
+/*
+*********************************************************************
+*
+*   Depth
+*
+*********************************************************************
+*/
+
+static int estimate_edge_order(const void *a, const void *b)
+{
+  const estimate_edge_t *edge_a = a, *edge_b = b;
+
+  if (edge_a->caller != edge_b->caller)
+    return (edge_a->caller < edge_b->caller) ? -1 : 1;
+  return (edge_a->callee < edge_b->callee) ? -1 : (edge_a->callee > edge_b->callee);
+}
+
+static void estimate_link(void)
+{
+  uint32_t k;
+
+  qsort(estimate_edge, estimate_num_edges, sizeof(estimate_edge[0]), estimate_edge_order);
+  for (k = estimate_num_edges; k-- > 0;)
+  {
+    estimate_function[estimate_edge[k].caller].first_edge = k;
+    estimate_function[estimate_edge[k].caller].num_edges++;
+  }
+  for (k = 0; k < estimate_num_functions; k++)
+  {
+    if (strcmp(estimate_function[k].name, ESTIMATE_INDIRECT) == 0)
+      estimate_function[k].flags |= ESTIMATE_POINTER;
+    else if (!(estimate_function[k].flags & (ESTIMATE_DEFINED | ESTIMATE_EXTERN)))
+      estimate_function[k].flags |= ESTIMATE_UNKNOWN;
+  }
+}
+
+// deepest chain from function; a call back into the current chain
+// (recursion) is counted once
+static void estimate_depth(uint32_t index)
+{
+  estimate_function_t *function = &estimate_function[index];
+  estimate_function_t *callee;
+  uint32_t k, deepest = 0;
+
+  function->state = 1;
+  function->below = function->flags;
+  for (k = function->first_edge; k < function->first_edge + function->num_edges; k++)
+  {
+    callee = &estimate_function[estimate_edge[k].callee];
+    if (callee->state == 1)
+    {
+      function->below |= ESTIMATE_RECURSION;
+      continue;
+    }
+    if (callee->state == 0)
+    {
+      estimate_depth(estimate_edge[k].callee);
+    }
+    function->below |= callee->below;
+    if ((callee->depth > deepest) || (function->next < 0))
+    {
+      deepest = callee->depth;
+      function->next = (int32_t)estimate_edge[k].callee;
+    }
+  }
+  function->depth = function->frame + deepest;
+  function->state = 2;
+}
+
+/*
+*********************************************************************
+*
+*   Report
+*
+*********************************************************************
+*/
+
+// lists the functions reachable from index with one of flags set
+static void estimate_list(uint32_t index, uint32_t flags, uint8_t *seen, const char *title, uint32_t *printed)
+{
+  estimate_function_t *function = &estimate_function[index];
+  uint32_t k;
+
+  if (seen[index])
+    return;
+  seen[index] = 1;
+  if (function->flags & flags)
+  {
+    printf("%s %s", (*printed == 0) ? title : ",", function->name);
+    (*printed)++;
+  }
+  for (k = function->first_edge; k < function->first_edge + function->num_edges; k++)
+  {
+    estimate_list(estimate_edge[k].callee, flags, seen, title, printed);
+  }
+}
+
+static void estimate_report(uint32_t index, uint32_t context, uint32_t margin)
+{
+  static uint8_t seen[ESTIMATE_MAX_FUNCTIONS];
+  estimate_function_t *function = &estimate_function[index];
+  uint32_t total = function->depth + context;
+  uint32_t recommended = (total * (100u + margin) / 100u + 7u) & ~7u;
+  uint32_t printed;
+  int32_t step;
+
+  printf("%-20s %6u %6u %8u  ", function->name, (unsigned)function->depth, (unsigned)total, (unsigned)recommended);
+  for (step = (int32_t)index; step >= 0; step = estimate_function[step].next)
+  {
+    printf("%s%s(%u)", (step == (int32_t)index) ? "" : " > ", estimate_function[step].name,
+           (unsigned)estimate_function[step].frame);
+  }
+  printf("\n");
+
+  if (function->below & (ESTIMATE_UNKNOWN | ESTIMATE_POINTER | ESTIMATE_DYNAMIC))
+  {
+    printed = 0;
+    memset(seen, 0, sizeof(seen));
+    estimate_list(index, ESTIMATE_UNKNOWN, seen, "    not counted:", &printed);
+    if (function->below & ESTIMATE_POINTER)
+      printf("%s calls through pointers", printed ? "," : "    not counted:");
+    if (function->below & ESTIMATE_DYNAMIC)
+      printf("%s dynamic frames", (printed || (function->below & ESTIMATE_POINTER)) ? "," : "    not counted:");
+    printf("\n");
+  }
+  if (function->below & ESTIMATE_RECURSION)
+  {
+    printf("    recursion, counted once\n");
+  }
+}
+
+int main(int argc, char *argv[])
+{
+  const char *tasks[ESTIMATE_MAX_TASKS];
+  uint32_t num_tasks = 0, graphs = 0;
+  uint32_t context = 200, margin = 20;
+  int32_t index;
+  uint32_t k;
+  int argi;
+
+  memset(estimate_hash, 0xFF, sizeof(estimate_hash));
+  for (argi = 1; argi < argc; argi++)
+  {
+    if (strncmp(argv[argi], "frame=", 6) == 0)
+      context = (uint32_t)strtoul(argv[argi] + 6, NULL, 0);
+    else if (strncmp(argv[argi], "margin=", 7) == 0)
+      margin = (uint32_t)strtoul(argv[argi] + 7, NULL, 0);
+    else if ((strncmp(argv[argi], "task=", 5) == 0) && (num_tasks < ESTIMATE_MAX_TASKS))
+      tasks[num_tasks++] = argv[argi] + 5;
+    else if (strncmp(argv[argi], "extern=", 7) != 0)
+    {
+      if (estimate_read_graph(argv[argi]))
+        return 2;
+      graphs++;
+    }
+  }
+  // sizes of external functions apply to what the graphs left undefined
+  for (argi = 1; argi < argc; argi++)
+  {
+    if ((strncmp(argv[argi], "extern=", 7) == 0) && estimate_read_extern(argv[argi] + 7))
+      return 2;
+  }
+  if (graphs == 0)
+  {
+    fprintf(stderr, "usage: stack_estimate <file.ci ...> [extern=file] [frame=bytes] [margin=percent] [task=name ...]\n");
+    return 2;
+  }
+
+  estimate_link();
+  printf("task                  depth  +%3u  recommended  worst chain, frame bytes\n", (unsigned)context);
+  if (num_tasks > 0)
+  {
+    for (k = 0; k < num_tasks; k++)
+    {
+      index = estimate_lookup(tasks[k]);
+      if ((index < 0) || !(estimate_function[index].flags & ESTIMATE_DEFINED))
+      {
+        printf("%-20s not in the call graphs\n", tasks[k]);
+        continue;
+      }
+      if (estimate_function[index].state == 0)
+        estimate_depth((uint32_t)index);
+      estimate_report((uint32_t)index, context, margin);
+    }
+  }
+  else
+  {
+    for (k = 0; k < estimate_num_functions; k++)
+    {
+      if ((estimate_function[k].flags & ESTIMATE_DEFINED) && (estimate_function[k].called == 0))
+      {
+        if (estimate_function[k].state == 0)
+          estimate_depth(k);
+        estimate_report(k, context, margin);
+      }
+    }
+  }
+  return 0;
+}
@@ -0,0 +1,88 @@
+/*
+*********************************************************************
+*
+*   Stack monitor
+*
+*   RTX gives every task created with os_tsk_create a stack of
+*   OS_STKSIZE from its pool. Tasks created with os_tsk_create_user
+*   run on a stack of their own size; painted here first, the stack
+*   shows how deep the task has gone at any time. With OS_STKCHECK
+*   the kernel keeps a magic word in the lowest word of the stack,
+*   which is skipped.
+*
+*   The run-time figure only covers the paths taken so far; the host
+*   tool stack_estimate.c gives the static worst case of each task
+*   from the compiler's call graph.
+*
+*********************************************************************
+*/
+
+#include <stdio.h>
+
+#include "arm_math.h"
+#include "stack_monitor.h"
+
+// RTX stack overflow check word (OS_STKCHECK)
+#define STACK_MONITOR_RTX_MAGIC (0xE25A2EA5u)
+
+void stack_monitor_init(stack_monitor_t *monitor_desc)
+{
+  monitor_desc->count = 0;
+}
+
+arm_status stack_monitor_add(stack_monitor_t *monitor_desc, const char *name, void *stack, uint32_t size)
+{
+  stack_monitor_entry_t *entry;
+  uint32_t *word = stack;
+  uint32_t k;
+
+  if ((monitor_desc->count == STACK_MONITOR_MAX_STACKS) || (size < 8u))
+  {
+    return ARM_MATH_LENGTH_ERROR;
+  }
+  for (k = 0; k < size / 4u; k++)
+  {
+    word[k] = STACK_MONITOR_PAINT;
+  }
+
+  entry = &monitor_desc->entry[monitor_desc->count++];
+  entry->name = name;
+  entry->stack = word;
+  entry->size = size;
+  entry->high_water = 0;
+  return ARM_MATH_SUCCESS;
+}
+
+uint32_t stack_monitor_high_water(const void *stack, uint32_t size)
+{
+  const uint32_t *word = stack;
+  uint32_t words = size / 4u;
+  uint32_t k = 0;
+
+  // the stack grows down: count the painted words from the bottom
+  if ((words > 0) && (word[0] == STACK_MONITOR_RTX_MAGIC))
+  {
+    k = 1;
+  }
+  while ((k < words) && (word[k] == STACK_MONITOR_PAINT))
+  {
+    k++;
+  }
+  return (words - k) * 4u;
+}
+
+void stack_monitor_report(stack_monitor_t *monitor_desc, uint32_t margin_percent)
+{
+  stack_monitor_entry_t *entry;
+  uint32_t k, recommended;
+
+  printf("stack            size   used  recommended\n\r");
+  for (k = 0; k < monitor_desc->count; k++)
+  {
+    entry = &monitor_desc->entry[k];
+    entry->high_water = stack_monitor_high_water(entry->stack, entry->size);
+    recommended = (entry->high_water * (100u + margin_percent) / 100u + 7u) & ~7u;
+    printf("%-14s %6u %6u %8u%s\n\r", entry->name, (unsigned)entry->size, (unsigned)entry->high_water,
+           (unsigned)recommended, (entry->high_water + 4u >= entry->size) ? "  overflow?" : "");
+  }
+}
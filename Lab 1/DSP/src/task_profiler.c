@@ -0,0 +1,463 @@
+/*
+*********************************************************************
+*
+*   Task profiler
+*
+*   Splits the CPU time between the RTX tasks and measures how long a
+*   woken task waits before it runs. The kernel reports every task
+*   switch and every task put on the ready list; both are stamped with
+*   the DWT cycle counter and folded into per task run time and a log2
+*   histogram of the wake-up latency, a few tens of cycles per event.
+*   Optionally the events are also kept as 8 byte records, which
+*   task_profiler_dump prints and which this file, compiled on a PC
+*   with TASK_PROFILER_REPLAY and DSP_HOST_BUILD defined, reads back
+*   to compute the same report offline (see the end of the file):
+*
+*     gcc -O2 -DDSP_HOST_BUILD -DTASK_PROFILER_REPLAY -Ihost -Iinclude
+*         src/task_profiler.c -o task_replay
+*     ./task_replay console.txt
+*
+*********************************************************************
+*/
+
+#include <stdio.h>
+
+#include "arm_math.h"
+#include "cycle_counter.h"
+#include "task_profiler.h"
+
+#define TASK_PROFILER_NONE TASK_PROFILER_MAX_TASKS
+
+void task_profiler_init(task_profiler_t *profiler_desc, uint32_t cycles_per_sec,
+                        task_profiler_record_t *trace, uint32_t trace_len)
+{
+  memset(profiler_desc, 0, sizeof(*profiler_desc));
+  profiler_desc->cycles_per_sec = cycles_per_sec;
+  profiler_desc->trace = trace;
+  profiler_desc->trace_len = (trace != NULL) ? trace_len : 0;
+  profiler_desc->task[0].name = "os_idle_demon";
+}
+
+static uint32_t task_profiler_slot(uint32_t task_id)
+{
+  if (task_id == TASK_PROFILER_IDLE_ID)
+  {
+    return 0;
+  }
+  return ((task_id > 0) && (task_id < TASK_PROFILER_MAX_TASKS)) ? task_id : TASK_PROFILER_NONE;
+}
+
+void task_profiler_name(task_profiler_t *profiler_desc, uint32_t task_id, const char *name)
+{
+  uint32_t slot = task_profiler_slot(task_id);
+
+  if (slot != TASK_PROFILER_NONE)
+  {
+    profiler_desc->task[slot].name = name;
+  }
+}
+
+/*
+*********************************************************************
+*
+*   Kernel events
+*
+*********************************************************************
+*/
+
+static void task_profiler_record(task_profiler_t *profiler_desc, uint32_t event, uint32_t task_id, uint32_t now)
+{
+  task_profiler_record_t *record;
+
+  if (profiler_desc->trace == NULL)
+  {
+    return;
+  }
+  if (profiler_desc->trace_count == profiler_desc->trace_len)
+  {
+    profiler_desc->trace_lost++;
+    return;
+  }
+  record = &profiler_desc->trace[profiler_desc->trace_count++];
+  record->cycles = now;
+  record->event = (uint8_t)event;
+  record->task_id = (uint8_t)task_id;
+  record->reserved = 0;
+}
+
+// histogram bin of a latency: 0 below 2^TASK_PROFILER_BIN0_BITS cycles
+static uint32_t task_profiler_bin(uint32_t latency)
+{
+  uint32_t bin = 32u - __CLZ(latency >> TASK_PROFILER_BIN0_BITS);
+
+  return (bin < TASK_PROFILER_BINS) ? bin : TASK_PROFILER_BINS - 1u;
+}
+
+void task_profiler_ready(task_profiler_t *profiler_desc, uint32_t task_id, uint32_t now)
+{
+  uint32_t slot = task_profiler_slot(task_id);
+  task_profiler_task_t *task;
+
+  task_profiler_record(profiler_desc, TASK_PROFILER_READY, task_id, now);
+  if (slot == TASK_PROFILER_NONE)
+  {
+    profiler_desc->unknown++;
+    return;
+  }
+  // the running task requeued by round robin did not wait for anything
+  task = &profiler_desc->task[slot];
+  if ((slot != profiler_desc->running) && !task->ready_pending)
+  {
+    task->ready_pending = 1;
+    task->ready_at = now;
+  }
+}
+
+void task_profiler_switch(task_profiler_t *profiler_desc, uint32_t task_id, uint32_t now)
+{
+  uint32_t slot = task_profiler_slot(task_id);
+  task_profiler_task_t *task;
+  uint32_t latency;
+
+  task_profiler_record(profiler_desc, TASK_PROFILER_SWITCH, task_id, now);
+  if (profiler_desc->running != TASK_PROFILER_NONE)
+  {
+    profiler_desc->task[profiler_desc->running].run_cycles += now - profiler_desc->switched_at;
+  }
+  profiler_desc->running = slot;
+  profiler_desc->switched_at = now;
+  if (slot == TASK_PROFILER_NONE)
+  {
+    profiler_desc->unknown++;
+    return;
+  }
+
+  task = &profiler_desc->task[slot];
+  task->switches++;
+  if (task->ready_pending)
+  {
+    latency = now - task->ready_at;
+    task->ready_pending = 0;
+    task->wakes++;
+    task->latency_hist[task_profiler_bin(latency)]++;
+    task->latency_max = (latency > task->latency_max) ? latency : task->latency_max;
+  }
+}
+
+void task_profiler_reset(task_profiler_t *profiler_desc, uint32_t now)
+{
+  task_profiler_task_t *task;
+  uint32_t slot;
+
+  for (slot = 0; slot < TASK_PROFILER_MAX_TASKS; slot++)
+  {
+    task = &profiler_desc->task[slot];
+    task->run_cycles = 0;
+    task->switches = 0;
+    task->wakes = 0;
+    task->latency_max = 0;
+    memset(task->latency_hist, 0, sizeof(task->latency_hist));
+  }
+  profiler_desc->unknown = 0;
+  profiler_desc->window_start = now;
+  profiler_desc->switched_at = now;
+}
+
+/*
+*********************************************************************
+*
+*   Report
+*
+*********************************************************************
+*/
+
+static uint32_t task_profiler_us(const task_profiler_t *profiler_desc, uint32_t cycles)
+{
+  return (uint32_t)((uint64_t)cycles * 1000000u / profiler_desc->cycles_per_sec);
+}
+
+// upper limit of the bin holding the given share (in %) of the wakes,
+// at most the largest latency seen
+static uint32_t task_profiler_percentile(const task_profiler_task_t *task, uint32_t percent)
+{
+  uint32_t count = 0;
+  uint32_t bin, limit;
+
+  for (bin = 0; bin < TASK_PROFILER_BINS - 1u; bin++)
+  {
+    count += task->latency_hist[bin];
+    if ((uint64_t)count * 100u >= (uint64_t)task->wakes * percent)
+    {
+      break;
+    }
+  }
+  limit = 1u << (TASK_PROFILER_BIN0_BITS + bin);
+  if ((bin == TASK_PROFILER_BINS - 1u) || (limit > task->latency_max))
+  {
+    return task->latency_max;
+  }
+  return limit;
+}
+
+void task_profiler_report(const task_profiler_t *profiler_desc, uint32_t now)
+{
+  const task_profiler_task_t *task;
+  uint32_t window = now - profiler_desc->window_start;
+  uint32_t switches = 0;
+  uint32_t run, permille, slot;
+
+  if (window == 0)
+  {
+    return;
+  }
+  for (slot = 0; slot < TASK_PROFILER_MAX_TASKS; slot++)
+  {
+    switches += profiler_desc->task[slot].switches;
+  }
+  printf("window %u ms, %u switches/s, %u unknown\n\r", (unsigned)(task_profiler_us(profiler_desc, window) / 1000u),
+         (unsigned)((uint64_t)switches * profiler_desc->cycles_per_sec / window), (unsigned)profiler_desc->unknown);
+  printf("task           id   load  switches  wakes  p50 us  p99 us  max us\n\r");
+
+  for (slot = 0; slot < TASK_PROFILER_MAX_TASKS; slot++)
+  {
+    task = &profiler_desc->task[slot];
+    run = task->run_cycles;
+    if (slot == profiler_desc->running)
+    {
+      run += now - profiler_desc->switched_at;
+    }
+    if ((run == 0) && (task->switches == 0))
+    {
+      continue;
+    }
+    permille = (uint32_t)((uint64_t)run * 1000u / window);
+    printf("%-14s %3u %3u.%u%% %9u %6u", (task->name != NULL) ? task->name : "-",
+           (unsigned)((slot == 0) ? TASK_PROFILER_IDLE_ID : slot), (unsigned)(permille / 10u), (unsigned)(permille % 10u),
+           (unsigned)task->switches, (unsigned)task->wakes);
+    if (task->wakes > 0)
+    {
+      printf(" %7u %7u %7u\n\r", (unsigned)task_profiler_us(profiler_desc, task_profiler_percentile(task, 50)),
+             (unsigned)task_profiler_us(profiler_desc, task_profiler_percentile(task, 99)),
+             (unsigned)task_profiler_us(profiler_desc, task->latency_max));
+    }
+    else
+    {
+      printf("\n\r");
+    }
+  }
+}
+
+void task_profiler_dump(const task_profiler_t *profiler_desc)
+{
+  const task_profiler_record_t *record;
+  uint32_t slot, k;
+
+  printf("P F %u\n\r", (unsigned)profiler_desc->cycles_per_sec);
+  for (slot = 1; slot < TASK_PROFILER_MAX_TASKS; slot++)
+  {
+    if (profiler_desc->task[slot].name != NULL)
+    {
+      printf("P N %u %s\n\r", (unsigned)slot, profiler_desc->task[slot].name);
+    }
+  }
+  for (k = 0; k < profiler_desc->trace_count; k++)
+  {
+    record = &profiler_desc->trace[k];
+    printf("P %c %08X %u\n\r", record->event, (unsigned)record->cycles, (unsigned)record->task_id);
+  }
+  printf("P L %u\n\r", (unsigned)profiler_desc->trace_lost);
+}
+
+#ifndef DSP_HOST_BUILD
+
+/*
+*********************************************************************
+*
+*   RTX kernel hooks
+*
+*   The RL-ARM kernel library has no task switch callback, so the
+*   profiler patches the kernel functions switches and wake-ups go
+*   through, with the $Sub$$ / $Super$$ mechanism of armlink:
+*   rt_switch_req selects the task to run next, rt_put_prio on the
+*   ready list (os_rdy) readies a task woken by a delay, an interval
+*   or an event from an interrupt, and rt_dispatch readies a task
+*   woken from task level (and switches to it straight away if it has
+*   a higher priority). They run in the SVC, PendSV and SysTick
+*   handlers of the kernel, which share one priority, so the events
+*   never nest.
+*
+*********************************************************************
+*/
+
+#include "stm32f4xx.h"
+
+// head of OS_TCB (rt_TypeDef.h)
+typedef struct
+{
+  uint8_t cb_type;
+  uint8_t state;
+  uint8_t prio;
+  uint8_t task_id;
+} task_profiler_tcb_t;
+
+extern uint32_t os_rdy;   // struct OS_XCB of the kernel
+
+extern void $Super$$rt_switch_req(void *p_new);
+extern void $Super$$rt_put_prio(void *p_CB, void *p_task);
+extern void $Super$$rt_dispatch(void *next_TCB);
+
+static task_profiler_t *volatile task_profiler_active;
+
+void $Sub$$rt_switch_req(void *p_new)
+{
+  task_profiler_t *profiler_desc = task_profiler_active;
+
+  if (profiler_desc != NULL)
+  {
+    task_profiler_switch(profiler_desc, ((task_profiler_tcb_t *)p_new)->task_id, cycle_counter_read());
+  }
+  $Super$$rt_switch_req(p_new);
+}
+
+void $Sub$$rt_put_prio(void *p_CB, void *p_task)
+{
+  task_profiler_t *profiler_desc = task_profiler_active;
+
+  if ((profiler_desc != NULL) && (p_CB == (void *)&os_rdy))
+  {
+    task_profiler_ready(profiler_desc, ((task_profiler_tcb_t *)p_task)->task_id, cycle_counter_read());
+  }
+  $Super$$rt_put_prio(p_CB, p_task);
+}
+
+void $Sub$$rt_dispatch(void *next_TCB)
+{
+  task_profiler_t *profiler_desc = task_profiler_active;
+
+  if ((profiler_desc != NULL) && (next_TCB != NULL))
+  {
+    task_profiler_ready(profiler_desc, ((task_profiler_tcb_t *)next_TCB)->task_id, cycle_counter_read());
+  }
+  $Super$$rt_dispatch(next_TCB);
+}
+
+void task_profiler_start(task_profiler_t *profiler_desc, uint32_t running_id)
+{
+  uint32_t now;
+
+  // enable the cycle counter without clearing it, other users may be timing
+  CYCLE_COUNTER_DEMCR |= (1u << 24);
+  CYCLE_COUNTER_CTRL |= 1u;
+
+  __disable_irq();
+  now = cycle_counter_read();
+  task_profiler_reset(profiler_desc, now);
+  task_profiler_switch(profiler_desc, running_id, now);
+  task_profiler_active = profiler_desc;
+  __enable_irq();
+}
+
+void task_profiler_stop(void)
+{
+  task_profiler_active = NULL;
+}
+
+#endif
+
+#if defined(DSP_HOST_BUILD) && defined(TASK_PROFILER_REPLAY)
+
+/*
+*********************************************************************
+*
+*   Host replay
+*
+*   Reads the lines task_profiler_dump printed (other console output
+*   in between is skipped) and feeds the events to the same functions
+*   as the kernel hooks on the target, then prints the report over
+*   the whole trace.
+*
+*********************************************************************
+*/
+
+#include <stdlib.h>
+#include <string.h>
+
+#define REPLAY_MAX_NAME (32u)
+
+int main(int argc, char **argv)
+{
+  static char names[TASK_PROFILER_MAX_TASKS][REPLAY_MAX_NAME];
+  static task_profiler_t profiler;
+  char line[256], name[REPLAY_MAX_NAME], *text;
+  unsigned value, task_id, cycles, lost = 0;
+  uint32_t events = 0, first = 0, last = 0;
+  char event;
+  FILE *file;
+
+  if (argc < 2)
+  {
+    fprintf(stderr, "usage: task_replay <console dump>\n");
+    return 2;
+  }
+  file = fopen(argv[1], "r");
+  if (file == NULL)
+  {
+    fprintf(stderr, "cannot open %s\n", argv[1]);
+    return 2;
+  }
+
+  task_profiler_init(&profiler, 53760000u, NULL, 0);   // HCLK of the board, until a "P F" line
+  while (fgets(line, sizeof(line), file) != NULL)
+  {
+    text = line + strspn(line, "\r\n\t ");
+    if ((text[0] != 'P') || (text[1] != ' '))
+    {
+      continue;
+    }
+    text += 2;
+    event = *text++;
+    if ((event == 'F') && (sscanf(text, "%u", &value) == 1) && (value > 0))
+    {
+      profiler.cycles_per_sec = value;
+    }
+    else if ((event == 'N') && (sscanf(text, "%u %31s", &task_id, name) == 2) &&
+             (task_id > 0) && (task_id < TASK_PROFILER_MAX_TASKS))
+    {
+      strcpy(names[task_id], name);
+      task_profiler_name(&profiler, task_id, names[task_id]);
+    }
+    else if ((event == 'L') && (sscanf(text, "%u", &value) == 1))
+    {
+      lost += value;
+    }
+    else if (((event == TASK_PROFILER_READY) || (event == TASK_PROFILER_SWITCH)) &&
+             (sscanf(text, "%x %u", &cycles, &task_id) == 2))
+    {
+      if (events++ == 0)
+      {
+        first = cycles;
+        task_profiler_reset(&profiler, cycles);
+      }
+      if (event == TASK_PROFILER_READY)
+        task_profiler_ready(&profiler, task_id, cycles);
+      else
+        task_profiler_switch(&profiler, task_id, cycles);
+      last = cycles;
+    }
+  }
+  fclose(file);
+
+  if (events == 0)
+  {
+    fprintf(stderr, "no trace records in %s\n", argv[1]);
+    return 1;
+  }
+  printf("%u events over %u cycles", (unsigned)events, (unsigned)(last - first));
+  if (lost > 0)
+    printf(", %u lost after the trace filled up", lost);
+  printf("\n");
+  task_profiler_report(&profiler, last);
+  return 0;
+}
+
+#endif
@@ -0,0 +1,154 @@
+/*
+*********************************************************************
+*
+*   Multi-tone generator bank
+*
+*   Holds up to TONE_BANK_MAX_TONES oscillators of the same kind as
+*   sine_generator.c (poles on the unit circle, y[n] = 2cos(w)y[n-1] -
+*   y[n-2]) and produces their weighted sum in one pass over a block.
+*
+*   On the Cortex-M4 every oscillator step is a single SMUAD on the
+*   packed state and coefficient words, and the mix accumulates two
+*   tones per SMLAD. Other targets use a scalar path with the same
+*   arithmetic, so both produce identical samples.
+*
+*********************************************************************
+*/
+
+#include "arm_math.h"
+#include "tone_bank.h"
+
+#define TONE_BANK_HALF (-16384)   // -0.5 in q15, the y[n-2] coefficient
+
+static __inline uint32_t tone_bank_pack(q15_t low, q15_t high)
+{
+  return ((uint32_t)(uint16_t)low) | ((uint32_t)(uint16_t)high << 16);
+}
+
+void tone_bank_init_q15(tone_bank_q15_t *bank_desc)
+{
+  uint32_t k;
+
+  for (k = 0; k < TONE_BANK_MAX_TONES; k++)
+  {
+    bank_desc->state[k] = 0;
+    bank_desc->coeff[k] = tone_bank_pack(0, TONE_BANK_HALF);
+    bank_desc->gain[k] = 0;
+  }
+  bank_desc->num_tones = 0;
+}
+
+/*
+*********************************************************************
+*
+*   Add a tone
+*
+*   The oscillator starts with y[n-1] = 0 and y[n-2] = -sin(w), so the
+*   first output sample is sin(w). Returns the tone index, or -1 if the
+*   bank is full.
+*
+*********************************************************************
+*/
+
+int32_t tone_bank_add_q15(tone_bank_q15_t *bank_desc, uint32_t tone_frequency, uint32_t sampling_frequency, q15_t gain)
+{
+  float32_t w, half_coeff, start;
+  q15_t half_coeff_q15, start_q15;
+  uint32_t k = bank_desc->num_tones;
+
+  if (k >= TONE_BANK_MAX_TONES)
+  {
+    return -1;
+  }
+
+  w = 2 * PI * tone_frequency / sampling_frequency;
+  half_coeff = arm_cos_f32(w);
+  start = -arm_sin_f32(w);
+
+  arm_float_to_q15(&half_coeff, &half_coeff_q15, 1);
+  arm_float_to_q15(&start, &start_q15, 1);
+
+  bank_desc->coeff[k] = tone_bank_pack(half_coeff_q15, TONE_BANK_HALF);
+  bank_desc->state[k] = tone_bank_pack(0, start_q15);
+  bank_desc->gain[k] = gain;
+  bank_desc->num_tones = k + 1;
+
+  return (int32_t)k;
+}
+
+/*
+*********************************************************************
+*
+*   Generate a block of the mixed signal
+*
+*   Tones are processed in pairs; an odd tone count is padded with the
+*   next (silent, zero gain) slot.
+*
+*********************************************************************
+*/
+
+#if defined(ARM_MATH_CM4)
+
+void tone_bank_calc_block_q15(tone_bank_q15_t *bank_desc, q15_t *output, uint32_t block_len)
+{
+  uint32_t *state = bank_desc->state;
+  uint32_t *coeff = bank_desc->coeff;
+  q15_t *gain = bank_desc->gain;
+  uint32_t num_pairs = (bank_desc->num_tones + 1) >> 1;
+  uint32_t k, s0, s1;
+  q31_t y0, y1, acc;
+
+  while (block_len--)
+  {
+    acc = 0;
+
+    for (k = 0; k < 2 * num_pairs; k += 2)
+    {
+      s0 = state[k];
+      s1 = state[k + 1];
+
+      y0 = __SSAT(__SMUAD(coeff[k], s0) >> 14, 16);
+      y1 = __SSAT(__SMUAD(coeff[k + 1], s1) >> 14, 16);
+
+      // new y[n-1] in the low half, old y[n-1] moves up to y[n-2]
+      state[k] = __PKHBT(y0, s0, 16);
+      state[k + 1] = __PKHBT(y1, s1, 16);
+
+      acc = __SMLAD(__PKHBT(y0, y1, 16), *(uint32_t *)&gain[k], acc);
+    }
+
+    *output++ = (q15_t)__SSAT(acc >> 15, 16);
+  }
+}
+
+#else
+
+void tone_bank_calc_block_q15(tone_bank_q15_t *bank_desc, q15_t *output, uint32_t block_len)
+{
+  uint32_t num_tones = (bank_desc->num_tones + 1) & ~1u;
+  uint32_t k;
+  q15_t y1, y2;
+  q31_t y, acc;
+
+  while (block_len--)
+  {
+    acc = 0;
+
+    for (k = 0; k < num_tones; k++)
+    {
+      y1 = (q15_t)(bank_desc->state[k] & 0xFFFFu);
+      y2 = (q15_t)(bank_desc->state[k] >> 16);
+
+      y = ((q31_t)(q15_t)(bank_desc->coeff[k] & 0xFFFFu) * y1 + (q31_t)TONE_BANK_HALF * y2) >> 14;
+      y = (y > 32767) ? 32767 : ((y < -32768) ? -32768 : y);
+
+      bank_desc->state[k] = tone_bank_pack((q15_t)y, y1);
+      acc += y * bank_desc->gain[k];
+    }
+
+    acc >>= 15;
+    *output++ = (q15_t)((acc > 32767) ? 32767 : ((acc < -32768) ? -32768 : acc));
+  }
+}
+
+#endif
@@ -0,0 +1,137 @@
+/*
+*********************************************************************
+*
+*   Tone power monitor
+*
+*   Measures the power of a few known frequencies in a stream with
+*   the Goertzel algorithm: one resonator per frequency, one
+*   multiply-add per sample and bin, and the DFT magnitude evaluated
+*   once at the end of every window of window_len samples. Comparing
+*   the bins of the filter input and output gives the SNR and the
+*   rejection of the filter while it runs.
+*
+*   The frequencies should be multiples of sampling_frequency /
+*   window_len; other frequencies leak into each other's bins. The
+*   resonators run in single precision on the FPU, which leaves ample
+*   headroom for long windows at low frequencies, where the q31
+*   state would overflow.
+*
+*********************************************************************
+*/
+
+#include <math.h>
+
+#include "arm_math.h"
+#include "tone_monitor.h"
+
+void tone_monitor_init(tone_monitor_q15_t *monitor_desc, uint32_t window_len)
+{
+  monitor_desc->num_bins = 0;
+  monitor_desc->window_len = window_len;
+  monitor_desc->count = 0;
+  monitor_desc->windows = 0;
+}
+
+arm_status tone_monitor_add_bin(tone_monitor_q15_t *monitor_desc, uint32_t frequency, uint32_t sampling_frequency)
+{
+  tone_monitor_bin_t *bin;
+
+  if ((monitor_desc->num_bins == TONE_MONITOR_MAX_BINS) || (2 * frequency >= sampling_frequency))
+  {
+    return ARM_MATH_ARGUMENT_ERROR;
+  }
+
+  bin = &(monitor_desc->bin[monitor_desc->num_bins++]);
+  bin->coeff = 2.0f * arm_cos_f32(2.0f * PI * (float32_t)frequency / (float32_t)sampling_frequency);
+  bin->s1 = 0.0f;
+  bin->s2 = 0.0f;
+  bin->power = 0.0f;
+
+  return ARM_MATH_SUCCESS;
+}
+
+/*
+*********************************************************************
+*
+*   Feed len samples; returns the number of windows completed
+*
+*********************************************************************
+*/
+
+uint32_t tone_monitor_block(tone_monitor_q15_t *monitor_desc, const q15_t *input, uint32_t len)
+{
+  float32_t window_scale = 2.0f / ((float32_t)monitor_desc->window_len * (float32_t)monitor_desc->window_len *
+                                   32768.0f * 32768.0f);
+  tone_monitor_bin_t *bin;
+  float32_t coeff, s0, s1, s2;
+  uint32_t completed = 0;
+  uint32_t chunk, b, n;
+
+  while (len > 0)
+  {
+    chunk = monitor_desc->window_len - monitor_desc->count;
+    chunk = (len < chunk) ? len : chunk;
+
+    for (b = 0; b < monitor_desc->num_bins; b++)
+    {
+      bin = &(monitor_desc->bin[b]);
+      coeff = bin->coeff;
+      s1 = bin->s1;
+      s2 = bin->s2;
+      for (n = 0; n < chunk; n++)
+      {
+        s0 = (float32_t)input[n] + coeff * s1 - s2;
+        s2 = s1;
+        s1 = s0;
+      }
+      bin->s1 = s1;
+      bin->s2 = s2;
+    }
+
+    monitor_desc->count += chunk;
+    input += chunk;
+    len -= chunk;
+
+    if (monitor_desc->count == monitor_desc->window_len)
+    {
+      for (b = 0; b < monitor_desc->num_bins; b++)
+      {
+        bin = &(monitor_desc->bin[b]);
+        bin->power = (bin->s1 * bin->s1 + bin->s2 * bin->s2 - bin->coeff * bin->s1 * bin->s2) * window_scale;
+        bin->s1 = 0.0f;
+        bin->s2 = 0.0f;
+      }
+      monitor_desc->count = 0;
+      monitor_desc->windows++;
+      completed++;
+    }
+  }
+
+  return completed;
+}
+
+/*
+*********************************************************************
+*
+*   Power ratio of two bins in dB, e.g. signal over noise in one
+*   stream, or the noise bin of the input over that of the output
+*
+*********************************************************************
+*/
+
+float32_t tone_monitor_ratio_db(const tone_monitor_q15_t *monitor_a, uint32_t bin_a,
+                                const tone_monitor_q15_t *monitor_b, uint32_t bin_b)
+{
+  float32_t power_a = monitor_a->bin[bin_a].power;
+  float32_t power_b = monitor_b->bin[bin_b].power;
+
+  if (power_b < 1e-12f)
+  {
+    power_b = 1e-12f;
+  }
+  if (power_a < 1e-12f)
+  {
+    power_a = 1e-12f;
+  }
+  return 10.0f * log10f(power_a / power_b);
+}
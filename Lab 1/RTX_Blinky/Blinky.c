@@ -11,13 +11,7 @@
 #include <RTL.h>
 #include "stm32f4xx.h"                  /* STM32F4xx Definitions             */
 #include "LED.h"
-
-OS_TID t_phaseA;                        /* assigned task id of task: phase_a */
-OS_TID t_phaseB;                        /* assigned task id of task: phase_b */
-OS_TID t_phaseC;                        /* assigned task id of task: phase_c */
-OS_TID t_phaseD;                        /* assigned task id of task: phase_d */
-OS_TID t_clock;                         /* assigned task id of task: clock   */
-OS_TID t_lcd;                           /* assigned task id of task: lcd     */
+#include "TimerWheel.h"
 
 #define LED_A      0
 #define LED_B      1
@@ -25,94 +19,224 @@ OS_TID t_lcd;                           /* assigned task id of task: lcd     */
 #define LED_D      3
 #define LED_CLK    7
 
-#define __FI       1                    /* Font index 16x24                  */
+/* phase bits of a step                                                     */
+#define PH_A       (1 << LED_A)
+#define PH_B       (1 << LED_B)
+#define PH_C       (1 << LED_C)
+#define PH_D       (1 << LED_D)
 
 /*----------------------------------------------------------------------------
- *        Function 'signal_func' called from multiple tasks
+ *        Sequencer configuration
  *---------------------------------------------------------------------------*/
-void signal_func (OS_TID task)  {
-  os_evt_set (0x0100, t_clock);          /* send event signal to clock task  */
-  os_dly_wait (50);                      /* delay 50 clock ticks             */
-  os_evt_set (0x0100, t_clock);          /* send event signal to clock task  */
-  os_dly_wait (50);                      /* delay 50 clock ticks             */
-  os_evt_set (0x0001, task);             /* send event to task 'task'        */
-  os_dly_wait (50);                      /* delay 50 clock ticks             */
-}
+#define SEQ_WAVE   0                    /* one phase on, 4 steps             */
+#define SEQ_FULL   1                    /* two phases on, 4 steps            */
+#define SEQ_HALF   2                    /* one and two phases, 8 steps       */
+
+#define SEQ_MODE   SEQ_HALF             /* drive mode                        */
+#define SEQ_CW     1                    /* 1: CW (A->B->C->D), 0: CCW        */
+#define CLK_PULSE  8                    /* clock pulse, twice a step [ticks] */
+
+#ifndef TW_BENCH
+#define TW_BENCH   0                    /* 1: benchmark the timer wheel      */
+#endif                                  /* before starting the sequencer     */
+
+typedef struct {
+  U8 phases;                            /* phase outputs on (PH_x bits)      */
+  U8 ticks;                             /* time to hold them [clock ticks]   */
+} step_t;
+
+typedef struct {
+  const step_t *step;
+  U32           num_steps;
+} sequence_t;
+
+static const step_t wave_steps[] = {
+  { PH_A,        100 },
+  { PH_B,        100 },
+  { PH_C,        100 },
+  { PH_D,        100 },
+};
+
+static const step_t full_steps[] = {
+  { PH_A | PH_B, 100 },
+  { PH_B | PH_C, 100 },
+  { PH_C | PH_D, 100 },
+  { PH_D | PH_A, 100 },
+};
+
+static const step_t half_steps[] = {
+  { PH_A,         50 },
+  { PH_A | PH_B,  50 },
+  { PH_B,         50 },
+  { PH_B | PH_C,  50 },
+  { PH_C,         50 },
+  { PH_C | PH_D,  50 },
+  { PH_D,         50 },
+  { PH_D | PH_A,  50 },
+};
+
+static const sequence_t sequences[] = {
+  { wave_steps, sizeof (wave_steps) / sizeof (wave_steps[0]) },
+  { full_steps, sizeof (full_steps) / sizeof (full_steps[0]) },
+  { half_steps, sizeof (half_steps) / sizeof (half_steps[0]) },
+};
+
+U32 steps;                              /* steps done, for the Watch window  */
 
 /*----------------------------------------------------------------------------
- *        Task 1 'phaseA': Phase A output
+ *        Set the four phase outputs of a step
  *---------------------------------------------------------------------------*/
-__task void phaseA (void) {
-  for (;;) {
-    os_evt_wait_and (0x0001, 0xffff);    /* wait for an event flag 0x0001    */
-    LED_On (LED_A);
-		signal_func (t_phaseB);              /* call common signal function      */
-    LED_Off(LED_A);
+static void phase_out (U32 phases) {
+  U32 led;
+
+  for (led = LED_A; led <= LED_D; led++) {
+    if (phases & (1 << led)) {
+      LED_On (led);
+    } else {
+      LED_Off (led);
+    }
   }
 }
 
 /*----------------------------------------------------------------------------
- *        Task 2 'phaseB': Phase B output
+ *        Timer 'clock': signal clock, CLK_PULSE ticks on at the start
+ *        and in the middle of every step. One-shot, started by 'step'.
  *---------------------------------------------------------------------------*/
-__task void phaseB (void) {
-  for (;;) {
-    os_evt_wait_and (0x0001, 0xffff);    /* wait for an event flag 0x0001    */
-    LED_On (LED_B);
-    signal_func (t_phaseC);              /* call common signal function      */
-    LED_Off(LED_B);
-  }
+static TW_TIMER clk_tmr;
+static U32      clk_left;                    /* pulses left in the step      */
+static U32      clk_gap;                     /* pulse start to next [ticks]  */
+static U32      clk_on;
+
+static void clk_pulse (TW_TIMER *tmr) {
+  LED_On (LED_CLK);
+  clk_on = 1;
+  clk_left--;
+  tw_start (tmr, CLK_PULSE, 0);
 }
 
-/*----------------------------------------------------------------------------
- *        Task 3 'phaseC': Phase C output
- *---------------------------------------------------------------------------*/
-__task void phaseC (void) {
-  for (;;) {
-    os_evt_wait_and (0x0001, 0xffff);    /* wait for an event flag 0x0001    */
-    LED_On (LED_C);
-    signal_func (t_phaseD);              /* call common signal function      */
-    LED_Off(LED_C);
+static void clock (TW_TIMER *tmr) {
+  if (clk_on) {                              /* end of a pulse               */
+    LED_Off (LED_CLK);
+    clk_on = 0;
+    if (clk_left) {
+      tw_start (tmr, (clk_gap > CLK_PULSE) ? clk_gap - CLK_PULSE : 1, 0);
+    }
+  } else {
+    clk_pulse (tmr);
   }
 }
 
 /*----------------------------------------------------------------------------
- *        Task 4 'phaseD': Phase D output
+ *        Timer 'step': steps through the phase table
+ *        Sets the outputs of a step and restarts itself for the step's
+ *        time; CCW walks the table backwards.
  *---------------------------------------------------------------------------*/
-__task void phaseD (void) {
-  for (;;) {
-    os_evt_wait_and (0x0001, 0xffff);    /* wait for an event flag 0x0001    */
-    LED_On (LED_D);
-    signal_func (t_phaseA);              /* call common signal function      */
-    LED_Off(LED_D);
-  }
+static TW_TIMER step_tmr;
+
+static void step (TW_TIMER *tmr) {
+  static U32 idx;
+  const sequence_t *seq = &sequences[SEQ_MODE];
+
+  phase_out (seq->step[idx].phases);
+  steps++;
+  clk_left = 2;
+  clk_gap  = seq->step[idx].ticks / 2;
+  clk_pulse (&clk_tmr);
+  tw_start (tmr, seq->step[idx].ticks, 0);   /* hold the step, counted from  */
+#if SEQ_CW                                   /* its expiry tick: no drift    */
+  idx = (idx + 1 == seq->num_steps) ? 0 : idx + 1;
+#else
+  idx = (idx == 0) ? seq->num_steps - 1 : idx - 1;
+#endif
 }
 
+#if TW_BENCH
 /*----------------------------------------------------------------------------
- *        Task 5 'clock': Signal Clock
+ *        Timer wheel benchmark
+ *        Cost of tw_tick() and of a restart (tw_start() of a running
+ *        timer) with 10, 100 and 1000 periodic timers running, measured
+ *        with the DWT cycle counter. Results in tw_bench[] for the
+ *        Watch window.
  *---------------------------------------------------------------------------*/
-__task void clock (void) {
-  for (;;) {
-    os_evt_wait_and (0x0100, 0xffff);    /* wait for an event flag 0x0100    */
-    LED_On (LED_CLK);
-    os_dly_wait (8);                     /* delay 8 clock ticks              */
-    LED_Off(LED_CLK);
+#define DWT_CTRL     (*(volatile U32 *)0xE0001000)
+#define DWT_CYCCNT   (*(volatile U32 *)0xE0001004)
+
+#define BENCH_TICKS  10000                   /* ticks measured per size      */
+
+typedef struct {
+  U32 timers;                                /* timers running               */
+  U32 fired;                                 /* expiries in BENCH_TICKS      */
+  U32 tick_avg;                              /* tw_tick() [cycles]           */
+  U32 tick_max;
+  U32 restart_avg;                           /* tw_start() [cycles]          */
+} bench_t;
+
+bench_t tw_bench[3] = { { 10 }, { 100 }, { 1000 } };
+
+static TW_TIMER bench_tmr[1000];
+
+static void bench_func (TW_TIMER *tmr) {
+}
+
+static void bench (bench_t *res) {
+  U32 i, t, cycles;
+  U32 sum = 0;
+
+  tw_init ();
+  for (i = 0; i < res->timers; i++) {        /* periods 10..4999 ticks,      */
+    tw_set_func (&bench_tmr[i], bench_func); /* spread over the levels       */
+    tw_start (&bench_tmr[i], 1 + i % 97, 10 + (i * 7919) % 4990);
+  }
+  res->fired    = 0;
+  res->tick_max = 0;
+  for (t = 0; t < BENCH_TICKS; t++) {
+    cycles = DWT_CYCCNT;
+    res->fired += tw_tick ();
+    cycles = DWT_CYCCNT - cycles;
+    sum += cycles;
+    if (cycles > res->tick_max) res->tick_max = cycles;
   }
+  res->tick_avg = sum / BENCH_TICKS;
+
+  sum = 0;
+  for (i = 0; i < res->timers; i++) {
+    cycles = DWT_CYCCNT;
+    tw_start (&bench_tmr[i], 1 + (i * 7919) % 4990, 0);
+    sum += DWT_CYCCNT - cycles;
+  }
+  res->restart_avg = sum / res->timers;
 }
+#endif
 
 /*----------------------------------------------------------------------------
- *        Task 7 'init': Initialize
+ *        Task 'timer': runs the timer wheel
+ *        Sleeps until the next timer is due, then catches up with the
+ *        kernel time. The periodic and one-shot actions of the program
+ *        run here as timer callbacks, or set events of other tasks.
  *---------------------------------------------------------------------------*/
-__task void init (void) {
+__task void timer (void) {
+  U32 idle;
+#if TW_BENCH
+  U32 i;
+
+  CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+  DWT_CTRL |= 1;                             /* CYCCNTENA                    */
+  for (i = 0; i < 3; i++) {
+    bench (&tw_bench[i]);
+  }
+#endif
 
-  //os_mut_init(mut_GLCD);
+  tw_init ();
+  tw_run (os_time_get ());
+  tw_set_func (&clk_tmr, clock);
+  tw_set_func (&step_tmr, step);
+  step (&step_tmr);                          /* first step now               */
 
-  t_phaseA = os_tsk_create (phaseA, 0);  /* start task phaseA                */
-  t_phaseB = os_tsk_create (phaseB, 0);  /* start task phaseB                */
-  t_phaseC = os_tsk_create (phaseC, 0);  /* start task phaseC                */
-  t_phaseD = os_tsk_create (phaseD, 0);  /* start task phaseD                */
-  t_clock  = os_tsk_create (clock, 0);   /* start task clock                 */
-  os_evt_set (0x0001, t_phaseA);         /* send signal event to task phaseA */
-  os_tsk_delete_self ();
+  for (;;) {
+    idle = tw_idle_ticks ();                 /* os_dly_wait() takes at most  */
+    os_dly_wait ((idle < 0xFFFE) ? idle + 1 : 0xFFFE);      /* 0xFFFE ticks  */
+    tw_run (os_time_get ());
+  }
 }
 
 /*----------------------------------------------------------------------------
@@ -121,11 +245,11 @@ __task void init (void) {
 int main (void) {
 
   LED_init ();                              /* Initialize the LEDs           */
- 
-  os_sys_init(init);                        /* Initialize RTX and start init */
+
+  os_sys_init(timer);                       /* Initialize RTX and start the  */
+                                            /* timer task as the only task   */
 }
 
 /*----------------------------------------------------------------------------
  * end of file
  *---------------------------------------------------------------------------*/
-
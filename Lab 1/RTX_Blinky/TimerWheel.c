@@ -0,0 +1,238 @@
+/*----------------------------------------------------------------------------
+ * Name:    TimerWheel.c
+ * Purpose: hierarchical timer wheel, software timers on the RTX tick
+ * Note(s): TW_LEVELS levels of TW_SLOTS slots each. A timer less than
+ *          TW_SLOTS ticks away sits in the level 0 slot of its expiry
+ *          tick; farther timers sit in a higher level slot and move
+ *          down when the wheel passes the start of that slot
+ *          (cascade). Start and stop are O(1), a tick handles one
+ *          level 0 slot plus, every TW_SLOTS ticks, one cascade.
+ *----------------------------------------------------------------------------*/
+
+#include <RTL.h>
+#include "TimerWheel.h"
+
+#define TW_MASK      (TW_SLOTS - 1)
+
+#if defined(__CC_ARM)
+#define TW_CTZ(x)    __clz (__rbit (x))      /* count trailing zeros, x != 0 */
+#else
+#define TW_CTZ(x)    __builtin_ctz (x)
+#endif
+
+/* rotate right, so that bit n of x becomes bit 0 */
+#define TW_ROR(x,n)  (((x) >> (n)) | ((x) << ((32 - (n)) & 31)))
+
+static TW_LINK wheel[TW_LEVELS][TW_SLOTS];   /* slot list heads              */
+static U32     occupied[TW_LEVELS];          /* bit n: slot n not empty      */
+static U32     now;                          /* last tick handled            */
+
+/*----------------------------------------------------------------------------
+ *        Link a timer into the slot of its expiry tick
+ *---------------------------------------------------------------------------*/
+static void tw_link (TW_TIMER *tmr) {
+  U32 delta = tmr->expires - now;
+  U32 level = 0;
+  TW_LINK *head;
+
+  while (delta >= TW_SLOTS) {                /* find the level of the delay  */
+    delta >>= TW_BITS;
+    level++;
+  }
+  tmr->level = level;
+  tmr->slot  = (tmr->expires >> (level * TW_BITS)) & TW_MASK;
+  head = &wheel[level][tmr->slot];
+  tmr->link.next = head;                     /* append, keeps start order    */
+  tmr->link.prev = head->prev;
+  head->prev->next = &tmr->link;
+  head->prev       = &tmr->link;
+  occupied[level] |= 1UL << tmr->slot;
+}
+
+/*----------------------------------------------------------------------------
+ *        Unlink a timer, from its slot or from the list being fired
+ *---------------------------------------------------------------------------*/
+static void tw_unlink (TW_TIMER *tmr) {
+  TW_LINK *head = &wheel[tmr->level][tmr->slot];
+
+  tmr->link.prev->next = tmr->link.next;
+  tmr->link.next->prev = tmr->link.prev;
+  if (head->next == head) {
+    occupied[tmr->level] &= ~(1UL << tmr->slot);
+  }
+  tmr->level = TW_LEVELS;
+}
+
+/*----------------------------------------------------------------------------
+ *        Move the timers of a higher level slot down
+ *---------------------------------------------------------------------------*/
+static void tw_cascade (U32 level, U32 slot) {
+  TW_LINK *head = &wheel[level][slot];
+  TW_LINK *link;
+
+  occupied[level] &= ~(1UL << slot);
+  while (head->next != head) {
+    link = head->next;
+    head->next = link->next;
+    link->next->prev = head;
+    tw_link ((TW_TIMER *)link);              /* lands in a lower level       */
+  }
+}
+
+/*----------------------------------------------------------------------------
+ *        Initialize the wheel, time starts at tick 0
+ *---------------------------------------------------------------------------*/
+void tw_init (void) {
+  U32 level, slot;
+
+  for (level = 0; level < TW_LEVELS; level++) {
+    for (slot = 0; slot < TW_SLOTS; slot++) {
+      wheel[level][slot].next = &wheel[level][slot];
+      wheel[level][slot].prev = &wheel[level][slot];
+    }
+    occupied[level] = 0;
+  }
+  now = 0;
+}
+
+/*----------------------------------------------------------------------------
+ *        Set up a timer to call func at expiry (from the wheel's task)
+ *---------------------------------------------------------------------------*/
+void tw_set_func (TW_TIMER *tmr, void (*func)(TW_TIMER *tmr)) {
+  tmr->func  = func;
+  tmr->level = TW_LEVELS;
+}
+
+/*----------------------------------------------------------------------------
+ *        Set up a timer to set event flags of a task at expiry
+ *---------------------------------------------------------------------------*/
+void tw_set_event (TW_TIMER *tmr, OS_TID task, U16 flags) {
+  tmr->func  = NULL;
+  tmr->task  = task;
+  tmr->flags = flags;
+  tmr->level = TW_LEVELS;
+}
+
+/*----------------------------------------------------------------------------
+ *        (Re)start a timer: first expiry after delay ticks, then every
+ *        period ticks (0: one-shot). Delays are limited to 1..TW_MAX_DELAY.
+ *---------------------------------------------------------------------------*/
+void tw_start (TW_TIMER *tmr, U32 delay, U32 period) {
+  if (tmr->level < TW_LEVELS) {
+    tw_unlink (tmr);
+  }
+  if (delay == 0)           delay  = 1;
+  if (delay > TW_MAX_DELAY) delay  = TW_MAX_DELAY;
+  if (period > TW_MAX_DELAY) period = TW_MAX_DELAY;
+  tmr->expires = now + delay;
+  tmr->period  = period;
+  tw_link (tmr);
+}
+
+/*----------------------------------------------------------------------------
+ *        Stop a timer, no effect if it is not running
+ *---------------------------------------------------------------------------*/
+void tw_stop (TW_TIMER *tmr) {
+  if (tmr->level < TW_LEVELS) {
+    tw_unlink (tmr);
+  }
+}
+
+/*----------------------------------------------------------------------------
+ *        Advance the wheel by one tick and fire the timers due.
+ *        Returns the number of timers fired.
+ *---------------------------------------------------------------------------*/
+U32 tw_tick (void) {
+  TW_LINK  due;
+  TW_LINK *head;
+  TW_TIMER *tmr;
+  U32 level, slot, fired = 0;
+
+  now++;
+  for (level = 1, slot = 0; level < TW_LEVELS && slot == 0; level++) {
+    if ((now & ((1UL << (level * TW_BITS)) - 1)) != 0) break;
+    slot = (now >> (level * TW_BITS)) & TW_MASK;
+    if (occupied[level] & (1UL << slot)) {
+      tw_cascade (level, slot);
+    }
+  }
+
+  slot = now & TW_MASK;
+  if ((occupied[0] & (1UL << slot)) == 0) {
+    return (0);
+  }
+  head = &wheel[0][slot];                    /* move the slot list to 'due', */
+  due.next = head->next;                     /* so that callbacks can start  */
+  due.prev = head->prev;                     /* timers into the same slot    */
+  due.next->prev = &due;
+  due.prev->next = &due;
+  head->next = head->prev = head;
+  occupied[0] &= ~(1UL << slot);
+
+  while (due.next != &due) {
+    tmr = (TW_TIMER *)due.next;
+    due.next = tmr->link.next;
+    due.next->prev = &due;
+    tmr->level = TW_LEVELS;
+    if (tmr->period) {                       /* re-arm before the callback,  */
+      tmr->expires += tmr->period;           /* which may stop or restart it */
+      tw_link (tmr);
+    }
+    if (tmr->func != NULL) {
+      tmr->func (tmr);
+    } else {
+      os_evt_set (tmr->flags, tmr->task);
+    }
+    fired++;
+  }
+  return (fired);
+}
+
+/*----------------------------------------------------------------------------
+ *        Ticks from now on with nothing to do: neither an expiry nor a
+ *        cascade of a timer. 0xFFFFFFFF if no timer is running.
+ *---------------------------------------------------------------------------*/
+U32 tw_idle_ticks (void) {
+  U32 level, shift, index, bits, next, idle = 0xFFFFFFFF;
+
+  for (level = 0; level < TW_LEVELS; level++) {
+    if (occupied[level] == 0) continue;
+    shift = level * TW_BITS;
+    index = now >> shift;
+    bits  = TW_ROR (occupied[level], (index + 1) & TW_MASK);
+    next  = (index + 1 + TW_CTZ (bits)) << shift;  /* first busy slot start  */
+    if (next - now - 1 < idle) {
+      idle = next - now - 1;
+    }
+  }
+  return (idle);
+}
+
+/*----------------------------------------------------------------------------
+ *        Catch up with a tick count, e.g. os_time_get(); idle stretches
+ *        are skipped, so the cost does not grow with the time passed.
+ *---------------------------------------------------------------------------*/
+void tw_run (U32 time) {
+  U32 idle;
+
+  while (now != time) {
+    idle = tw_idle_ticks ();
+    if (idle >= time - now) {
+      now = time;
+      break;
+    }
+    now += idle;
+    tw_tick ();
+  }
+}
+
+/*----------------------------------------------------------------------------
+ *        Last tick handled
+ *---------------------------------------------------------------------------*/
+U32 tw_now (void) {
+  return (now);
+}
+
+/*----------------------------------------------------------------------------
+ * end of file
+ *---------------------------------------------------------------------------*/
@@ -0,0 +1,42 @@
+/*----------------------------------------------------------------------------
+ * Name:    TimerWheel.h
+ * Purpose: hierarchical timer wheel definitions
+ * Note(s): include RTL.h first. Not reentrant: start and stop timers
+ *          from the task that runs the wheel (e.g. in the callbacks),
+ *          or before it runs.
+ *----------------------------------------------------------------------------*/
+
+#ifndef __TIMERWHEEL_H
+#define __TIMERWHEEL_H
+
+/* Wheel Definitions */
+#define TW_BITS      5                       /* slots per level = 2^TW_BITS  */
+#define TW_SLOTS     (1 << TW_BITS)
+#define TW_LEVELS    4
+#define TW_MAX_DELAY ((1UL << (TW_BITS*TW_LEVELS)) - 1) /* ticks             */
+
+typedef struct tw_link {
+  struct tw_link *next, *prev;
+} TW_LINK;
+
+typedef struct tw_timer {
+  TW_LINK  link;                             /* slot list, keep first        */
+  U32      expires;                          /* tick of the next expiry      */
+  U32      period;                           /* reload [ticks], 0: one-shot  */
+  void   (*func)(struct tw_timer *tmr);      /* callback, or NULL: ...       */
+  OS_TID   task;                             /* ... set event flags of task  */
+  U16      flags;
+  U8       level, slot;                      /* position, level TW_LEVELS:   */
+} TW_TIMER;                                  /* not armed                    */
+
+extern void tw_init       (void);
+extern void tw_set_func   (TW_TIMER *tmr, void (*func)(TW_TIMER *tmr));
+extern void tw_set_event  (TW_TIMER *tmr, OS_TID task, U16 flags);
+extern void tw_start      (TW_TIMER *tmr, U32 delay, U32 period);
+extern void tw_stop       (TW_TIMER *tmr);
+extern U32  tw_tick       (void);
+extern U32  tw_idle_ticks (void);
+extern void tw_run        (U32 time);
+extern U32  tw_now        (void);
+
+#endif